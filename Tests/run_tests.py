@@ -1,11 +1,33 @@
+"""Runs the automated tests of every configured game build.
+
+The tests of a build can be split over several game instances (--instances),
+and all builds run at the same time, up to --max-parallel games in total.
+Every instance validates one shard of the sorted test list with
+tas_test_automated_validate and writes its own log. The logs are merged into
+one log per build and a summary at the end.
+
+--fake runs a stand-in process instead of the game, which goes through the
+same test list and writes the same kind of log. That way the scheduler can be
+tested without any game installed.
+"""
+
+import argparse
 import os
 import re
 import shutil
-import time
 import subprocess
+import sys
+import tempfile
+import time
 
 TEST_GAMEBUILDS = []
 TEST_FILE = 'testoutput.log'
+TEST_FOLDER = 'test'
+SCRIPT_EXT = '.srctas'
+DATA_EXT = '.td'
+TEST_LINE = re.compile(r'^\[TEST\] (.*?) : (.*)$')
+TEST_PASSED = 'Test ran successfully'
+TEST_FAILED = 'Test was unsuccessful'
 
 def parse_args(filepath):
     args = {
@@ -34,7 +56,88 @@ def copy_all(src, dst):
             copy_all(s,d)
         if os.path.isfile(s):
             shutil.copyfile(s,d)
-       
+
+def list_tests(game_dir):
+    """Test names like the in-game tester finds them: sorted, relative to the game folder, without extension."""
+    names = []
+    for root, _, files in os.walk(os.path.join(game_dir, TEST_FOLDER)):
+        for file in files:
+            base, ext = os.path.splitext(file)
+            if ext != SCRIPT_EXT or not os.path.isfile(os.path.join(root, base + DATA_EXT)):
+                continue
+            name = os.path.relpath(os.path.join(root, base), game_dir)
+            names.append(name.replace('/', '\\'))
+    return sorted(names)
+
+def shard_tests(tests, shard, count):
+    """Same split as Tester::RunAllTests"""
+    return tests[shard::count]
+
+class Instance:
+    """One game process validating a shard of a build's tests."""
+    def __init__(self, build, shard, count, log_path):
+        self.build = build
+        self.shard = shard
+        self.count = count
+        self.log_path = log_path
+        self.tests = shard_tests(build.tests, shard, count)
+        self.process = None
+        self.started = None
+        self.timed_out = False
+
+    def __str__(self):
+        return "%s %s shard %d/%d" % (self.build.game, self.build.build, self.shard + 1, self.count)
+
+    def command(self, options):
+        if options.fake:
+            cmd = [sys.executable, os.path.abspath(__file__), '--fake-instance', self.build.game_path, self.log_path,
+                   str(self.shard), str(self.count), '--fake-delay', str(options.fake_delay)]
+            if options.fake_fail:
+                cmd += ['--fake-fail', options.fake_fail]
+            return cmd
+
+        exec_path = os.path.join(self.build.path, self.build.executable)
+        # Releasing the singleton mutex lets the next instance start
+        return ('%s -game "%s" -w 640 -h 480 -window -novid -console +volume 0 +plugin_load %s '
+                '+y_spt_release_mutex +tas_test_automated_validate "%s %s %d %d"'
+                % (exec_path, self.build.game, self.build.spt_name, TEST_FOLDER, os.path.basename(self.log_path),
+                   self.shard, self.count))
+
+    def start(self, options):
+        if os.path.isfile(self.log_path):
+            os.remove(self.log_path)
+        cwd = None if options.fake else self.build.path
+        self.process = subprocess.Popen(self.command(options), cwd=cwd)
+        self.started = time.monotonic()
+
+    def poll(self, timeout):
+        """True once the instance has exited"""
+        if self.process.poll() is not None:
+            return True
+        if timeout and time.monotonic() - self.started > timeout:
+            self.timed_out = True
+            self.process.kill()
+            self.process.wait()
+            return True
+        return False
+
+    def results(self):
+        """Test name -> passed for the tests that reported a result, and test name -> all its log messages"""
+        results = {}
+        messages = {}
+        if not os.path.isfile(self.log_path):
+            return results, messages
+        with open(self.log_path, errors='replace') as fp:
+            for line in fp:
+                match = TEST_LINE.match(line.rstrip('\n'))
+                if not match or match.group(1) not in self.tests:
+                    continue
+                name, msg = match.groups()
+                messages.setdefault(name, []).append(msg)
+                if msg in (TEST_PASSED, TEST_FAILED):
+                    results[name] = msg == TEST_PASSED
+        return results, messages
+
 class GameBuild:
     def __init__(self, game, build, test_path):
         self.test_path = test_path
@@ -48,16 +151,12 @@ class GameBuild:
         self.spt_path = None
         self.spt_name = None
         self.spt_out = None
+        self.tests = []
+        self.instances = []
 
     def __str__(self):
         return "%s - %s - %s - %s" % (self.game, self.build, self.path, self.test_path)
 
-    def start_game(self):
-        """Start the game."""
-        exec_path = os.path.join(self.path, self.executable)
-        cmd = "%s -game \"%s\" -w 640 -h 480 -window -novid -console +volume 0 +plugin_load %s +tas_test_automated_validate \"test %s\"" % (exec_path, self.game, self.spt_name, self.output_filename)
-        subprocess.run(cmd)
-
     def set_path(self, path, executable, spt_path, spt_name):
         """Set path and some other info."""
         game_dir = os.path.join(path, self.game)
@@ -71,11 +170,43 @@ class GameBuild:
             self.spt_out = os.path.join(game_dir, spt_name + ".dll")
             self.spt_name = spt_name
 
+    def set_fake_path(self, log_dir):
+        """Run the fake instances on the test files in this folder."""
+        self.game_path = os.path.abspath(self.test_path)
+        self.path = log_dir
+        self.output_filename = self.game.replace(' ', '_') + "-" + self.build + "-" + TEST_FILE
+        self.test_output = os.path.join(log_dir, self.output_filename)
+
     def copy_files(self):
         """Copy the test files to the game"""
         copy_all(self.test_path, self.game_path)
         shutil.copyfile(self.spt_path, self.spt_out)
 
+    def create_instances(self, count):
+        self.tests = list_tests(self.game_path)
+        count = max(1, min(count, len(self.tests)))
+        base = os.path.splitext(self.test_output)[0]
+        self.instances = [Instance(self, shard, count, "%s-%d.log" % (base, shard)) for shard in range(count)]
+
+    def merge_logs(self):
+        """Merge the instance logs into one log for the build, returns (passed, failed, missing) test names."""
+        passed, failed = [], []
+        messages = {}
+        for instance in self.instances:
+            instance_results, instance_messages = instance.results()
+            messages.update(instance_messages)
+            for name, success in instance_results.items():
+                (passed if success else failed).append(name)
+
+        failed.sort(key=self.tests.index)
+        missing = [name for name in self.tests if name not in passed and name not in failed]
+        with open(self.test_output, 'w') as fp:
+            for name in self.tests:
+                for msg in messages.get(name, ["No result, the game likely crashed or timed out"]):
+                    fp.write("[TEST] %s : %s\n" % (name, msg))
+            fp.write("[TEST]  : %d / %d tests ran successfully\n" % (len(passed), len(self.tests)))
+        return passed, failed, missing
+
     def print_test_output(self):
         """Print the test output"""
         print("[TEST] Game: %s, build %s" % (self.game, self.build))
@@ -86,13 +217,6 @@ class GameBuild:
                 for line in fp:
                     print(line, end='')
 
-    def run_test(self):
-        """Run test"""
-        self.copy_files()
-        if os.path.isfile(self.test_output):
-            os.remove(self.test_output)
-        self.start_game()
-
 def get_game(name):
     """Get gamebuild given the folder name or arg name"""
     result = name.split('-')
@@ -103,7 +227,7 @@ def get_game(name):
 def find_tests():
     """Finds all games with tests based on the folders inside this folder"""
     for dir_name in os.listdir():
-        if os.path.isdir(dir_name):
+        if os.path.isdir(dir_name) and '-' in dir_name:
             game = get_game(dir_name)
             TEST_GAMEBUILDS.append(game)
 
@@ -117,7 +241,7 @@ def find_paths():
     """Look up paths for different game builds from the config file."""
     args = parse_args('config.ini')
     if args['b5135'] is not None:
-        add_build_path("5135", args['b5135'], "hl2.exe", get_2007_spt(), "spt") 
+        add_build_path("5135", args['b5135'], "hl2.exe", get_2007_spt(), "spt")
     if args['steampipe'] is not None:
         add_build_path("steampipe", args['steampipe'], "hl2.exe", get_2013_spt(), "spt-2013")
 
@@ -130,27 +254,127 @@ def find_paths():
 def get_2007_spt():
     releases = os.path.abspath(os.path.join(os.path.dirname(__file__), '..', 'Release\\spt.dll'))
     return releases
-    
+
 def get_2013_spt():
     releases = os.path.abspath(os.path.join(os.path.dirname(__file__), '..', 'Release 2013\\spt-2013.dll'))
     return releases
 
-def run_tests():
-    """Run all tests for games that are installed and configured."""
+def run_tests(options):
+    """Run the tests of all installed and configured builds, several instances at a time."""
+    pending = []
     for build in TEST_GAMEBUILDS:
         if build.path:
-            print("Running test for game %s, build %s" % (build.game, build.build))
-            build.run_test()
+            if not options.fake:
+                build.copy_files()
+            build.create_instances(options.instances)
+            print("Running %d tests for game %s, build %s on %d instances"
+                  % (len(build.tests), build.game, build.build, len(build.instances)))
+            pending += build.instances
         else:
             print("Skipping test for game %s, build %s" % (build.game, build.build))
-   
+
+    # Take turns between the builds so they all make progress
+    pending.sort(key=lambda instance: instance.shard)
+    running = []
+    last_start = None
+    while pending or running:
+        for instance in running[:]:
+            if instance.poll(options.timeout):
+                running.remove(instance)
+                print("Finished %s%s" % (instance, " (timed out)" if instance.timed_out else ""))
+
+        # The next game can only start once the previous one has released the singleton mutex
+        can_start = last_start is None or time.monotonic() - last_start >= options.start_delay
+        if pending and len(running) < options.max_parallel and can_start:
+            instance = pending.pop(0)
+            print("Starting %s with %d tests" % (instance, len(instance.tests)))
+            instance.start(options)
+            running.append(instance)
+            last_start = time.monotonic()
+        else:
+            time.sleep(0.1)
+
 def collect_test_results():
-    """Collects test results from all the output files and prints them."""
+    """Merges the instance logs of every build and prints a summary, returns whether every test passed."""
+    results = []
     for build in TEST_GAMEBUILDS:
         if build.path:
+            results.append((build, build.merge_logs()))
             build.print_test_output()
 
-find_tests()
-find_paths()
-run_tests()
-collect_test_results()
+    print("[TEST] Summary:")
+    all_passed = True
+    for build, (passed, failed, missing) in results:
+        if failed or missing:
+            all_passed = False
+        print("[TEST] %s %s: %d passed, %d failed, %d without a result"
+              % (build.game, build.build, len(passed), len(failed), len(missing)))
+        for name in failed:
+            print("[TEST]\tfailed: %s" % name)
+        for name in missing:
+            print("[TEST]\tno result: %s" % name)
+    return all_passed
+
+def run_fake_instance(game_path, log_path, shard, count, delay, fail_pattern):
+    """Stand-in for a game running tas_test_automated_validate on one shard."""
+    tests = shard_tests(list_tests(game_path), shard, count)
+    fail = re.compile(fail_pattern) if fail_pattern else None
+    successful = 0
+    with open(log_path, 'w') as fp:
+        if not tests:
+            fp.write("[TEST]  : No valid tests found in the folder.\n")
+        for name in tests:
+            time.sleep(delay)
+            if fail and fail.search(name):
+                fp.write("[TEST] %s : Error in test : Tracker \"position\" difference at tick 1 : \"fake\"\n" % name)
+                fp.write("[TEST] %s : %s\n" % (name, TEST_FAILED))
+            else:
+                successful += 1
+                fp.write("[TEST] %s : %s\n" % (name, TEST_PASSED))
+            fp.flush()
+        if tests:
+            fp.write("[TEST]  : %d / %d tests ran successfully\n" % (successful, len(tests)))
+
+def main():
+    parser = argparse.ArgumentParser(description="Runs the automated tests of every configured game build.")
+    parser.add_argument('--instances', type=int, default=1, help="game instances per build")
+    parser.add_argument('--max-parallel', type=int, default=None,
+                        help="most games running at once over all builds, defaults to all of them")
+    parser.add_argument('--start-delay', type=float, default=15.0,
+                        help="seconds between starting games, so each can release the singleton mutex")
+    parser.add_argument('--timeout', type=float, default=None, help="seconds before an instance is killed")
+    parser.add_argument('--fake', action='store_true', help="run fake instances instead of the games")
+    parser.add_argument('--fake-delay', type=float, default=0.1, help="seconds every fake test takes")
+    parser.add_argument('--fake-fail', default=None, help="regex of test names that fail in fake instances")
+    parser.add_argument('--fake-instance', nargs=4, metavar=('GAME_PATH', 'LOG', 'SHARD', 'COUNT'),
+                        help=argparse.SUPPRESS)
+    options = parser.parse_args()
+
+    if options.fake_instance:
+        game_path, log_path, shard, count = options.fake_instance
+        run_fake_instance(game_path, log_path, int(shard), int(count), options.fake_delay, options.fake_fail)
+        return 0
+
+    if options.instances < 1:
+        parser.error("--instances has to be at least 1")
+
+    os.chdir(os.path.dirname(os.path.abspath(__file__)))
+    find_tests()
+    if options.fake:
+        options.start_delay = 0 if options.start_delay == parser.get_default('start_delay') else options.start_delay
+        log_dir = tempfile.mkdtemp(prefix='spt-tests-')
+        print("Fake instance logs are in %s" % log_dir)
+        for build in TEST_GAMEBUILDS:
+            build.set_fake_path(log_dir)
+    else:
+        find_paths()
+
+    if options.max_parallel is None:
+        options.max_parallel = options.instances * len(TEST_GAMEBUILDS)
+    options.max_parallel = max(1, options.max_parallel)
+
+    run_tests(options)
+    return 0 if collect_test_results() else 1
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,121 @@
+"""Stand-in for game instances in a coordinated script search.
+
+Listens like the spt_ipc server does and answers every search_job with a fake
+result, so tas_script_search_coordinator can be run without starting several
+games. Every port gets its own thread and acts like one worker instance.
+
+Example, a lowest search that succeeds once the yaw variable is at least 12.5:
+    python search_worker.py --ports 27182 27183 27184 --success "yaw >= 12.5" --delay 0.5
+"""
+
+import argparse
+import json
+import socket
+import threading
+import time
+
+
+def parse_value(value):
+    try:
+        return float(value)
+    except ValueError:
+        return value
+
+
+class Worker:
+    def __init__(self, port, success, tick, delay, verbose):
+        self.port = port
+        self.success = success
+        self.tick = tick
+        self.delay = delay
+        self.verbose = verbose
+        self.jobs = 0
+
+    def log(self, text):
+        if self.verbose:
+            print("[%d] %s" % (self.port, text), flush=True)
+
+    def evaluate(self, variables):
+        """Returns the result and tick for a job's variables."""
+        scope = {name: parse_value(value) for name, value in variables.items()}
+        try:
+            success = bool(eval(self.success, {}, scope))
+            tick = int(eval(self.tick, {}, scope))
+        except Exception as ex:
+            self.log("unable to evaluate the job: %s" % ex)
+            return "stop", 0
+        return ("success" if success else "fail"), tick
+
+    def handle(self, conn, msg):
+        if msg.get("type") != "search_job":
+            return
+
+        # Pretend to play back the script
+        time.sleep(self.delay)
+        result, tick = self.evaluate(msg.get("variables", {}))
+        self.jobs += 1
+        self.log("job %s %s -> %s (tick %d)" % (msg.get("id"), msg.get("variables"), result, tick))
+
+        reply = {"type": "search_result", "id": msg.get("id"), "result": result, "tick": tick}
+        conn.sendall(json.dumps(reply).encode() + b"\0")
+
+    def serve(self):
+        with socket.socket(socket.AF_INET, socket.SOCK_STREAM) as server:
+            server.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+            server.bind(("127.0.0.1", self.port))
+            server.listen(1)
+            self.log("listening")
+
+            # Like the plugin, one client at a time
+            while True:
+                conn, _ = server.accept()
+                self.log("coordinator connected")
+                with conn:
+                    self.read_messages(conn)
+                self.log("coordinator disconnected after %d jobs" % self.jobs)
+
+    def read_messages(self, conn):
+        pending = b""
+        while True:
+            data = conn.recv(4096)
+            if not data:
+                return
+
+            pending += data
+            # Messages are null terminated JSON
+            while b"\0" in pending:
+                raw, pending = pending.split(b"\0", 1)
+                try:
+                    msg = json.loads(raw.decode())
+                except ValueError:
+                    self.log("bad message: %r" % raw)
+                    continue
+                self.handle(conn, msg)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Fake search workers for tas_script_search_coordinator.")
+    parser.add_argument("--ports", type=int, nargs="+", default=[27182], help="one worker per port")
+    parser.add_argument("--success", default="True",
+                        help="Python expression over the job's variables, true means success")
+    parser.add_argument("--tick", default="0", help="Python expression for the tick a result is reported on")
+    parser.add_argument("--delay", type=float, default=0.0, help="seconds every job takes")
+    parser.add_argument("--quiet", action="store_true", help="don't print every job")
+    args = parser.parse_args()
+
+    threads = []
+    for port in args.ports:
+        worker = Worker(port, args.success, args.tick, args.delay, not args.quiet)
+        thread = threading.Thread(target=worker.serve, daemon=True)
+        thread.start()
+        threads.append(thread)
+
+    try:
+        for thread in threads:
+            thread.join()
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()
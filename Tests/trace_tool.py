@@ -0,0 +1,257 @@
+"""Tools for the binary tester traces (.tdb).
+
+The format is described in spt/scripts2/trace2.hpp. Every tick stores the raw
+floats of every tracker, and every few ticks the file stores a chained FNV-1a
+hash of all tick records so far.
+
+Converting the text test data next to it:
+    python trace_tool.py convert "hl2 - 5135/test/coast.td"
+
+Finding the first tick where two traces differ, either format works:
+    python trace_tool.py diverge old.tdb new.tdb
+
+Checking that the stored hashes of a trace match its ticks:
+    python trace_tool.py verify "hl2 - 5135/test/coast.tdb"
+"""
+
+import argparse
+import os
+import struct
+import sys
+
+MAGIC = b"SPTT"
+VERSION = 1
+TRACKER_VALUES = 3
+DEFAULT_INTERVAL = 64
+TRACKER_NAMES = ["velocity", "position", "angle"]
+
+FNV_OFFSET = 14695981039346656037
+FNV_PRIME = 1099511628211
+MASK = 0xFFFFFFFFFFFFFFFF
+
+
+def fnv1a64(data, hash=FNV_OFFSET):
+    for byte in data:
+        hash ^= byte
+        hash = (hash * FNV_PRIME) & MASK
+    return hash
+
+
+class Trace:
+    def __init__(self, tracker_count, interval=DEFAULT_INTERVAL):
+        self.tracker_count = tracker_count
+        self.interval = interval
+        self.ticks = []
+        self.values = []  # one tuple of tracker_count * TRACKER_VALUES floats per tick
+        self.records = []  # packed tick records, these are what gets hashed
+        self.checkpoints = []
+        self.prefix_hashes = []  # chained hash after every tick
+        self.stored_checkpoints = None
+
+    def add_tick(self, tick, values):
+        record = struct.pack("<i%df" % len(values), tick, *values)
+        previous = self.prefix_hashes[-1] if self.prefix_hashes else FNV_OFFSET
+        hash = fnv1a64(record, previous)
+
+        self.ticks.append(tick)
+        # Round trip through float32 so values compare like the ones in the game
+        self.values.append(struct.unpack("<%df" % len(values), record[4:]))
+        self.records.append(record)
+        self.prefix_hashes.append(hash)
+        if len(self.ticks) % self.interval == 0:
+            self.checkpoints.append(hash)
+
+    def save(self, path):
+        with open(path, "wb") as file:
+            file.write(MAGIC)
+            file.write(struct.pack("<III", VERSION, self.tracker_count, self.interval))
+            file.write(struct.pack("<I", len(self.ticks)))
+            for record in self.records:
+                file.write(record)
+            file.write(struct.pack("<I", len(self.checkpoints)))
+            for hash in self.checkpoints:
+                file.write(struct.pack("<Q", hash))
+
+
+def read_exact(file, size):
+    data = file.read(size)
+    if len(data) != size:
+        raise ValueError("unexpected end of file")
+    return data
+
+
+def load_tdb(path):
+    with open(path, "rb") as file:
+        if read_exact(file, 4) != MAGIC:
+            raise ValueError("not a binary trace")
+        version, tracker_count, interval = struct.unpack("<III", read_exact(file, 12))
+        if version != VERSION:
+            raise ValueError("unsupported version %d" % version)
+        if interval == 0:
+            raise ValueError("checkpoint interval is 0")
+
+        trace = Trace(tracker_count, interval)
+        value_count = tracker_count * TRACKER_VALUES
+        (tick_count,) = struct.unpack("<I", read_exact(file, 4))
+        for _ in range(tick_count):
+            tick, *values = struct.unpack("<i%df" % value_count, read_exact(file, 4 + 4 * value_count))
+            trace.add_tick(tick, values)
+
+        (checkpoint_count,) = struct.unpack("<I", read_exact(file, 4))
+        trace.stored_checkpoints = [struct.unpack("<Q", read_exact(file, 8))[0] for _ in range(checkpoint_count)]
+    return trace
+
+
+def load_td(path, interval=DEFAULT_INTERVAL):
+    """Reads the text test data, every tick needs a line for every tracker."""
+    ticks = {}
+    with open(path, "r") as file:
+        for number, line in enumerate(file, 1):
+            line = line.strip()
+            if not line:
+                continue
+            try:
+                tick, tracker, value = line.split(" ", 2)
+                ticks.setdefault(int(tick), {})[int(tracker)] = [float(v) for v in value.split("|")]
+            except ValueError:
+                raise ValueError("%s:%d: bad line %r" % (path, number, line))
+
+    tracker_count = max((max(trackers) + 1 for trackers in ticks.values()), default=len(TRACKER_NAMES))
+    trace = Trace(tracker_count, interval)
+    for tick in sorted(ticks):
+        trackers = ticks[tick]
+        values = []
+        for tracker in range(tracker_count):
+            if tracker not in trackers or len(trackers[tracker]) != TRACKER_VALUES:
+                raise ValueError("%s: tick %d has no complete data for tracker %d" % (path, tick, tracker))
+            values += trackers[tracker]
+        trace.add_tick(tick, values)
+    return trace
+
+
+def load_any(path, interval=DEFAULT_INTERVAL):
+    if path.lower().endswith(".td"):
+        return load_td(path, interval)
+    return load_tdb(path)
+
+
+def first_difference(count, differs):
+    """Index of the first True in a sequence that stays True once it's True, or count if there is none."""
+    low, high = 0, count
+    while low < high:
+        middle = (low + high) // 2
+        if differs(middle):
+            high = middle
+        else:
+            low = middle + 1
+    return low
+
+
+def find_divergence(a, b):
+    """Index of the first tick record that differs, None if the common ticks are identical."""
+    common = min(len(a.ticks), len(b.ticks))
+    if a.interval == b.interval and a.tracker_count == b.tracker_count:
+        # The hashes are chained, so once a checkpoint differs all later ones do too
+        checkpoints = min(len(a.checkpoints), len(b.checkpoints))
+        block = first_difference(checkpoints, lambda i: a.checkpoints[i] != b.checkpoints[i])
+        start = block * a.interval
+        end = min(common, start + a.interval) if block < checkpoints else common
+    else:
+        start, end = 0, common
+
+    index = start + first_difference(end - start, lambda i: a.prefix_hashes[start + i] != b.prefix_hashes[start + i])
+    return index if index < common else None
+
+
+def tracker_name(tracker):
+    return TRACKER_NAMES[tracker] if tracker < len(TRACKER_NAMES) else "tracker %d" % tracker
+
+
+def command_convert(args):
+    for path in args.files:
+        trace = load_td(path, args.interval)
+        out = os.path.splitext(path)[0] + ".tdb"
+        trace.save(out)
+        print("%s -> %s (%d ticks, %d checkpoints)" % (path, out, len(trace.ticks), len(trace.checkpoints)))
+    return 0
+
+
+def command_verify(args):
+    failed = 0
+    for path in args.files:
+        try:
+            trace = load_tdb(path)
+        except (OSError, ValueError) as ex:
+            print("%s: %s" % (path, ex))
+            failed += 1
+            continue
+
+        if trace.stored_checkpoints != trace.checkpoints:
+            bad = first_difference(min(len(trace.checkpoints), len(trace.stored_checkpoints)),
+                                   lambda i: trace.stored_checkpoints[i] != trace.checkpoints[i])
+            print("%s: checkpoint %d doesn't match the tick data" % (path, bad))
+            failed += 1
+        else:
+            print("%s: ok, %d ticks" % (path, len(trace.ticks)))
+    return 1 if failed else 0
+
+
+def command_diverge(args):
+    a = load_any(args.a, args.interval)
+    b = load_any(args.b, args.interval)
+    if a.tracker_count != b.tracker_count:
+        print("Traces have different trackers (%d and %d)" % (a.tracker_count, b.tracker_count))
+        return 1
+
+    index = find_divergence(a, b)
+    if index is None:
+        if len(a.ticks) == len(b.ticks):
+            print("Traces are identical, %d ticks" % len(a.ticks))
+            return 0
+        print("Traces are identical for %d ticks, then one ends (%d and %d ticks)"
+              % (min(len(a.ticks), len(b.ticks)), len(a.ticks), len(b.ticks)))
+        return 1
+
+    if a.ticks[index] != b.ticks[index]:
+        print("Tick records differ at record %d: ticks %d and %d" % (index, a.ticks[index], b.ticks[index]))
+        return 1
+
+    print("First divergence at tick %d" % a.ticks[index])
+    for tracker in range(a.tracker_count):
+        first = tracker * TRACKER_VALUES
+        va = a.values[index][first:first + TRACKER_VALUES]
+        vb = b.values[index][first:first + TRACKER_VALUES]
+        if va != vb:
+            deltas = " ".join("%.9g" % (y - x) for x, y in zip(va, vb))
+            print("\t%s: %s -> %s (delta %s)" % (tracker_name(tracker), va, vb, deltas))
+    return 1
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Converts and compares binary tester traces.")
+    subparsers = parser.add_subparsers(dest="command", required=True)
+
+    convert = subparsers.add_parser("convert", help="write a .tdb next to every .td file")
+    convert.add_argument("files", nargs="+")
+    convert.add_argument("--interval", type=int, default=DEFAULT_INTERVAL, help="ticks between checkpoints")
+    convert.set_defaults(func=command_convert)
+
+    verify = subparsers.add_parser("verify", help="check the stored checkpoints of .tdb files")
+    verify.add_argument("files", nargs="+")
+    verify.set_defaults(func=command_verify)
+
+    diverge = subparsers.add_parser("diverge", help="find the first tick where two traces differ")
+    diverge.add_argument("a")
+    diverge.add_argument("b")
+    diverge.add_argument("--interval", type=int, default=DEFAULT_INTERVAL,
+                         help="checkpoint interval for .td inputs")
+    diverge.set_defaults(func=command_diverge)
+
+    args = parser.parse_args()
+    if getattr(args, "interval", 1) <= 0:
+        parser.error("the interval has to be positive")
+    sys.exit(args.func(args))
+
+
+if __name__ == "__main__":
+    main()
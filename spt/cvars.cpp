@@ -21,6 +21,7 @@ struct FeatureCommand
 	bool dynamicCommand; // dynamically allocated
 	bool dynamicName;
 	bool unhideOnUnregister;
+	bool lazyTrigger; // registered for a feature that hasn't been loaded yet
 };
 static std::vector<FeatureCommand> cmd_to_feature;
 static bool first_time_init = true;
@@ -33,11 +34,17 @@ void Cvar_InitConCommandBase(ConCommandBase& concommand, void* owner)
 	                          [concommand](const FeatureCommand& fc) { return fc.command == &concommand; });
 	if (found != cmd_to_feature.end())
 	{
+		if (found->lazyTrigger && found->owner == owner)
+		{
+			found->lazyTrigger = false;
+			return;
+		}
+
 		Warning("Two commands trying to init concommand %s!\n", concommand.GetName());
 		return;
 	}
 
-	FeatureCommand cmd = {owner, &concommand, false, false, false};
+	FeatureCommand cmd = {owner, &concommand, false, false, false, false};
 	cmd_to_feature.push_back(cmd);
 	// Add command to command list since it got wiped after registering commands the first time
 	if (!first_time_init)
@@ -50,6 +57,21 @@ void Cvar_InitConCommandBase(ConCommandBase& concommand, void* owner)
 	}
 }
 
+void Cvar_InitLazyTrigger(ConCommandBase& concommand, void* owner)
+{
+	Cvar_InitConCommandBase(concommand, owner);
+	if (!cmd_to_feature.empty() && cmd_to_feature.back().command == &concommand)
+		cmd_to_feature.back().lazyTrigger = true;
+}
+
+bool Cvar_IsLazyTrigger(ConCommandBase& concommand)
+{
+	auto found = std::find_if(cmd_to_feature.begin(),
+	                          cmd_to_feature.end(),
+	                          [&concommand](const FeatureCommand& fc) { return fc.command == &concommand; });
+	return found != cmd_to_feature.end() && found->lazyTrigger;
+}
+
 void FormatConCmd(const char* fmt, ...)
 {
 	static char BUFFER[8192];
@@ -270,7 +292,7 @@ static void HandleBackwardsCompatibility(FeatureCommand& featCmd, const char* cm
 		newCommand = new ConVarProxy((ConVar*)cmd, newName, ((ConVar_guts*)cmd)->m_nFlags);
 	}
 
-	FeatureCommand newCmd = {featCmd.owner, newCommand, true, allocatedName, false};
+	FeatureCommand newCmd = {featCmd.owner, newCommand, true, allocatedName, false, false};
 	cmd_to_feature.push_back(newCmd);
 
 	// If a legacy command didn't originally have FCVAR_HIDDEN set, we need to hide it now and
@@ -337,6 +359,59 @@ void Cvar_RegisterSPTCvars()
 	first_time_init = false;
 }
 
+void Cvar_RemoveLazyTriggers(void* owner)
+{
+	if (!interfaces::g_pCVar)
+		return;
+
+	for (auto it = cmd_to_feature.begin(); it != cmd_to_feature.end();)
+	{
+		if (it->owner != owner || !it->lazyTrigger)
+		{
+			++it;
+			continue;
+		}
+
+#ifdef OE
+		UnregisterConCommand(it->command);
+#else
+		interfaces::g_pCVar->UnregisterConCommand(it->command);
+#endif
+		if (it->unhideOnUnregister)
+			reinterpret_cast<ConCommandBase_guts*>(it->command)->m_nFlags &= ~FCVAR_HIDDEN;
+		it = cmd_to_feature.erase(it);
+	}
+}
+
+void Cvar_RegisterLateCvars()
+{
+#ifndef OE
+	if (!interfaces::g_pCVar || first_time_init || !pluginCommandListHead)
+		return;
+
+	// ConVar_Register only runs once, so the commands are handed to ICvar directly. The accessor is set by now,
+	// so the backwards compatibility copies register themselves when they're created.
+	ConCommandBase* cmd = *pluginCommandListHead;
+	*pluginCommandListHead = nullptr;
+	while (cmd != NULL)
+	{
+		ConCommandBase* next = (ConCommandBase*)cmd->GetNext();
+		reinterpret_cast<ConCommandBase_guts*>(cmd)->m_pNext = nullptr;
+
+		auto inittedCmd = std::find_if(cmd_to_feature.begin(),
+		                               cmd_to_feature.end(),
+		                               [cmd](const FeatureCommand& fc) { return fc.command == cmd; });
+		if (inittedCmd != cmd_to_feature.end())
+		{
+			HandleBackwardsCompatibility(*inittedCmd, cmd->GetName());
+			interfaces::g_pCVar->RegisterConCommand(cmd);
+		}
+
+		cmd = next;
+	}
+#endif
+}
+
 void Cvar_UnregisterSPTCvars()
 {
 	if (!interfaces::g_pCVar)
@@ -5,6 +5,13 @@
 void Cvar_RegisterSPTCvars();
 void Cvar_UnregisterSPTCvars();
 void Cvar_InitConCommandBase(ConCommandBase& concommand, void* owner);
+// Lazy triggers are registered before their feature loads, they stay registered if the feature inits them again
+void Cvar_InitLazyTrigger(ConCommandBase& concommand, void* owner);
+bool Cvar_IsLazyTrigger(ConCommandBase& concommand);
+// Unregisters the lazy triggers the owner didn't init when it loaded
+void Cvar_RemoveLazyTriggers(void* owner);
+// Registers commands that were initialized after Cvar_RegisterSPTCvars
+void Cvar_RegisterLateCvars();
 void FormatConCmd(const char* fmt, ...);
 
 #ifdef SSDK2013
@@ -1,10 +1,17 @@
 #include "stdafx.hpp"
-#include <future>
+#include <algorithm>
+#include <chrono>
+#include <mutex>
 #include "convar.hpp"
 #include "feature.hpp"
 #include "interfaces.hpp"
 #include "cvars.hpp"
 #include "features\hud.hpp"
+#include "pattern_scanner.hpp"
+#include "signature_cache.hpp"
+#include "file.hpp"
+#include "signals.hpp"
+#include "thread_pool.hpp"
 #include "SPTLib\sptlib.hpp"
 #include "dbg.h"
 #include "SPTLib\Windows\detoursutils.hpp"
@@ -13,15 +20,153 @@
 
 static std::unordered_map<std::string, ModuleHookData> moduleHookData;
 static std::unordered_map<uintptr_t, int> patternIndices;
+static std::mutex patternIndicesMutex;
 static bool loadedOnce = false;
 static bool reloadingFeatures = false;
 
+struct ScanTiming
+{
+	std::string moduleName;
+	utils::SectionClass section;
+	size_t offset;
+	size_t size;
+	double milliseconds;
+};
+
+static const size_t SCAN_CHUNK_SIZE = 1024 * 1024;
+static std::mutex scanTimingMutex;
+static std::vector<ScanTiming> chunkTimings;
+static std::vector<ScanTiming> moduleTimings;
+
+static double MillisecondsSince(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
 static std::vector<Feature*>& GetFeatures()
 {
 	static std::vector<Feature*> features;
 	return features;
 }
 
+#ifndef OE
+struct LazyTrigger
+{
+	Feature* feature;
+	ConCommandBase* command;
+	std::string key;
+	FnCommandCallback_t commandCallback;
+	FnChangeCallback_t changeCallback;
+	bool loaded;
+	bool available; // false if the feature didn't init the command when it loaded
+};
+
+// A trigger use that has to be repeated once its feature is loaded
+struct LazyReplay
+{
+	size_t trigger;
+	std::string commandString;
+	IConVar* var;
+	std::string oldValue;
+	float flOldValue;
+};
+
+static std::vector<LazyTrigger> lazyTriggers;
+static std::vector<Feature*> queuedLazyFeatures;
+static std::vector<LazyReplay> lazyReplays;
+static bool lazyLoadConnected = false;
+
+// Legacy names get a spt_ prefixed copy that shares the callback, so both have to map to the same trigger
+static std::string GetTriggerKey(const char* name)
+{
+	std::string key = name;
+	size_t sign = (key[0] == '+' || key[0] == '-') ? 1 : 0;
+	size_t prefix = key.find("spt_");
+	if (prefix == std::string::npos)
+		return key.substr(0, sign) + "spt_" + key.substr(sign);
+	return key.substr(0, sign) + key.substr(prefix);
+}
+
+static LazyTrigger* FindLazyTrigger(const char* name)
+{
+	std::string key = GetTriggerKey(name);
+	for (auto& trigger : lazyTriggers)
+	{
+		if (trigger.key == key)
+			return &trigger;
+	}
+	return nullptr;
+}
+
+static void RestoreLazyTrigger(LazyTrigger& trigger)
+{
+	if (trigger.command->IsCommand())
+		reinterpret_cast<ConCommand_guts*>(trigger.command)->m_fnCommandCallback = trigger.commandCallback;
+	else
+		reinterpret_cast<ConVar_guts*>(trigger.command)->m_fnChangeCallback = trigger.changeCallback;
+}
+
+static void QueueLazyFeature(Feature* feature)
+{
+	if (std::find(queuedLazyFeatures.begin(), queuedLazyFeatures.end(), feature) == queuedLazyFeatures.end())
+		queuedLazyFeatures.push_back(feature);
+
+	// Everything used in the same frame is loaded together, without a frame hook it has to happen right away
+	if (!FrameSignal.Works)
+		Feature::LoadLazyFeatures();
+}
+
+static void LazyChangeCallback(IConVar* var, const char* pOldValue, float flOldValue)
+{
+	LazyTrigger* trigger = FindLazyTrigger(var->GetName());
+	if (!trigger || trigger->loaded)
+		return;
+
+	size_t index = trigger - lazyTriggers.data();
+	auto replayed = std::find_if(lazyReplays.begin(),
+	                             lazyReplays.end(),
+	                             [index](const LazyReplay& replay) { return replay.trigger == index; });
+	// Only the value from before the first change matters
+	if (replayed == lazyReplays.end())
+		lazyReplays.push_back(LazyReplay{index, "", var, pOldValue ? pOldValue : "", flOldValue});
+
+	QueueLazyFeature(trigger->feature);
+}
+
+static void LazyCommandCallback(const CCommand& args)
+{
+	LazyTrigger* trigger = FindLazyTrigger(args.Arg(0));
+	if (!trigger)
+		return;
+
+	// Backwards compatibility copies keep pointing here after the feature has been loaded
+	if (trigger->loaded)
+	{
+		if (trigger->available)
+			trigger->commandCallback(args);
+		else
+			Warning("%s is not available in this game.\n", args.Arg(0));
+		return;
+	}
+
+	lazyReplays.push_back(LazyReplay{static_cast<size_t>(trigger - lazyTriggers.data()),
+	                                 args.GetCommandString(),
+	                                 nullptr,
+	                                 "",
+	                                 0.0f});
+	QueueLazyFeature(trigger->feature);
+}
+#endif
+
+static bool ShouldLoadLazily(Feature* feature)
+{
+#ifdef OE
+	return false;
+#else
+	return feature->IsLazy();
+#endif
+}
+
 void Feature::ReloadFeatures()
 {
 	reloadingFeatures = true;
@@ -48,6 +193,12 @@ void Feature::LoadFeatures()
 	{
 		if (!feature->moduleLoaded && feature->ShouldLoadFeature())
 		{
+			if (ShouldLoadLazily(feature))
+			{
+				feature->InitLazyTriggers();
+				continue;
+			}
+
 			feature->startedLoading = true;
 			feature->InitHooks();
 		}
@@ -74,9 +225,92 @@ void Feature::LoadFeatures()
 		}
 	}
 
+#ifndef OE
+	if (FrameSignal.Works && !lazyLoadConnected)
+	{
+		FrameSignal.Connect(&Feature::LoadLazyFeatures);
+		lazyLoadConnected = true;
+	}
+#endif
+
 	loadedOnce = true;
 }
 
+void Feature::LoadLazyFeatures()
+{
+#ifndef OE
+	if (queuedLazyFeatures.empty())
+		return;
+
+	auto start = std::chrono::steady_clock::now();
+	std::vector<Feature*> features;
+	features.swap(queuedLazyFeatures);
+
+	// Same steps as LoadFeatures, but only the new patterns are scanned for and only the new hooks attached
+	for (auto feature : features)
+	{
+		feature->startedLoading = true;
+		feature->InitHooks();
+	}
+
+	InitModules();
+
+	for (auto feature : features)
+		feature->PreHook();
+
+	Hook();
+
+	for (auto feature : features)
+	{
+		feature->LoadFeature();
+		feature->moduleLoaded = true;
+	}
+
+	for (auto& trigger : lazyTriggers)
+	{
+		if (std::find(features.begin(), features.end(), trigger.feature) == features.end())
+			continue;
+
+		trigger.loaded = true;
+		trigger.available = !Cvar_IsLazyTrigger(*trigger.command);
+		RestoreLazyTrigger(trigger);
+	}
+
+	for (auto feature : features)
+		Cvar_RemoveLazyTriggers(feature);
+	Cvar_RegisterLateCvars();
+
+	std::vector<LazyReplay> replays;
+	replays.swap(lazyReplays);
+	for (auto& replay : replays)
+	{
+		auto& trigger = lazyTriggers[replay.trigger];
+		if (!trigger.loaded)
+		{
+			lazyReplays.push_back(std::move(replay));
+			continue;
+		}
+
+		if (!trigger.available)
+		{
+			Warning("%s is not available in this game.\n", trigger.command->GetName());
+		}
+		else if (trigger.command->IsCommand())
+		{
+			CCommand command;
+			command.Tokenize(replay.commandString.c_str());
+			trigger.commandCallback(command);
+		}
+		else if (trigger.changeCallback)
+		{
+			trigger.changeCallback(replay.var, replay.oldValue.c_str(), replay.flOldValue);
+		}
+	}
+
+	DevMsg("Loaded %u lazy features in %.2f ms.\n", features.size(), MillisecondsSince(start));
+#endif
+}
+
 void Feature::UnloadFeatures()
 {
 	for (auto feature : GetFeatures())
@@ -90,6 +324,18 @@ void Feature::UnloadFeatures()
 
 	Unhook();
 
+#ifndef OE
+	// The commands outlive the plugin on restarts, so they must not keep pointing at the trampolines
+	for (auto& trigger : lazyTriggers)
+	{
+		if (!trigger.loaded)
+			RestoreLazyTrigger(trigger);
+	}
+	lazyTriggers.clear();
+	queuedLazyFeatures.clear();
+	lazyReplays.clear();
+#endif
+
 	for (auto feature : GetFeatures())
 	{
 		if (feature->moduleLoaded)
@@ -121,12 +367,72 @@ Feature::Feature()
 		GetFeatures().push_back(this);
 }
 
+static void PrintScanTimings(double totalMilliseconds)
+{
+	std::lock_guard<std::mutex> lock(scanTimingMutex);
+
+	for (auto& module : moduleTimings)
+	{
+		DevMsg("[%s] Initialized in %.2f ms.\n", module.moduleName.c_str(), module.milliseconds);
+
+		for (auto& chunk : chunkTimings)
+		{
+			if (chunk.moduleName != module.moduleName)
+				continue;
+
+			DevMsg("[%s]     %s chunk at %x (%x bytes) scanned in %.2f ms.\n",
+			       chunk.moduleName.c_str(),
+			       utils::GetSectionClassName(chunk.section),
+			       chunk.offset,
+			       chunk.size,
+			       chunk.milliseconds);
+		}
+	}
+
+	DevMsg("Initialized %u modules in %.2f ms using %u threads.\n",
+	       moduleTimings.size(),
+	       totalMilliseconds,
+	       utils::GetThreadPool().GetThreadCount());
+}
+
 void Feature::InitModules()
 {
+	std::string gameDir = GetGameDir();
+	if (!gameDir.empty())
+		utils::g_SignatureCache.Load(gameDir + "\\spt-signatures.json");
+
+	{
+		std::lock_guard<std::mutex> lock(scanTimingMutex);
+		chunkTimings.clear();
+		moduleTimings.clear();
+	}
+
+	// Modules are initialized in parallel, their scans are split further into chunks on the same pool
+	auto start = std::chrono::steady_clock::now();
+	utils::TaskGroup tasks(utils::GetThreadPool());
+	for (auto& pair : moduleHookData)
+	{
+		// Lazily loaded features only add a few patterns, modules that are already done are skipped
+		auto& data = pair.second;
+		if (data.patternHooks.empty() && data.matchAllPatterns.empty() && data.offsetHooks.empty())
+			continue;
+
+		auto modulePair = &pair;
+		tasks.Run([modulePair]() { modulePair->second.ScanModule(Convert(modulePair->first + ".dll")); });
+	}
+	tasks.Wait();
+
+	// The hooked pointers are read by the game's threads and the console isn't thread safe
 	for (auto& pair : moduleHookData)
 	{
-		pair.second.InitModule(Convert(pair.first + ".dll"));
+		auto& data = pair.second;
+		if (data.patternHooks.empty() && data.matchAllPatterns.empty() && data.offsetHooks.empty())
+			continue;
+		data.ApplyScan(Convert(pair.first + ".dll"));
 	}
+
+	utils::g_SignatureCache.Save();
+	PrintScanTimings(MillisecondsSince(start));
 }
 
 void Feature::Hook()
@@ -160,9 +466,26 @@ void Feature::AddOffsetHook(std::string moduleEnum,
 	mhd.offsetHooks.push_back(OffsetHook{offset, patternName, origPtr, functionHook});
 }
 
+std::vector<HookReport> Feature::GetHookReports()
+{
+	std::vector<HookReport> reports;
+	for (auto& pair : moduleHookData)
+		reports.insert(reports.end(), pair.second.hookReports.begin(), pair.second.hookReports.end());
+	return reports;
+}
+
+std::vector<ScanPassReport> Feature::GetScanPassReports()
+{
+	std::vector<ScanPassReport> reports;
+	for (auto& pair : moduleHookData)
+		reports.insert(reports.end(), pair.second.scanPassReports.begin(), pair.second.scanPassReports.end());
+	return reports;
+}
+
 int Feature::GetPatternIndex(void** origPtr)
 {
 	uintptr_t ptr = reinterpret_cast<uintptr_t>(origPtr);
+	std::lock_guard<std::mutex> lock(patternIndicesMutex);
 	if (patternIndices.find(ptr) != patternIndices.end())
 	{
 		return patternIndices[ptr];
@@ -178,6 +501,36 @@ void Feature::InitConcommandBase(ConCommandBase& convar)
 	Cvar_InitConCommandBase(convar, this);
 }
 
+void Feature::InitLazyTrigger(ConCommandBase& command)
+{
+#ifndef OE
+	LazyTrigger trigger{this, &command, GetTriggerKey(command.GetName()), nullptr, nullptr, false, false};
+
+	if (command.IsCommand())
+	{
+		auto& guts = reinterpret_cast<ConCommand_guts&>(command);
+		if (!guts.m_bUsingNewCommandCallback || guts.m_bUsingCommandCallbackInterface)
+		{
+			Warning("Command %s can't be a lazy trigger, its callback doesn't take arguments.\n",
+			        command.GetName());
+			return;
+		}
+
+		trigger.commandCallback = guts.m_fnCommandCallback;
+		guts.m_fnCommandCallback = LazyCommandCallback;
+	}
+	else
+	{
+		auto& guts = reinterpret_cast<ConVar_guts&>(command);
+		trigger.changeCallback = guts.m_fnChangeCallback;
+		guts.m_fnChangeCallback = LazyChangeCallback;
+	}
+
+	lazyTriggers.push_back(std::move(trigger));
+	Cvar_InitLazyTrigger(command, this);
+#endif
+}
+
 bool Feature::AddHudCallback(const char* key, std::function<void(std::string)> func, ConVar& convar)
 {
 #ifdef SPT_HUD_ENABLED
@@ -237,62 +590,389 @@ void ModuleHookData::UnhookModule(const std::wstring& moduleName)
 
 	for (auto& vft_hook : existingVTableHooks)
 		MemUtils::HookVTable(vft_hook.vftable, vft_hook.index, *vft_hook.origPtr);
+
+	hooked = false;
+}
+
+struct PatternGroup
+{
+	const patterns::PatternWrapper* patternArr;
+	size_t size;
+	const char* patternName;
+	bool matchAll;
+	utils::SectionClass section;
+};
+
+static std::string GetPatternFingerprint(const PatternGroup& group)
+{
+	std::string fingerprint;
+	for (size_t i = 0; i < group.size; ++i)
+	{
+		fingerprint += group.patternArr[i].name();
+		fingerprint += ':';
+		fingerprint += std::to_string(group.patternArr[i].length());
+		fingerprint += ';';
+	}
+	return fingerprint;
+}
+
+static bool GetCachedResult(const std::string& moduleName,
+                            const PatternGroup& group,
+                            const uint8_t* moduleStart,
+                            size_t moduleSize,
+                            bool verify,
+                            utils::PatternScanResult& result)
+{
+	std::vector<utils::CachedMatch> matches;
+	if (!utils::g_SignatureCache.Lookup(moduleName, group.patternName, GetPatternFingerprint(group), matches))
+		return false;
+
+	if (!group.matchAll && matches.size() > 1)
+		return false;
+
+	// Confirm every cached hit, anything that doesn't match anymore means a rescan
+	for (auto& match : matches)
+	{
+		if (match.index < 0 || static_cast<size_t>(match.index) >= group.size)
+			return false;
+
+		auto& pattern = group.patternArr[match.index];
+		if (match.rva > moduleSize || pattern.length() > moduleSize - match.rva)
+			return false;
+		if (verify && !pattern.match(moduleStart + match.rva))
+			return false;
+	}
+
+	for (auto& match : matches)
+	{
+		uintptr_t address = reinterpret_cast<uintptr_t>(moduleStart) + match.rva;
+		if (group.matchAll)
+		{
+			patterns::MatchedPattern matched;
+			matched.ptnIndex = match.index;
+			matched.ptr = address;
+			result.matches.push_back(matched);
+		}
+		else
+		{
+			result.index = match.index;
+			result.address = address;
+		}
+	}
+
+	return true;
+}
+
+static void StoreResult(const std::string& moduleName,
+                        const PatternGroup& group,
+                        const uint8_t* moduleStart,
+                        const utils::PatternScanResult& result)
+{
+	std::vector<utils::CachedMatch> matches;
+	auto base = reinterpret_cast<uintptr_t>(moduleStart);
+
+	if (result.index != -1)
+		matches.push_back(utils::CachedMatch{static_cast<uint32_t>(result.address - base), result.index});
+
+	for (auto& match : result.matches)
+	{
+		matches.push_back(
+		    utils::CachedMatch{static_cast<uint32_t>(match.ptr - base), static_cast<int>(match.ptnIndex)});
+	}
+
+	utils::g_SignatureCache.Store(moduleName, group.patternName, GetPatternFingerprint(group), matches);
+}
+
+// Scans for the given groups, each group only in the sections of its class unless wholeModule is set
+static void ScanGroups(const std::string& moduleName,
+                       const std::vector<PatternGroup>& groups,
+                       const std::vector<size_t>& indices,
+                       const utils::PEImage& image,
+                       const uint8_t* moduleStart,
+                       size_t moduleSize,
+                       bool wholeModule,
+                       std::vector<utils::PatternScanResult>& results,
+                       std::vector<std::vector<int>>& groupPasses,
+                       std::vector<ScanPassReport>& passes)
+{
+	const utils::SectionClass sectionClasses[] = {
+	    utils::SectionClass::Any,
+	    utils::SectionClass::Code,
+	    utils::SectionClass::RData,
+	    utils::SectionClass::Data,
+	};
+	const size_t classCount = ARRAYSIZE(sectionClasses);
+
+	utils::PatternScanner scanners[classCount];
+	std::vector<size_t> scannerGroups[classCount];
+
+	for (size_t c = 0; c < classCount; ++c)
+	{
+		for (size_t i : indices)
+		{
+			auto groupClass = wholeModule ? utils::SectionClass::Any : groups[i].section;
+			if (groupClass == sectionClasses[c])
+			{
+				scanners[c].AddGroup(groups[i].patternArr, groups[i].size, groups[i].matchAll);
+				scannerGroups[c].push_back(i);
+			}
+		}
+		scanners[c].Build();
+	}
+
+	// Every section range is split into chunks that are scanned on the thread pool
+	struct Chunk
+	{
+		size_t scanner;
+		size_t from;
+		size_t to;
+		std::vector<utils::PatternScanResult> results;
+		double milliseconds;
+	};
+	std::vector<Chunk> chunks;
+
+	for (size_t c = 0; c < classCount; ++c)
+	{
+		if (scannerGroups[c].empty())
+			continue;
+
+		for (auto& range : image.GetRanges(sectionClasses[c]))
+		{
+			for (size_t from = range.first; from < range.second; from += SCAN_CHUNK_SIZE)
+				chunks.push_back(Chunk{c, from, (std::min)(from + SCAN_CHUNK_SIZE, range.second)});
+		}
+	}
+
+	utils::TaskGroup tasks(utils::GetThreadPool());
+	for (auto& chunk : chunks)
+	{
+		tasks.Run(
+		    [&, chunkPtr = &chunk]()
+		    {
+			    auto start = std::chrono::steady_clock::now();
+			    auto& scanner = scanners[chunkPtr->scanner];
+			    scanner.ScanRange(moduleStart, moduleSize, chunkPtr->from, chunkPtr->to, chunkPtr->results);
+
+			    chunkPtr->milliseconds = MillisecondsSince(start);
+			    ScanTiming timing{moduleName,
+			                      sectionClasses[chunkPtr->scanner],
+			                      chunkPtr->from,
+			                      chunkPtr->to - chunkPtr->from,
+			                      chunkPtr->milliseconds};
+			    std::lock_guard<std::mutex> lock(scanTimingMutex);
+			    chunkTimings.push_back(std::move(timing));
+		    });
+	}
+	tasks.Wait();
+
+	for (size_t c = 0; c < classCount; ++c)
+	{
+		if (scannerGroups[c].empty())
+			continue;
+
+		ScanPassReport pass{static_cast<int>(passes.size()),
+		                    moduleName,
+		                    sectionClasses[c],
+		                    wholeModule,
+		                    scannerGroups[c].size(),
+		                    0,
+		                    0};
+		std::vector<utils::PatternScanResult> scanResults;
+		for (auto& chunk : chunks)
+		{
+			if (chunk.scanner != c)
+				continue;
+
+			scanners[c].MergeResults(scanResults, chunk.results);
+			pass.milliseconds += chunk.milliseconds;
+			pass.bytesScanned += chunk.to - chunk.from;
+		}
+		scanners[c].FinishResults(scanResults);
+		scanResults.resize(scannerGroups[c].size());
+
+		for (size_t group = 0; group < scannerGroups[c].size(); ++group)
+		{
+			size_t i = scannerGroups[c][group];
+			results[i] = std::move(scanResults[group]);
+			groupPasses[i].push_back(pass.id);
+		}
+		passes.push_back(std::move(pass));
+	}
 }
 
-void ModuleHookData::InitModule(const std::wstring& moduleName)
+void ModuleHookData::ScanModule(const std::wstring& moduleName)
 {
 	void* handle;
-	void* moduleStart;
-	size_t moduleSize;
+	scan = ModuleScan();
+	if (!MemUtils::GetModuleInfo(moduleName, &handle, &scan.moduleStart, &scan.moduleSize))
+		return;
+	scan.loaded = true;
 
-	if (MemUtils::GetModuleInfo(moduleName, &handle, &moduleStart, &moduleSize))
+	auto initStart = std::chrono::steady_clock::now();
+	bool patched = hooked;
+	std::string cacheModuleName = Convert(moduleName);
+	auto start = reinterpret_cast<const uint8_t*>(scan.moduleStart);
+	size_t moduleSize = scan.moduleSize;
+	// On restarts the module is usually mapped again unchanged, then only the detours have to be redone
+	scan.unchanged = utils::g_SignatureCache.BeginModule(cacheModuleName, start, moduleSize);
+
+	// Groups that the cache can't answer are scanned for, matchAllPatterns come first in the results
+	std::vector<PatternGroup> groups;
+	groups.reserve(matchAllPatterns.size() + patternHooks.size());
+	for (auto& mpattern : matchAllPatterns)
 	{
-		DevMsg("Hooking %s (start: %p; size: %x)...\n", Convert(moduleName).c_str(), moduleStart, moduleSize);
+		groups.push_back(
+		    PatternGroup{mpattern.patternArr, mpattern.size, mpattern.patternName, true, mpattern.section});
 	}
-	else
+	for (auto& pattern : patternHooks)
+	{
+		groups.push_back(
+		    PatternGroup{pattern.patternArr, pattern.size, pattern.patternName, false, pattern.section});
+	}
+
+	auto& results = scan.results;
+	results.resize(groups.size());
+	std::vector<double> lookupMilliseconds(groups.size());
+	std::vector<std::vector<int>> groupPasses(groups.size());
+	std::vector<bool> fromCache(groups.size(), false);
+	std::vector<size_t> scannedGroups;
+
+	bool verify = !scan.unchanged;
+	for (size_t i = 0; i < groups.size(); ++i)
+	{
+		auto lookupStart = std::chrono::steady_clock::now();
+		fromCache[i] = GetCachedResult(cacheModuleName, groups[i], start, moduleSize, verify, results[i]);
+		lookupMilliseconds[i] = MillisecondsSince(lookupStart);
+
+		if (!fromCache[i])
+			scannedGroups.push_back(i);
+	}
+	scan.cachedCount = groups.size() - scannedGroups.size();
+
+	if (!scannedGroups.empty())
+	{
+		utils::PEImage image;
+		image.Parse(start, moduleSize);
+		ScanGroups(cacheModuleName,
+		           groups,
+		           scannedGroups,
+		           image,
+		           start,
+		           moduleSize,
+		           false,
+		           results,
+		           groupPasses,
+		           scan.passes);
+
+		// Nothing in the expected section, give the whole module a go before giving up
+		std::vector<size_t> missingGroups;
+		for (size_t i : scannedGroups)
+		{
+			if (groups[i].section != utils::SectionClass::Any && results[i].index == -1
+			    && results[i].matches.empty())
+				missingGroups.push_back(i);
+		}
+		ScanGroups(cacheModuleName,
+		           groups,
+		           missingGroups,
+		           image,
+		           start,
+		           moduleSize,
+		           true,
+		           results,
+		           groupPasses,
+		           scan.passes);
+
+		// Once hooked, the code has detours and byte patches in it. What's found in it now isn't what a clean
+		// module would give, so it's not kept for later starts.
+		if (!patched)
+		{
+			for (size_t i : scannedGroups)
+				StoreResult(cacheModuleName, groups[i], start, results[i]);
+		}
+	}
+
+	for (size_t i = 0; i < groups.size(); ++i)
+	{
+		HookReport report;
+		report.moduleName = cacheModuleName;
+		report.patternName = groups[i].patternName;
+		report.patternIndex = results[i].index;
+		report.matchCount = groups[i].matchAll ? results[i].matches.size() : (results[i].index != -1 ? 1 : 0);
+		report.lookupMilliseconds = lookupMilliseconds[i];
+		report.scanPasses = std::move(groupPasses[i]);
+		report.matchAll = groups[i].matchAll;
+		report.fromCache = fromCache[i];
+		report.detoured = false;
+		report.origPtr = groups[i].matchAll ? nullptr : patternHooks[i - matchAllPatterns.size()].origPtr;
+		report.patternArr = groups[i].patternArr;
+		report.patternCount = groups[i].size;
+		report.section = groups[i].section;
+
+		if (results[i].index != -1)
+			report.alternativeName = groups[i].patternArr[results[i].index].name();
+		else if (!results[i].matches.empty())
+			report.alternativeName = groups[i].patternArr[results[i].matches.front().ptnIndex].name();
+
+		scan.reports.push_back(std::move(report));
+	}
+
+	ScanTiming timing{cacheModuleName, utils::SectionClass::Any, 0, moduleSize, MillisecondsSince(initStart)};
+	std::lock_guard<std::mutex> lock(scanTimingMutex);
+	moduleTimings.push_back(std::move(timing));
+}
+
+void ModuleHookData::ApplyScan(const std::wstring& moduleName)
+{
+	if (!scan.loaded)
 	{
 		DevMsg("Couldn't hook %s, not loaded\n", Convert(moduleName).c_str());
 		return;
 	}
 
-	std::vector<std::future<patterns::PatternWrapper*>> hooks;
-	std::vector<std::future<std::vector<patterns::MatchedPattern>>> mhooks;
-	hooks.reserve(patternHooks.size());
+	void* moduleStart = scan.moduleStart;
+	auto& results = scan.results;
+	DevMsg("Hooking %s (start: %p; size: %x)...\n", Convert(moduleName).c_str(), moduleStart, scan.moduleSize);
+	if (scan.unchanged)
+		DevMsg("[%s] Module is unchanged since the last load, reusing its resolved patterns.\n",
+		       Convert(moduleName).c_str());
+	DevMsg("[%s] %u of %u patterns resolved from the signature cache.\n",
+	       Convert(moduleName).c_str(),
+	       scan.cachedCount,
+	       results.size());
 
-	for (auto& mpattern : matchAllPatterns)
+	// Pass ids count up over every scan of the module, lazily loaded features scan it again later
+	int firstPass = static_cast<int>(scanPassReports.size());
+	for (auto& pass : scan.passes)
 	{
-		mhooks.emplace_back(MemUtils::find_all_sequences_async(moduleStart,
-		                                                       moduleSize,
-		                                                       mpattern.patternArr,
-		                                                       mpattern.patternArr + mpattern.size));
+		pass.id += firstPass;
+		scanPassReports.push_back(std::move(pass));
 	}
-
-	for (auto& pattern : patternHooks)
+	for (auto& report : scan.reports)
 	{
-		hooks.emplace_back(MemUtils::find_unique_sequence_async(*pattern.origPtr,
-		                                                        moduleStart,
-		                                                        moduleSize,
-		                                                        pattern.patternArr,
-		                                                        pattern.patternArr + pattern.size));
+		for (int& pass : report.scanPasses)
+			pass += firstPass;
+		hookReports.push_back(std::move(report));
 	}
 
 	funcPairs.reserve(funcPairs.size() + patternHooks.size());
 	hookedFunctions.reserve(hookedFunctions.size() + patternHooks.size());
 
-	for (std::size_t i = 0; i < mhooks.size(); ++i)
+	for (std::size_t i = 0; i < matchAllPatterns.size(); ++i)
 	{
 		auto modulePattern = matchAllPatterns[i];
-		*modulePattern.foundVec = std::move(mhooks[i].get());
+		*modulePattern.foundVec = results[i].matches;
 		DevMsg("[%s] Found %u instances of pattern %s\n",
 		       Convert(moduleName).c_str(),
 		       modulePattern.foundVec->size(),
 		       modulePattern.patternName);
 	}
 
-	for (std::size_t i = 0; i < hooks.size(); ++i)
+	for (std::size_t i = 0; i < patternHooks.size(); ++i)
 	{
-		auto foundPattern = hooks[i].get();
+		auto& result = results[matchAllPatterns.size() + i];
 		auto modulePattern = patternHooks[i];
+		*modulePattern.origPtr = reinterpret_cast<void*>(result.address);
 
 		if (*modulePattern.origPtr)
 		{
@@ -306,9 +986,9 @@ void ModuleHookData::InitModule(const std::wstring& moduleName)
 			       Convert(moduleName).c_str(),
 			       modulePattern.patternName,
 			       *modulePattern.origPtr,
-			       foundPattern->name());
-			patternIndices[reinterpret_cast<uintptr_t>(modulePattern.origPtr)] =
-			    foundPattern - modulePattern.patternArr;
+			       modulePattern.patternArr[result.index].name());
+			std::lock_guard<std::mutex> lock(patternIndicesMutex);
+			patternIndices[reinterpret_cast<uintptr_t>(modulePattern.origPtr)] = result.index;
 		}
 		else
 		{
@@ -331,10 +1011,15 @@ void ModuleHookData::InitModule(const std::wstring& moduleName)
 			hookedFunctions.emplace_back(offset.origPtr);
 		}
 	}
+
+	scan = ModuleScan();
 }
 
 void ModuleHookData::HookModule(const std::wstring& moduleName)
 {
+	// Detours and the byte patches of the features go in from here on
+	hooked = true;
+
 	if (!vftableHooks.empty())
 	{
 		for (auto& vft_hook : vftableHooks)
@@ -350,11 +1035,22 @@ void ModuleHookData::HookModule(const std::wstring& moduleName)
 			MemUtils::MarkAsExecutable(*(entry.first));
 
 		DetoursUtils::AttachDetours(moduleName, funcPairs.size(), &funcPairs[0]);
+
+		for (auto& report : hookReports)
+		{
+			for (auto& entry : funcPairs)
+			{
+				if (report.origPtr == entry.first)
+					report.detoured = true;
+			}
+		}
 	}
 
-	// Clear any hooks that were added
+	// Clear any hooks that were added, lazily loaded features add new ones later
 	offsetHooks.clear();
 	patternHooks.clear();
+	matchAllPatterns.clear();
+	funcPairs.clear();
 	// VTable hooks have to be stored for the unhooking code
 	existingVTableHooks.insert(existingVTableHooks.end(), vftableHooks.begin(), vftableHooks.end());
 	vftableHooks.clear();
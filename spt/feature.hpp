@@ -7,6 +7,8 @@
 #include "SPTLib\patterns.hpp"
 #include "SPTLib\memutils.hpp"
 #include "convar.hpp"
+#include "pattern_scanner.hpp"
+#include "pe_image.hpp"
 
 // cdecl convention
 
@@ -59,6 +61,13 @@
 
 #define FIND_PATTERN(moduleName, name) \
 	AddPatternHook(patterns::##name##, #moduleName, #name, reinterpret_cast<void**>(&ORIG_##name##), nullptr);
+#define FIND_PATTERN_IN(moduleName, name, section) \
+	AddPatternHook(patterns::##name##, \
+	               #moduleName, \
+	               #name, \
+	               reinterpret_cast<void**>(&ORIG_##name##), \
+	               nullptr, \
+	               utils::SectionClass::##section);
 #define FIND_PATTERN_ALL(moduleName, name) \
 	AddMatchAllPattern(patterns::##name##, #moduleName, #name, &MATCHES_##name##);
 
@@ -112,13 +121,15 @@ struct PatternHook
 	            size_t size,
 	            const char* patternName,
 	            void** origPtr,
-	            void* functionHook)
+	            void* functionHook,
+	            utils::SectionClass section = utils::SectionClass::Code)
 	{
 		this->patternArr = patternArr;
 		this->size = size;
 		this->patternName = patternName;
 		this->origPtr = origPtr;
 		this->functionHook = functionHook;
+		this->section = section;
 	}
 
 	patterns::PatternWrapper* patternArr;
@@ -126,6 +137,8 @@ struct PatternHook
 	const char* patternName;
 	void** origPtr;
 	void* functionHook;
+	// Where the pattern is looked for first, the whole module is scanned if it isn't found there
+	utils::SectionClass section;
 };
 
 struct MatchAllPattern
@@ -133,18 +146,21 @@ struct MatchAllPattern
 	MatchAllPattern(patterns::PatternWrapper* patternArr,
 	                size_t size,
 	                const char* patternName,
-	                std::vector<patterns::MatchedPattern>* foundVec)
+	                std::vector<patterns::MatchedPattern>* foundVec,
+	                utils::SectionClass section = utils::SectionClass::Code)
 	{
 		this->patternArr = patternArr;
 		this->size = size;
 		this->patternName = patternName;
 		this->foundVec = foundVec;
+		this->section = section;
 	}
 
 	patterns::PatternWrapper* patternArr;
 	size_t size;
 	const char* patternName;
 	std::vector<patterns::MatchedPattern>* foundVec;
+	utils::SectionClass section;
 };
 
 struct OffsetHook
@@ -162,6 +178,56 @@ struct RawHook
 	void* functionHook;
 };
 
+// How a pattern was resolved, see spt_hook_report
+struct HookReport
+{
+	std::string moduleName;
+	std::string patternName;
+	std::string alternativeName; // empty if nothing was found
+	int patternIndex;
+	size_t matchCount;
+	// the signature cache lookup, the only part of the cost that belongs to this pattern alone
+	double lookupMilliseconds;
+	// ids of the ScanPassReports of this module that looked for the pattern, they share their cost
+	std::vector<int> scanPasses;
+	bool matchAll;
+	bool fromCache;
+	bool detoured;
+	void** origPtr;
+	// the pattern table itself, so it can be checked against other builds
+	const patterns::PatternWrapper* patternArr;
+	size_t patternCount;
+	utils::SectionClass section;
+};
+
+/*
+* One walk of the scanner over the sections of a class. All patterns of a pass are matched in the same walk over
+* the memory, so its time can't be split between them, see HookReport::scanPasses.
+*/
+struct ScanPassReport
+{
+	int id;
+	std::string moduleName;
+	utils::SectionClass section;
+	bool fallback; // the whole module, for patterns that weren't found in their sections
+	size_t patternCount;
+	double milliseconds; // summed over the chunks, which are scanned in parallel
+	size_t bytesScanned;
+};
+
+// What ModuleHookData::ScanModule found, matchAllPatterns come first in results and reports
+struct ModuleScan
+{
+	bool loaded = false;
+	bool unchanged = false;
+	void* moduleStart = nullptr;
+	size_t moduleSize = 0;
+	size_t cachedCount = 0;
+	std::vector<utils::PatternScanResult> results;
+	std::vector<HookReport> reports;
+	std::vector<ScanPassReport> passes;
+};
+
 struct ModuleHookData
 {
 	std::vector<PatternHook> patternHooks;
@@ -172,7 +238,14 @@ struct ModuleHookData
 	std::vector<std::pair<void**, void*>> funcPairs;
 	std::vector<void**> hookedFunctions;
 	std::vector<VFTableHook> existingVTableHooks;
-	void InitModule(const std::wstring& moduleName);
+	std::vector<HookReport> hookReports;
+	std::vector<ScanPassReport> scanPassReports;
+	ModuleScan scan;
+	bool hooked = false; // the code has detours in it, scans of lazily loaded features see them
+	// Resolves the patterns into scan, doesn't touch anything else so it can run on a worker thread
+	void ScanModule(const std::wstring& moduleName);
+	// Hands the results of ScanModule out to the hooked pointers and logs them, on the main thread
+	void ApplyScan(const std::wstring& moduleName);
 	void HookModule(const std::wstring& moduleName);
 	void UnhookModule(const std::wstring& moduleName);
 };
@@ -185,6 +258,12 @@ public:
 	{
 		return true;
 	};
+	// Lazy features only resolve their hooks and load the first time one of their lazy triggers is used
+	virtual bool IsLazy()
+	{
+		return false;
+	};
+	virtual void InitLazyTriggers(){};
 	virtual void InitHooks(){};
 	virtual void PreHook(){};
 	virtual void LoadFeature(){};
@@ -195,18 +274,22 @@ public:
 	static void ReloadFeatures();
 	static void LoadFeatures();
 	static void UnloadFeatures();
+	// Loads the lazy features whose triggers were used, called every frame
+	static void LoadLazyFeatures();
 
 	template<size_t PatternLength>
 	static void AddPatternHook(const std::array<patterns::PatternWrapper, PatternLength>& patterns,
 	                           std::string moduleName,
 	                           const char* patternName,
 	                           void** origPtr = nullptr,
-	                           void* functionHook = nullptr);
+	                           void* functionHook = nullptr,
+	                           utils::SectionClass section = utils::SectionClass::Code);
 	template<size_t PatternLength>
 	static void AddMatchAllPattern(const std::array<patterns::PatternWrapper, PatternLength>& patterns,
 	                               std::string moduleName,
 	                               const char* patternName,
-	                               std::vector<patterns::MatchedPattern>* foundVec);
+	                               std::vector<patterns::MatchedPattern>* foundVec,
+	                               utils::SectionClass section = utils::SectionClass::Code);
 	static void AddRawHook(std::string moduleName, void** origPtr, void* functionHook);
 	static void AddPatternHook(PatternHook hook, std::string moduleEnum);
 	static void AddMatchAllPattern(MatchAllPattern hook, std::string moduleName);
@@ -217,11 +300,15 @@ public:
 	                          void** origPtr = nullptr,
 	                          void* functionHook = nullptr);
 	static int GetPatternIndex(void** origPtr);
+	static std::vector<HookReport> GetHookReports();
+	static std::vector<ScanPassReport> GetScanPassReports();
 
 	Feature();
 
 protected:
 	void InitConcommandBase(ConCommandBase& convar);
+	// Registers a ConVar or command of a lazy feature, changing or running it loads the feature
+	void InitLazyTrigger(ConCommandBase& command);
 	bool AddHudCallback(const char* key, std::function<void(std::string)> func, ConVar& cvar);
 
 	bool moduleLoaded;
@@ -253,13 +340,15 @@ inline void Feature::AddPatternHook(const std::array<patterns::PatternWrapper, P
                                     std::string moduleEnum,
                                     const char* patternName,
                                     void** origPtr,
-                                    void* functionHook)
+                                    void* functionHook,
+                                    utils::SectionClass section)
 {
 	AddPatternHook(PatternHook(const_cast<patterns::PatternWrapper*>(p.data()),
 	                           PatternLength,
 	                           patternName,
 	                           origPtr,
-	                           functionHook),
+	                           functionHook,
+	                           section),
 	               moduleEnum);
 }
 
@@ -267,11 +356,13 @@ template<size_t PatternLength>
 inline void Feature::AddMatchAllPattern(const std::array<patterns::PatternWrapper, PatternLength>& patterns,
                                         std::string moduleName,
                                         const char* patternName,
-                                        std::vector<patterns::MatchedPattern>* foundVec)
+                                        std::vector<patterns::MatchedPattern>* foundVec,
+                                        utils::SectionClass section)
 {
 	AddMatchAllPattern(MatchAllPattern(const_cast<patterns::PatternWrapper*>(patterns.data()),
 	                                   PatternLength,
 	                                   patternName,
-	                                   foundVec),
+	                                   foundVec,
+	                                   section),
 	                   moduleName);
 }
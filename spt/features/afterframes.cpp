@@ -4,23 +4,87 @@
 #include "..\sptlib-wrapper.hpp"
 #include "..\cvars.hpp"
 #include "signals.hpp"
+#include "scheduler.hpp"
 #include "dbg.h"
+#include <algorithm>
 #include <sstream>
 
 AfterframesFeature spt_afterframes;
-static std::vector<afterframes_entry_t> afterframesQueue;
+static utils::Scheduler<afterframes_entry_t> afterframesQueue;
+static std::vector<utils::Scheduler<afterframes_entry_t>::Item> dueEntries;
 static bool afterframesPaused = false;
 static int afterframesDelay = 0;
 
+static std::unique_ptr<AfterframesStream> stream;
+static afterframes_stream_entry_t streamNext; // generated but not queued yet
+static bool streamHasNext = false;
+static uint64_t streamPos = 0;
+static long long streamStart = 0;
+static uint64_t streamSeq = 0;
+static long long streamWindow = 0;
+
 ConVar _y_spt_afterframes_await_legacy("_y_spt_afterframes_await_legacy",
                                        "0",
                                        FCVAR_TAS_RESET,
                                        "Set to 1 for backwards compatibility with old scripts.");
 ConVar _y_spt_afterframes_reset_on_server_activate("_y_spt_afterframes_reset_on_server_activate", "1", FCVAR_ARCHIVE);
+ConVar _y_spt_afterframes_prepare(
+    "_y_spt_afterframes_prepare",
+    "1",
+    FCVAR_ARCHIVE,
+    "Resolve afterframes commands when they're queued and run cvar changes and +/- commands directly instead of "
+    "through the command buffer.");
 
 void AfterframesFeature::AddAfterFramesEntry(afterframes_entry_t entry)
 {
-	afterframesQueue.push_back(entry);
+	if (_y_spt_afterframes_prepare.GetBool() && !entry.prepared)
+		entry.prepared = PrepareCommand(entry.command);
+	long long delay = entry.framesLeft;
+	afterframesQueue.Add(delay, std::move(entry));
+}
+
+static void ClearStream()
+{
+	stream.reset();
+	streamHasNext = false;
+	streamPos = 0;
+}
+
+static void FillFromStream()
+{
+	if (!stream)
+		return;
+
+	long long now = afterframesQueue.GetNow();
+
+	while (streamHasNext || stream->Next(streamNext))
+	{
+		streamHasNext = true;
+		long long due = streamStart + streamNext.framesLeft;
+		if (streamWindow > 0 && due > now + streamWindow)
+			return;
+
+		afterframes_entry_t entry(due - now, *streamNext.command);
+		if (_y_spt_afterframes_prepare.GetBool())
+			entry.prepared = PrepareCommand(entry.command);
+		afterframesQueue.AddReserved(due - now, streamSeq + streamPos, std::move(entry));
+		streamHasNext = false;
+		++streamPos;
+	}
+
+	ClearStream();
+}
+
+void AfterframesFeature::SetAfterFramesStream(std::unique_ptr<AfterframesStream> newStream, long long window)
+{
+	ClearStream();
+	stream = std::move(newStream);
+
+	// The entries take up the sequence numbers they'd have had if they were all added now
+	streamStart = afterframesQueue.GetNow();
+	streamSeq = afterframesQueue.ReserveSeq(stream->GetCount());
+	streamWindow = window;
+	FillFromStream();
 }
 
 void AfterframesFeature::DelayAfterframesQueue(int delay)
@@ -30,7 +94,8 @@ void AfterframesFeature::DelayAfterframesQueue(int delay)
 
 void AfterframesFeature::ResetAfterframesQueue()
 {
-	afterframesQueue.clear();
+	afterframesQueue.Clear();
+	ClearStream();
 }
 
 void AfterframesFeature::PauseAfterframesQueue()
@@ -48,7 +113,11 @@ bool AfterframesFeature::ShouldLoadFeature()
 	return true;
 }
 
-void AfterframesFeature::UnloadFeature() {}
+void AfterframesFeature::UnloadFeature()
+{
+	// Entries that survive the unload prepare their commands again
+	ClearPreparedCommands();
+}
 
 void AfterframesFeature::PreHook()
 {
@@ -71,17 +140,26 @@ void AfterframesFeature::OnFrame()
 		return;
 	}
 
-	for (auto it = afterframesQueue.begin(); it != afterframesQueue.end();)
+	FillFromStream();
+	afterframesQueue.Advance(1, dueEntries);
+
+	// Commands that run directly can queue new entries, so they only run once the due ones have been taken out
+	bool textQueued = false;
+	for (auto& item : dueEntries)
 	{
-		it->framesLeft--;
-		if (it->framesLeft <= 0)
+		auto& entry = item.value;
+
+		if (!_y_spt_afterframes_prepare.GetBool())
 		{
-			EngineConCmd(it->command.c_str());
-			it = afterframesQueue.erase(it);
+			EngineConCmd(entry.command.c_str());
+			continue;
 		}
-		else
-			++it;
+
+		if (!entry.prepared || !entry.prepared->IsValid())
+			entry.prepared = PrepareCommand(entry.command);
+		entry.prepared->Execute(textQueued);
 	}
+	dueEntries.clear();
 
 	AfterFramesSignal();
 }
@@ -187,6 +265,8 @@ void AfterframesFeature::LoadFeature()
 			InitConcommandBase(_y_spt_afterframes_reset_on_server_activate);
 		}
 
+		InitConcommandBase(_y_spt_afterframes_prepare);
+
 		if (FinishRestoreSignal.Works || SetPausedSignal.Works)
 		{
 			FinishRestoreSignal.Connect(this, &AfterframesFeature::FinishRestore);
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "..\feature.hpp"
+#include "afterframes_stream.hpp"
+#include "prepared_command.hpp"
 #include "thirdparty\Signal.h"
 
 struct afterframes_entry_t
@@ -12,6 +14,7 @@ struct afterframes_entry_t
 	afterframes_entry_t() {}
 	long long int framesLeft;
 	std::string command;
+	std::shared_ptr<const PreparedCommand> prepared;
 };
 
 // This feature enables spt_afterframes
@@ -19,6 +22,8 @@ class AfterframesFeature : public FeatureWrapper<AfterframesFeature>
 {
 public:
 	void AddAfterFramesEntry(afterframes_entry_t entry);
+	// Replaces the current stream, entries are queued at most window frames ahead. 0 queues everything now.
+	void SetAfterFramesStream(std::unique_ptr<AfterframesStream> stream, long long window);
 
 	void DelayAfterframesQueue(int delay);
 	void ResetAfterframesQueue();
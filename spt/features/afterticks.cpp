@@ -4,11 +4,13 @@
 #include "..\sptlib-wrapper.hpp"
 #include "..\cvars.hpp"
 #include "signals.hpp"
+#include "scheduler.hpp"
 #include "dbg.h"
 #include <sstream>
 
 AfterticksFeature spt_afterticks;
-static std::vector<afterticks_entry_t> afterticksQueue;
+static utils::Scheduler<afterticks_entry_t> afterticksQueue;
+static std::vector<utils::Scheduler<afterticks_entry_t>::Item> dueEntries;
 static bool afterticksPaused = false;
 static int afterticksDelay = 0;
 
@@ -34,12 +36,13 @@ namespace patterns
 
 void AfterticksFeature::AddAfterticksEntry(afterticks_entry_t entry)
 {
-	afterticksQueue.push_back(entry);
+	long long delay = entry.ticksLeft;
+	afterticksQueue.Add(delay, std::move(entry));
 }
 
 void AfterticksFeature::ResetAfterticksQueue()
 {
-	afterticksQueue.clear();
+	afterticksQueue.Clear();
 }
 
 void AfterticksFeature::PauseAfterticksQueue()
@@ -90,22 +93,18 @@ void AfterticksFeature::OnFrame()
 		return;
 	}
 
-	for (auto it = afterticksQueue.begin(); it != afterticksQueue.end();)
-	{
-		it->ticksLeft -= diff;
-		if (it->ticksLeft <= 0)
-		{
-			EngineConCmd(it->command.c_str());
-			if (it->ticksLeft < 0)
-				DevWarning("afterticks: command \"%s\" fired late by %i tick(s)\n",
-					it->command.c_str(), 
-					it->ticksLeft * -1);
+	afterticksQueue.Advance(diff, dueEntries);
 
-			it = afterticksQueue.erase(it);
-		}
-		else
-			++it;
+	for (auto& item : dueEntries)
+	{
+		EngineConCmd(item.value.command.c_str());
+		long long late = afterticksQueue.GetNow() - item.due;
+		if (late > 0)
+			DevWarning("afterticks: command \"%s\" fired late by %i tick(s)\n",
+				item.value.command.c_str(),
+				static_cast<int>(late));
 	}
+	dueEntries.clear();
 }
 
 void AfterticksFeature::SV_ActivateServer(bool result)
@@ -191,7 +190,7 @@ CON_COMMAND(_y_spt_afterticks_reset, "Reset the afterticks queue.")
 
 void AfterticksFeature::InitHooks() 
 {
-	FIND_PATTERN(engine, HostRunframe__TargetString);
+	FIND_PATTERN_IN(engine, HostRunframe__TargetString, RData);
 	FIND_PATTERN_ALL(engine, Engine__StringReferences);
 }
 
@@ -34,6 +34,14 @@ public:
 protected:
     virtual bool ShouldLoadFeature() override;
 
+    // Con_ColorPrint is hooked for every console print, so only do it once spt_con_notify is used
+    virtual bool IsLazy() override
+    {
+        return true;
+    }
+
+    virtual void InitLazyTriggers() override;
+
     virtual void InitHooks() override;
 
     virtual void LoadFeature() override;
@@ -51,6 +59,11 @@ bool ConNotifyFeature::ShouldLoadFeature()
     return true;
 }
 
+void ConNotifyFeature::InitLazyTriggers()
+{
+    InitLazyTrigger(spt_con_notify_cvar);
+}
+
 void ConNotifyFeature::InitHooks()
 {
     HOOK_FUNCTION(engine, Con_ColorPrint);
@@ -0,0 +1,241 @@
+#include "stdafx.hpp"
+#include "..\feature.hpp"
+#include "convar.hpp"
+#include "desync_stream.hpp"
+#include "ent_props.hpp"
+#include "file.hpp"
+#include "interfaces.hpp"
+#include "playerio.hpp"
+#include "signals.hpp"
+#include "game_fixes\rng.hpp"
+#include "..\sptlib-wrapper.hpp"
+
+#include <cstring>
+
+// Per tick state hashing for finding where a run desyncs
+class DesyncFeature : public FeatureWrapper<DesyncFeature>
+{
+public:
+	bool StartRecording(const std::string& fileName, bool entities);
+	void StopRecording();
+	bool IsRecording() const
+	{
+		return recording;
+	}
+	void Compare(const std::string& fileA, const std::string& fileB);
+
+protected:
+	virtual bool ShouldLoadFeature() override;
+	virtual void LoadFeature() override;
+	virtual void UnloadFeature() override;
+
+private:
+	void OnTick();
+	uint64_t HashEntities();
+
+	desync::StreamWriter writer;
+	bool recording = false;
+	bool recordEntities = false;
+	int entityOriginOffset = utils::INVALID_DATAMAP_OFFSET;
+};
+
+static DesyncFeature spt_desync;
+
+ConVar spt_desync_record_ents("spt_desync_record_ents",
+                              "0",
+                              0,
+                              "Includes the position of every entity in desync recordings. Costs more per tick.");
+
+static std::string GetStreamPath(const char* name)
+{
+	std::string path = GetGameDir() + "\\" + name;
+	if (path.find(desync::STREAM_EXT, path.length() - strlen(desync::STREAM_EXT)) == std::string::npos)
+		path += desync::STREAM_EXT;
+
+	return path;
+}
+
+CON_COMMAND(spt_desync_record,
+            "Records a hash of the player state, the prediction seed and optionally all entity positions every tick. "
+            "Usage: spt_desync_record <file>")
+{
+	if (args.ArgC() != 2)
+	{
+		Msg("Usage: spt_desync_record <file>\n");
+		return;
+	}
+
+	std::string path = GetStreamPath(args.Arg(1));
+	if (spt_desync.StartRecording(path, spt_desync_record_ents.GetBool()))
+		Msg("Recording desync stream to %s\n", path.c_str());
+	else
+		Warning("Unable to open %s for writing.\n", path.c_str());
+}
+
+CON_COMMAND(spt_desync_stop, "Stops the desync recording.")
+{
+	if (!spt_desync.IsRecording())
+	{
+		Msg("Not recording a desync stream.\n");
+		return;
+	}
+
+	spt_desync.StopRecording();
+}
+
+CON_COMMAND(spt_desync_compare,
+            "Finds the first tick where two desync recordings differ. Usage: spt_desync_compare <file> <file>")
+{
+	if (args.ArgC() != 3)
+	{
+		Msg("Usage: spt_desync_compare <file> <file>\n");
+		return;
+	}
+
+	spt_desync.Compare(GetStreamPath(args.Arg(1)), GetStreamPath(args.Arg(2)));
+}
+
+bool DesyncFeature::StartRecording(const std::string& fileName, bool entities)
+{
+	StopRecording();
+
+	if (entities && entityOriginOffset == utils::INVALID_DATAMAP_OFFSET)
+		entityOriginOffset = spt_entprops.GetFieldOffset("CBaseEntity", "m_vecAbsOrigin", true);
+	if (entities && entityOriginOffset == utils::INVALID_DATAMAP_OFFSET)
+	{
+		// Every entity hash would be 0, and the recording would claim to include them
+		Warning("Unable to find the entity origins, recording without entities.\n");
+		entities = false;
+	}
+
+	if (!writer.Open(fileName, entities ? desync::FLAG_ENTITIES : 0))
+		return false;
+
+	recordEntities = entities;
+	recording = true;
+	return true;
+}
+
+void DesyncFeature::StopRecording()
+{
+	if (!recording)
+		return;
+
+	writer.Close();
+	recording = false;
+	Msg("Stopped desync recording after %d ticks.\n", writer.GetTicks());
+}
+
+uint64_t DesyncFeature::HashEntities()
+{
+	if (!interfaces::engine_server || entityOriginOffset == utils::INVALID_DATAMAP_OFFSET)
+		return 0;
+
+#if defined(OE)
+	int count = MAX_EDICTS;
+#else
+	int count = interfaces::engine_server->GetEntityCount();
+#endif
+
+	uint64_t hash = utils::FNV1A_64_OFFSET;
+	for (int i = 0; i < count; ++i)
+	{
+		edict_t* ed = interfaces::engine_server->PEntityOfEntIndex(i);
+		if (!ed || !ed->GetUnknown())
+			continue;
+
+		uintptr_t ent = reinterpret_cast<uintptr_t>(ed->GetUnknown());
+		auto origin = reinterpret_cast<const Vector*>(ent + entityOriginOffset);
+		hash = desync::HashEntity(hash, i, origin->Base());
+	}
+
+	return hash;
+}
+
+void DesyncFeature::OnTick()
+{
+	if (!recording)
+		return;
+
+	Vector origin = spt_playerio.m_vecAbsOrigin.GetValue();
+	Vector velocity = spt_playerio.GetPlayerVelocity();
+	desync::PlayerState playerState;
+	memcpy(playerState.origin, origin.Base(), sizeof(playerState.origin));
+	memcpy(playerState.velocity, velocity.Base(), sizeof(playerState.velocity));
+	EngineGetViewAngles(playerState.angles);
+
+	uint64_t entityHash = recordEntities ? HashEntities() : 0;
+	writer.AddTick(spt_rng.GetPredictionRandomSeed(0), desync::HashPlayer(playerState), entityHash);
+}
+
+void DesyncFeature::Compare(const std::string& fileA, const std::string& fileB)
+{
+	desync::StreamReader a, b;
+	if (!a.Open(fileA))
+	{
+		Warning("%s is not a desync recording.\n", fileA.c_str());
+		return;
+	}
+	if (!b.Open(fileB))
+	{
+		Warning("%s is not a desync recording.\n", fileB.c_str());
+		return;
+	}
+	if (a.header.flags != b.header.flags)
+	{
+		Warning("Only one of the recordings includes entities, their hashes can't match.\n");
+		return;
+	}
+
+	size_t first;
+	if (!desync::FindFirstDifference(a, b, first))
+	{
+		Warning("Error reading the recordings.\n");
+		return;
+	}
+
+	if (first == std::min(a.count, b.count))
+	{
+		if (a.count == b.count)
+			Msg("Recordings are identical, %u ticks.\n", (unsigned)a.count);
+		else
+			Msg("Recordings are identical for %u ticks, then one ends (%u and %u ticks).\n",
+			    (unsigned)first,
+			    (unsigned)a.count,
+			    (unsigned)b.count);
+		return;
+	}
+
+	desync::StreamRecord recordA, recordB;
+	a.Read(first, recordA);
+	b.Read(first, recordB);
+	Msg("First difference at tick %d:\n", recordA.tick);
+	if (recordA.playerHash != recordB.playerHash)
+		Msg("\tplayer origin, velocity or angles differ\n");
+	if (recordA.seed != recordB.seed)
+		Msg("\tprediction seed differs: %d and %d\n", recordA.seed, recordB.seed);
+	if (recordA.entityHash != recordB.entityHash)
+		Msg("\tentity positions differ\n");
+}
+
+bool DesyncFeature::ShouldLoadFeature()
+{
+	return true;
+}
+
+void DesyncFeature::LoadFeature()
+{
+	InitCommand(spt_desync_compare);
+	if (TickSignal.Works && spt_playerio.m_vecAbsOrigin.Found())
+	{
+		TickSignal.Connect(this, &DesyncFeature::OnTick);
+		InitCommand(spt_desync_record);
+		InitCommand(spt_desync_stop);
+		InitConcommandBase(spt_desync_record_ents);
+	}
+}
+
+void DesyncFeature::UnloadFeature()
+{
+	StopRecording();
+}
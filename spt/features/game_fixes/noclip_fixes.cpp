@@ -73,7 +73,7 @@ bool NoclipFixesFeature::ShouldLoadFeature()
 
 void NoclipFixesFeature::InitHooks()
 {
-	FIND_PATTERN(server, Server__NoclipString);
+	FIND_PATTERN_IN(server, Server__NoclipString, RData);
 	FIND_PATTERN_ALL(server, Server__StringReferences);
 }
 
@@ -0,0 +1,231 @@
+#include "stdafx.hpp"
+#include "..\feature.hpp"
+#include "convar.hpp"
+#include "file.hpp"
+#include "thirdparty\json.hpp"
+
+#include <algorithm>
+#include <fstream>
+
+// Prints how every pattern hook got resolved
+class HookReportFeature : public FeatureWrapper<HookReportFeature>
+{
+protected:
+	virtual bool ShouldLoadFeature() override
+	{
+		return true;
+	}
+
+	virtual void LoadFeature() override;
+};
+
+static HookReportFeature spt_hook_report_feature;
+
+static const ScanPassReport* FindPass(const std::vector<ScanPassReport>& passes,
+                                      const std::string& moduleName,
+                                      int id)
+{
+	for (auto& pass : passes)
+	{
+		if (pass.moduleName == moduleName && pass.id == id)
+			return &pass;
+	}
+	return nullptr;
+}
+
+// The time of the passes a pattern was scanned in, they're shared with the other patterns of the pass
+static double GetPassMilliseconds(const std::vector<ScanPassReport>& passes, const HookReport& report)
+{
+	double milliseconds = 0;
+	for (int id : report.scanPasses)
+	{
+		auto pass = FindPass(passes, report.moduleName, id);
+		if (pass)
+			milliseconds += pass->milliseconds;
+	}
+	return milliseconds;
+}
+
+static std::string GetPassList(const HookReport& report)
+{
+	if (report.scanPasses.empty())
+		return "-";
+
+	std::string list;
+	for (int id : report.scanPasses)
+	{
+		if (!list.empty())
+			list += ',';
+		list += std::to_string(id);
+	}
+	return list;
+}
+
+static bool SortReports(std::vector<HookReport>& reports,
+                        const std::vector<ScanPassReport>& passes,
+                        const char* sortBy)
+{
+	if (!strcmp(sortBy, "time"))
+	{
+		std::stable_sort(reports.begin(),
+		                 reports.end(),
+		                 [&](const HookReport& a, const HookReport& b)
+		                 { return GetPassMilliseconds(passes, a) > GetPassMilliseconds(passes, b); });
+	}
+	else if (!strcmp(sortBy, "name"))
+	{
+		std::stable_sort(reports.begin(),
+		                 reports.end(),
+		                 [](const HookReport& a, const HookReport& b)
+		                 { return a.patternName < b.patternName; });
+	}
+	else if (!strcmp(sortBy, "module"))
+	{
+		std::stable_sort(reports.begin(),
+		                 reports.end(),
+		                 [](const HookReport& a, const HookReport& b)
+		                 {
+			                 if (a.moduleName != b.moduleName)
+				                 return a.moduleName < b.moduleName;
+			                 return a.patternName < b.patternName;
+		                 });
+	}
+	else
+	{
+		return false;
+	}
+
+	return true;
+}
+
+static bool WriteReport(const std::vector<HookReport>& reports,
+                        const std::vector<ScanPassReport>& passes,
+                        const std::string& path)
+{
+	nlohmann::json root;
+	root["passes"] = nlohmann::json::array();
+	root["patterns"] = nlohmann::json::array();
+
+	for (auto& pass : passes)
+	{
+		nlohmann::json entry;
+		entry["module"] = pass.moduleName;
+		entry["id"] = pass.id;
+		entry["section"] = utils::GetSectionClassName(pass.section);
+		entry["fallback"] = pass.fallback;
+		entry["patterns"] = pass.patternCount;
+		entry["milliseconds"] = pass.milliseconds;
+		entry["bytesScanned"] = pass.bytesScanned;
+		root["passes"].push_back(entry);
+	}
+
+	for (auto& report : reports)
+	{
+		nlohmann::json entry;
+		entry["module"] = report.moduleName;
+		entry["pattern"] = report.patternName;
+		entry["alternative"] = report.alternativeName;
+		entry["alternativeIndex"] = report.patternIndex;
+		entry["matches"] = report.matchCount;
+		entry["lookupMilliseconds"] = report.lookupMilliseconds;
+		entry["passes"] = report.scanPasses;
+		entry["matchAll"] = report.matchAll;
+		entry["fromCache"] = report.fromCache;
+		entry["detoured"] = report.detoured;
+		root["patterns"].push_back(entry);
+	}
+
+	std::ofstream os(path);
+	if (!os)
+		return false;
+
+	os << root.dump(4);
+	return os.good();
+}
+
+CON_COMMAND(spt_hook_report,
+            "Prints how each pattern got resolved and how long the scans took, and writes the report as JSON. "
+            "Usage: spt_hook_report [time/name/module] [file]")
+{
+	const char* sortBy = args.ArgC() > 1 ? args.Arg(1) : "time";
+	auto reports = Feature::GetHookReports();
+	auto passes = Feature::GetScanPassReports();
+
+	if (!SortReports(reports, passes, sortBy))
+	{
+		Msg("Usage: spt_hook_report [time/name/module] [file]\n");
+		return;
+	}
+
+	// Patterns are matched together in one walk over the memory, so the time is only known per pass
+	double totalMilliseconds = 0;
+	Msg("%-20s %4s %-8s %8s %10s %10s\n", "module", "pass", "section", "patterns", "ms", "KB");
+	for (auto& pass : passes)
+	{
+		std::string section = utils::GetSectionClassName(pass.section);
+		if (pass.fallback)
+			section += "*";
+
+		Msg("%-20s %4d %-8s %8u %10.3f %10u\n",
+		    pass.moduleName.c_str(),
+		    pass.id,
+		    section.c_str(),
+		    static_cast<unsigned>(pass.patternCount),
+		    pass.milliseconds,
+		    static_cast<unsigned>(pass.bytesScanned / 1024));
+		totalMilliseconds += pass.milliseconds;
+	}
+	Msg("* the whole module, for patterns that weren't in their sections\n\n");
+
+	double lookupMilliseconds = 0;
+	size_t found = 0, cached = 0, detoured = 0;
+
+	Msg("%-8s %10s %5s %6s %8s %-20s %-40s %s\n",
+	    "passes",
+	    "lookup ms",
+	    "hits",
+	    "cached",
+	    "detoured",
+	    "module",
+	    "pattern",
+	    "alternative");
+
+	for (auto& report : reports)
+	{
+		Msg("%-8s %10.3f %5u %6s %8s %-20s %-40s %s\n",
+		    GetPassList(report).c_str(),
+		    report.lookupMilliseconds,
+		    static_cast<unsigned>(report.matchCount),
+		    report.fromCache ? "yes" : "no",
+		    report.detoured ? "yes" : "no",
+		    report.moduleName.c_str(),
+		    report.patternName.c_str(),
+		    report.matchCount > 0 ? report.alternativeName.c_str() : "NOT FOUND");
+
+		lookupMilliseconds += report.lookupMilliseconds;
+		found += report.matchCount > 0 ? 1 : 0;
+		cached += report.fromCache ? 1 : 0;
+		detoured += report.detoured ? 1 : 0;
+	}
+
+	Msg("%u patterns, %u found, %u from the signature cache, %u detoured\n",
+	    static_cast<unsigned>(reports.size()),
+	    static_cast<unsigned>(found),
+	    static_cast<unsigned>(cached),
+	    static_cast<unsigned>(detoured));
+	Msg("%u scan passes took %.3f ms, cache lookups %.3f ms\n",
+	    static_cast<unsigned>(passes.size()),
+	    totalMilliseconds,
+	    lookupMilliseconds);
+
+	std::string path = args.ArgC() > 2 ? args.Arg(2) : GetGameDir() + "\\spt-hook-report.json";
+	if (WriteReport(reports, passes, path))
+		Msg("Wrote the report to %s\n", path.c_str());
+	else
+		Warning("Could not write the report to %s\n", path.c_str());
+}
+
+void HookReportFeature::LoadFeature()
+{
+	InitCommand(spt_hook_report);
+}
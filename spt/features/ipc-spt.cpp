@@ -78,6 +78,62 @@ namespace ipc
 		}
 	}
 
+	const char* GetResultName(scripts::SearchResult result)
+	{
+		switch (result)
+		{
+		case scripts::SearchResult::Success:
+			return "success";
+		case scripts::SearchResult::Fail:
+			return "fail";
+		default:
+			return "stop";
+		}
+	}
+
+	// Runs one candidate of a search coordinated by another instance
+	void SearchJobCallback(const nlohmann::json& msg)
+	{
+		if (msg.find("id") == msg.end() || msg.find("script") == msg.end()
+		    || msg.find("variables") == msg.end())
+		{
+			Msg("Search job is missing the id, script or variables field!\n");
+			return;
+		}
+
+		int id;
+		std::string script;
+		std::map<std::string, std::string> assignment;
+
+		try
+		{
+			id = msg["id"];
+			script = msg["script"];
+			for (auto& item : msg["variables"].items())
+			{
+				auto& value = item.value();
+				assignment[item.key()] = value.is_string() ? value.get<std::string>() : value.dump();
+			}
+		}
+		catch (const std::exception& ex)
+		{
+			Msg("Bad search job: %s\n", ex.what());
+			return;
+		}
+
+		scripts::g_TASReader.RunSearchJob(script,
+		                                  assignment,
+		                                  [id](scripts::SearchResult result, int tick)
+		                                  {
+			                                  nlohmann::json resultMsg;
+			                                  resultMsg["type"] = "search_result";
+			                                  resultMsg["id"] = id;
+			                                  resultMsg["result"] = GetResultName(result);
+			                                  resultMsg["tick"] = tick;
+			                                  ipc::Send(resultMsg);
+		                                  });
+	}
+
 	void MsgWrapper(const char* msg)
 	{
 		Msg(msg);
@@ -91,6 +147,7 @@ namespace ipc
 			StartIPC();
 		}
 		server.AddCallback("cmd", CmdCallback, false);
+		server.AddCallback("search_job", SearchJobCallback, false);
 	}
 
 	bool IsActive()
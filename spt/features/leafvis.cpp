@@ -18,6 +18,12 @@ class LeafVisFeature : public FeatureWrapper<LeafVisFeature>
 {
 public:
 protected:
+	virtual bool IsLazy() override
+	{
+		return true;
+	}
+
+	virtual void InitLazyTriggers() override;
 	virtual void InitHooks() override;
 	virtual void LoadFeature() override;
 
@@ -27,6 +33,11 @@ private:
 };
 static LeafVisFeature spt_leafvis;
 
+void LeafVisFeature::InitLazyTriggers()
+{
+	InitLazyTrigger(y_spt_leafvis_index);
+}
+
 void LeafVisFeature::InitHooks()
 {
 	HOOK_FUNCTION(engine, MiddleOfLeafVisBuild);
@@ -0,0 +1,81 @@
+#include "stdafx.hpp"
+#include "..\feature.hpp"
+#include "convar.hpp"
+#include "pattern_validation.hpp"
+
+#include <algorithm>
+#include <set>
+
+// Checks the loaded pattern tables against dumped binaries of other game builds. The validate_patterns host tool
+// in spt/utils/host checks every table in the sources the same way without the game.
+class PatternValidatorFeature : public FeatureWrapper<PatternValidatorFeature>
+{
+protected:
+	virtual bool ShouldLoadFeature() override
+	{
+		return true;
+	}
+
+	virtual void LoadFeature() override;
+};
+
+static PatternValidatorFeature spt_pattern_validator;
+
+CON_COMMAND(spt_validate_patterns,
+            "Scans dumped binaries of other builds for every loaded pattern and prints a pattern x build matrix. "
+            "Usage: spt_validate_patterns <directory>, where every subdirectory is a build containing "
+            "<module>.dll files")
+{
+	if (args.ArgC() < 2)
+	{
+		Msg("Usage: spt_validate_patterns <directory>\n");
+		return;
+	}
+
+	// One row per pattern table, the same table can be registered by several features
+	std::vector<utils::ValidatedPattern> patternRows;
+	std::set<std::pair<std::string, std::string>> seen;
+	for (auto& report : Feature::GetHookReports())
+	{
+		if (!report.patternArr || !seen.emplace(report.moduleName, report.patternName).second)
+			continue;
+
+		patternRows.push_back(utils::ValidatedPattern{report.moduleName,
+		                                              report.patternName,
+		                                              report.patternArr,
+		                                              report.patternCount,
+		                                              report.section,
+		                                              report.matchAll});
+	}
+	std::sort(patternRows.begin(),
+	          patternRows.end(),
+	          [](const utils::ValidatedPattern& a, const utils::ValidatedPattern& b)
+	          {
+		          if (a.moduleName != b.moduleName)
+			          return a.moduleName < b.moduleName;
+		          return a.patternName < b.patternName;
+	          });
+
+	utils::PatternMatrix matrix;
+	if (!matrix.Build(args.Arg(1), patternRows))
+	{
+		Warning("%s is not a directory\n", args.Arg(1));
+		return;
+	}
+
+	if (patternRows.empty() || matrix.GetBuilds().empty())
+	{
+		Msg("Nothing to validate: %u patterns loaded, %u builds found\n",
+		    static_cast<unsigned>(patternRows.size()),
+		    static_cast<unsigned>(matrix.GetBuilds().size()));
+		return;
+	}
+
+	for (auto& line : matrix.Format())
+		Msg("%s\n", line.c_str());
+}
+
+void PatternValidatorFeature::LoadFeature()
+{
+	InitCommand(spt_validate_patterns);
+}
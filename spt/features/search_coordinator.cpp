@@ -0,0 +1,511 @@
+#include "stdafx.hpp"
+#include "..\feature.hpp"
+#include "convar.hpp"
+#include "signals.hpp"
+#include "..\ipc\ipc.hpp"
+#include "..\scripts\parallel_binary_search.hpp"
+#include "..\scripts\srctas_reader.hpp"
+
+#include <algorithm>
+#include <deque>
+#include <memory>
+
+using scripts::SearchResult;
+using scripts::SearchType;
+
+/*
+* Runs a tas_script_search over several game instances. This instance owns the search state and hands candidate
+* variable values to workers over IPC, every worker has spt_ipc enabled on its own port and plays back the script
+* with the values it was given.
+*
+* Binary searches test one point per worker per round and narrow the range to the results, so every round cuts
+* the range into workers + 1 pieces. Random searches keep every worker busy with its own random candidate.
+*/
+class SearchCoordinatorFeature : public FeatureWrapper<SearchCoordinatorFeature>
+{
+public:
+	bool Start(const std::string& script, const std::vector<std::string>& ports);
+	void Stop();
+	// Stops and prints the best result
+	void Finish();
+	void PrintStatus();
+	bool IsRunning() const
+	{
+		return running;
+	}
+
+protected:
+	virtual bool ShouldLoadFeature() override
+	{
+		return true;
+	}
+
+	virtual void LoadFeature() override;
+	virtual void UnloadFeature() override;
+
+private:
+	// Index of every searched variable
+	typedef std::map<std::string, int> Candidate;
+
+	struct Worker
+	{
+		std::string port;
+		std::unique_ptr<ipc::IPCClient> client;
+		int jobId = -1;
+		Candidate candidate;
+	};
+
+	struct CandidateResult
+	{
+		Candidate candidate;
+		SearchResult result;
+		int tick;
+	};
+
+	void OnFrame();
+	void ReadResults(Worker& worker);
+	void HandleResult(Worker& worker, const nlohmann::json& msg);
+	void Schedule();
+	bool StartRound();
+	void FinishRound();
+	Candidate RandomCandidate();
+	void SendJob(Worker& worker, Candidate candidate);
+	void UpdateBest(const CandidateResult& result);
+	std::string FormatCandidate(const Candidate& candidate);
+
+	bool running = false;
+	std::string scriptName;
+	SearchType searchType;
+	scripts::VariableContainer variables;
+	std::vector<Worker> workers;
+	std::deque<Candidate> pending;
+	std::vector<CandidateResult> roundResults;
+	int nextJobId = 0;
+	int rounds = 0;
+	int jobsDone = 0;
+
+	// Binary searches only have one searched variable
+	std::string binaryVariable;
+	scripts::ParallelBinarySearch binarySearch;
+
+	bool hasBest = false;
+	CandidateResult best;
+};
+
+static SearchCoordinatorFeature spt_search_coordinator;
+
+static bool IsBinarySearch(SearchType type)
+{
+	return type == SearchType::Lowest || type == SearchType::Highest;
+}
+
+static SearchResult ParseResult(const std::string& result)
+{
+	if (result == "success")
+		return SearchResult::Success;
+	else if (result == "fail")
+		return SearchResult::Fail;
+	else
+		return SearchResult::NoSearch;
+}
+
+bool SearchCoordinatorFeature::Start(const std::string& script, const std::vector<std::string>& ports)
+{
+	Stop();
+
+	if (!scripts::g_TASReader.LoadSearchVariables(script, variables, searchType))
+		return false;
+
+	if (searchType == SearchType::None)
+	{
+		Msg("Script has no search property.\n");
+		return false;
+	}
+	else if (scripts::IsStrategySearch(searchType))
+	{
+		Msg("Coordinated searches don't support coordinate, golden or lhs searches yet.\n");
+		return false;
+	}
+
+	binaryVariable.clear();
+	int searched = 0;
+	for (auto& pair : variables.variableMap)
+	{
+		if (pair.second.IsSearched())
+		{
+			binaryVariable = pair.first;
+			++searched;
+		}
+	}
+
+	if (searched == 0)
+	{
+		Msg("Script has no range variables to search.\n");
+		return false;
+	}
+	else if (searched > 1 && IsBinarySearch(searchType))
+	{
+		// Same as tas_script_search, only random searches change several variables
+		Msg("Binary search only accepts one range variable.\n");
+		return false;
+	}
+
+	for (auto& port : ports)
+	{
+		Worker worker;
+		worker.port = port;
+		worker.client = std::make_unique<ipc::IPCClient>();
+		if (worker.client->Connect(port.c_str()))
+			workers.push_back(std::move(worker));
+		else
+			Warning("Unable to connect to a worker on port %s\n", port.c_str());
+	}
+
+	if (workers.empty())
+	{
+		Msg("No workers connected.\n");
+		return false;
+	}
+
+	auto& variable = variables.variableMap[binaryVariable];
+	binarySearch.Start(variable.GetLowIndex(), variable.GetHighIndex(), searchType == SearchType::Lowest);
+
+	scriptName = script;
+	pending.clear();
+	roundResults.clear();
+	hasBest = false;
+	rounds = 0;
+	jobsDone = 0;
+	running = true;
+
+	Msg("Started a search of %s with %u workers\n", script.c_str(), static_cast<unsigned>(workers.size()));
+	Schedule();
+	return true;
+}
+
+void SearchCoordinatorFeature::Stop()
+{
+	for (auto& worker : workers)
+		worker.client->Close();
+
+	workers.clear();
+	pending.clear();
+	roundResults.clear();
+	running = false;
+}
+
+void SearchCoordinatorFeature::PrintStatus()
+{
+	if (!running)
+	{
+		Msg("No coordinated search is running.\n");
+		return;
+	}
+
+	int busy = 0;
+	for (auto& worker : workers)
+		busy += worker.jobId != -1 ? 1 : 0;
+
+	Msg("Searching %s: %d candidates tested, %d rounds, %d/%u workers busy\n",
+	    scriptName.c_str(),
+	    jobsDone,
+	    rounds,
+	    busy,
+	    static_cast<unsigned>(workers.size()));
+	if (hasBest)
+		Msg("Best so far:\n%s\t- tick: %d\n", FormatCandidate(best.candidate).c_str(), best.tick);
+}
+
+void SearchCoordinatorFeature::OnFrame()
+{
+	if (!running)
+		return;
+
+	// A result can finish the search, which removes the workers
+	for (size_t i = 0; running && i < workers.size(); ++i)
+		ReadResults(workers[i]);
+
+	if (!running)
+		return;
+
+	// Candidates of workers that went away are tested by the others
+	for (auto it = workers.begin(); it != workers.end();)
+	{
+		if (it->client->Connected())
+		{
+			++it;
+			continue;
+		}
+
+		Warning("Lost the worker on port %s\n", it->port.c_str());
+		if (it->jobId != -1)
+			pending.push_front(it->candidate);
+		it = workers.erase(it);
+	}
+
+	if (workers.empty())
+	{
+		Msg("All workers disconnected, stopping the search.\n");
+		Finish();
+		return;
+	}
+
+	Schedule();
+}
+
+void SearchCoordinatorFeature::ReadResults(Worker& worker)
+{
+	std::vector<nlohmann::json> messages;
+	worker.client->ReadMessages(messages);
+
+	for (auto& msg : messages)
+	{
+		if (!running)
+			return;
+
+		// Workers also send acks and whatever else their other IPC clients asked for
+		auto type = msg.find("type");
+		if (type != msg.end() && type->is_string() && *type == "search_result")
+			HandleResult(worker, msg);
+	}
+}
+
+void SearchCoordinatorFeature::HandleResult(Worker& worker, const nlohmann::json& msg)
+{
+	CandidateResult result;
+
+	try
+	{
+		if (msg["id"].get<int>() != worker.jobId)
+			return;
+
+		result.result = ParseResult(msg["result"].get<std::string>());
+		result.tick = msg["tick"].get<int>();
+	}
+	catch (const std::exception& ex)
+	{
+		Warning("Bad search result from port %s: %s\n", worker.port.c_str(), ex.what());
+		return;
+	}
+
+	result.candidate = std::move(worker.candidate);
+	worker.jobId = -1;
+	++jobsDone;
+
+	if (result.result == SearchResult::NoSearch)
+	{
+		Msg("Worker on port %s stopped the search.\n", worker.port.c_str());
+		Finish();
+		return;
+	}
+
+	if (IsBinarySearch(searchType))
+	{
+		roundResults.push_back(std::move(result));
+		return;
+	}
+
+	if (result.result == SearchResult::Success)
+	{
+		UpdateBest(result);
+		if (searchType == SearchType::Random)
+			Finish();
+	}
+}
+
+void SearchCoordinatorFeature::Schedule()
+{
+	if (IsBinarySearch(searchType))
+	{
+		bool busy = std::any_of(workers.begin(), workers.end(), [](const Worker& w) { return w.jobId != -1; });
+		if (pending.empty() && !busy)
+		{
+			FinishRound();
+			if (!StartRound())
+			{
+				Finish();
+				return;
+			}
+		}
+	}
+
+	for (auto& worker : workers)
+	{
+		if (worker.jobId != -1)
+			continue;
+
+		if (!pending.empty())
+		{
+			SendJob(worker, std::move(pending.front()));
+			pending.pop_front();
+		}
+		else if (!IsBinarySearch(searchType))
+		{
+			SendJob(worker, RandomCandidate());
+		}
+	}
+}
+
+bool SearchCoordinatorFeature::StartRound()
+{
+	for (int index : binarySearch.StartRound(static_cast<int>(workers.size())))
+	{
+		Candidate candidate;
+		candidate[binaryVariable] = index;
+		pending.push_back(std::move(candidate));
+	}
+
+	if (pending.empty())
+		return false;
+
+	rounds = binarySearch.GetRounds();
+	return true;
+}
+
+void SearchCoordinatorFeature::FinishRound()
+{
+	if (roundResults.empty())
+		return;
+
+	std::vector<std::pair<int, SearchResult>> results;
+	for (auto& result : roundResults)
+		results.emplace_back(result.candidate.at(binaryVariable), result.result);
+
+	int bestIndex;
+	if (binarySearch.FinishRound(results, bestIndex))
+	{
+		for (auto& result : roundResults)
+		{
+			if (result.result == SearchResult::Success && result.candidate.at(binaryVariable) == bestIndex)
+			{
+				UpdateBest(result);
+				break;
+			}
+		}
+	}
+
+	auto& variable = variables.variableMap[binaryVariable];
+	variable.SetBounds(binarySearch.GetLowIndex(), binarySearch.GetHighIndex());
+	roundResults.clear();
+}
+
+SearchCoordinatorFeature::Candidate SearchCoordinatorFeature::RandomCandidate()
+{
+	Candidate candidate;
+	for (auto& pair : variables.variableMap)
+	{
+		if (pair.second.IsSearched())
+			candidate[pair.first] = pair.second.GetRandomIndex();
+	}
+
+	return candidate;
+}
+
+void SearchCoordinatorFeature::SendJob(Worker& worker, Candidate candidate)
+{
+	nlohmann::json msg;
+	msg["type"] = "search_job";
+	msg["id"] = nextJobId;
+	msg["script"] = scriptName;
+	msg["variables"] = nlohmann::json::object();
+	for (auto& pair : candidate)
+		msg["variables"][pair.first] = variables.variableMap[pair.first].GetValueAt(pair.second);
+
+	if (!worker.client->SendMsg(msg))
+	{
+		// Picked up by the disconnect handling on the next frame
+		pending.push_front(std::move(candidate));
+		return;
+	}
+
+	worker.jobId = nextJobId++;
+	worker.candidate = std::move(candidate);
+}
+
+void SearchCoordinatorFeature::UpdateBest(const CandidateResult& result)
+{
+	bool better = !hasBest || searchType == SearchType::Lowest || searchType == SearchType::Highest
+	              || searchType == SearchType::Random
+	              || (searchType == SearchType::RandomLowest && result.tick < best.tick)
+	              || (searchType == SearchType::RandomHighest && result.tick > best.tick);
+
+	if (!better)
+		return;
+
+	best = result;
+	hasBest = true;
+	Msg("New best result:\n%s\t- tick: %d\n", FormatCandidate(best.candidate).c_str(), best.tick);
+}
+
+std::string SearchCoordinatorFeature::FormatCandidate(const Candidate& candidate)
+{
+	std::string print;
+	for (auto& pair : candidate)
+	{
+		auto value = variables.variableMap[pair.first].GetValueAt(pair.second);
+		print += "\t - " + pair.first + " : " + value + "\n";
+	}
+
+	return print;
+}
+
+void SearchCoordinatorFeature::Finish()
+{
+	Msg("Search done after %d candidates.\n", jobsDone);
+	if (hasBest)
+		Msg("Best result was with:\n%s\t- tick: %d\n", FormatCandidate(best.candidate).c_str(), best.tick);
+	else
+		Msg("No results found.\n");
+
+	Stop();
+}
+
+CON_COMMAND_AUTOCOMPLETEFILE(tas_script_search_coordinator,
+                             "Runs a variable search for an .srctas script on other game instances. Usage: "
+                             "tas_script_search_coordinator <script> <port> [port...], every port is a worker "
+                             "with spt_ipc enabled",
+                             0,
+                             "",
+                             ".srctas")
+{
+	if (args.ArgC() < 3)
+	{
+		Msg("Usage: tas_script_search_coordinator <script> <port> [port...]\n");
+		return;
+	}
+
+	std::vector<std::string> ports;
+	for (int i = 2; i < args.ArgC(); ++i)
+		ports.push_back(args.Arg(i));
+
+	spt_search_coordinator.Start(args.Arg(1), ports);
+}
+
+CON_COMMAND(tas_script_search_coordinator_stop, "Stops the coordinated search and prints the best result.")
+{
+	if (spt_search_coordinator.IsRunning())
+		spt_search_coordinator.Finish();
+	else
+		Msg("No coordinated search is running.\n");
+}
+
+CON_COMMAND(tas_script_search_coordinator_status, "Prints the state of the coordinated search.")
+{
+	spt_search_coordinator.PrintStatus();
+}
+
+void SearchCoordinatorFeature::LoadFeature()
+{
+	if (!FrameSignal.Works)
+		return;
+
+	FrameSignal.Connect(this, &SearchCoordinatorFeature::OnFrame);
+	InitCommand(tas_script_search_coordinator);
+	InitCommand(tas_script_search_coordinator_stop);
+	InitCommand(tas_script_search_coordinator_status);
+}
+
+void SearchCoordinatorFeature::UnloadFeature()
+{
+	Stop();
+}
@@ -3,6 +3,7 @@
 #include "convar.hpp"
 #include "..\sptlib-wrapper.hpp"
 #include "..\strafe\strafestuff.hpp"
+#include "..\strafe\strafe_lookahead.hpp"
 #include "..\scripts\srctas_reader.hpp"
 #include "aim.hpp"
 #include "generic.hpp"
@@ -18,7 +19,7 @@ ConVar tas_strafe_type(
     "tas_strafe_type",
     "0",
     FCVAR_TAS_RESET,
-    "TAS strafe types:\n\t0 - Max acceleration strafing,\n\t1 - Max angle strafing.\n\t2 - Max accel strafing with a speed cap.\n\t3 - W strafing.\n");
+    "TAS strafe types:\n\t0 - Max acceleration strafing,\n\t1 - Max angle strafing.\n\t2 - Max accel strafing with a speed cap.\n\t3 - W strafing.\n\t4 - Look-ahead strafing, plans the yaws of the next ticks toward spt_tas_strafe_yaw.\n");
 ConVar tas_strafe_dir(
     "tas_strafe_dir",
     "3",
@@ -71,6 +72,52 @@ ConVar tas_strafe_hull_is_line(
     "0",
     FCVAR_TAS_RESET,
     "Treats the collision hull as a line for ground checks. A hack to fix ground detections while going through portals.");
+ConVar tas_strafe_lookahead_horizon("tas_strafe_lookahead_horizon",
+                                    "8",
+                                    FCVAR_TAS_RESET,
+                                    "How many ticks ahead look-ahead strafing (type 4) simulates.\n",
+                                    true,
+                                    1.0f,
+                                    false,
+                                    0.0f);
+ConVar tas_strafe_lookahead_beam("tas_strafe_lookahead_beam",
+                                 "16",
+                                 FCVAR_TAS_RESET,
+                                 "How many yaw sequences look-ahead strafing keeps after every simulated tick.\n",
+                                 true,
+                                 1.0f,
+                                 false,
+                                 0.0f);
+ConVar tas_strafe_lookahead_samples(
+    "tas_strafe_lookahead_samples",
+    "64",
+    FCVAR_TAS_RESET,
+    "How many yaws around the velocity look-ahead strafing tries for every sequence, on top of the max accel yaw.\n",
+    true,
+    0.0f,
+    false,
+    0.0f);
+ConVar tas_strafe_lookahead_budget(
+    "tas_strafe_lookahead_budget",
+    "2",
+    0,
+    "Milliseconds look-ahead strafing may spend per tick, it uses the best yaws found so far when it runs out. 0 "
+    "for no limit.\n",
+    true,
+    0.0f,
+    false,
+    0.0f);
+ConVar tas_strafe_lookahead_tracing(
+    "tas_strafe_lookahead_tracing",
+    "1",
+    FCVAR_TAS_RESET,
+    "If enabled, look-ahead strafing simulates collisions. Otherwise nothing is in the way and the ground state "
+    "doesn't change, which is a lot faster.\n");
+ConVar tas_strafe_trace_cache(
+    "tas_strafe_trace_cache",
+    "1",
+    0,
+    "Remembers the traces of TAS strafing and the player prediction until the tick changes or the player moves.\n");
 ConVar tas_strafe_use_tracing(
     "tas_strafe_use_tracing",
     "1",
@@ -137,12 +184,31 @@ ConVar tas_script_printvars("tas_script_printvars",
                             "Prints variable information when running .srctas scripts.\n");
 ConVar tas_script_savestates("tas_script_savestates", "1", 0, "Enables/disables savestates in .srctas scripts.\n");
 ConVar tas_script_onsuccess("tas_script_onsuccess", "", 0, "Commands to be executed when a search concludes.\n");
+ConVar tas_script_search_autosavestate(
+    "tas_script_search_autosavestate",
+    "1",
+    0,
+    "Automatically savestates before the first frame bulk that uses a searched variable, so search iterations "
+    "don't replay the unchanged start of the script.\n");
+ConVar tas_script_stream_window(
+    "tas_script_stream_window",
+    "512",
+    0,
+    "How many ticks ahead version 2 script commands are added to the afterframes queue. 0 adds the whole script "
+    "when it starts.\n");
 ConVar y_spt_hud_script_progress("y_spt_hud_script_progress", "0", FCVAR_CHEAT, "Turns on the script progress hud.\n");
+ConVar y_spt_hud_trace_cache("y_spt_hud_trace_cache",
+                             "0",
+                             FCVAR_CHEAT,
+                             "Turns on the trace cache hud, shows the hits and misses of the last tick.\n");
 
 extern ConVar tas_anglespeed;
 
 TASFeature spt_tas;
 
+static Strafe::LookaheadPlanner lookaheadPlanner;
+static bool lookaheadDirWarned = false;
+
 bool TASFeature::ShouldLoadFeature()
 {
 	return interfaces::engine != nullptr;
@@ -187,6 +253,36 @@ Strafe::StrafeInput GetStrafeInput(float forwardmove, float sidemove, float yaw)
 	return input;
 }
 
+static double PlanLookahead(const Strafe::PlayerData& player,
+                            const Strafe::MovementVars& vars,
+                            bool jumped,
+                            double targetYaw)
+{
+	Strafe::LookaheadSettings settings;
+	settings.Horizon = tas_strafe_lookahead_horizon.GetInt();
+	settings.BeamWidth = tas_strafe_lookahead_beam.GetInt();
+	settings.Samples = tas_strafe_lookahead_samples.GetInt();
+	settings.BudgetMs = tas_strafe_lookahead_budget.GetFloat();
+	settings.Autojump = spt_playerio.TryJump();
+	settings.Lgagst = tas_strafe_lgagst.GetBool();
+
+	auto config = Strafe::GetStrafeConfig();
+	if (tas_strafe_lookahead_tracing.GetBool())
+	{
+		auto traces = Strafe::GetGameTraceProvider(config);
+		// The planner traces from positions the player isn't at, keep them out of the per-tick stats
+		Strafe::g_TraceCache.SetCounting(false);
+		double yaw = lookaheadPlanner.Plan(player, vars, jumped, targetYaw, config, traces, settings);
+		Strafe::g_TraceCache.SetCounting(true);
+		return yaw;
+	}
+	else
+	{
+		Strafe::NoTraceProvider traces(vars.OnGround);
+		return lookaheadPlanner.Plan(player, vars, jumped, targetYaw, config, traces, settings);
+	}
+}
+
 void TASFeature::Strafe()
 {
 	float va[3];
@@ -240,6 +336,27 @@ void TASFeature::Strafe()
 			}
 		}
 
+		// Only plans toward a yaw
+		if (type == Strafe::StrafeType::LOOKAHEAD && dir != Strafe::StrafeDir::YAW)
+		{
+			if (!lookaheadDirWarned)
+			{
+				Warning("tas_strafe_type 4 only plans toward tas_strafe_yaw with tas_strafe_dir 3, "
+				        "using max accel strafing.\n");
+				lookaheadDirWarned = true;
+			}
+			type = Strafe::StrafeType::MAXACCEL;
+		}
+		else
+		{
+			lookaheadDirWarned = false;
+		}
+
+		if (type == Strafe::StrafeType::LOOKAHEAD)
+			input.TargetYaw = PlanLookahead(pl, vars, jumped, input.TargetYaw);
+		else
+			lookaheadPlanner.Reset();
+
 		Strafe::Friction(pl, vars.OnGround, vars);
 
 		if (input.Vectorial) // Can do vectorial strafing even with locked camera, provided we are not jumping
@@ -288,11 +405,35 @@ CON_COMMAND(tas_script_result_fail, "Signals an unsuccessful result in a variabl
 	scripts::g_TASReader.SearchResult(scripts::SearchResult::Fail);
 }
 
+CON_COMMAND(tas_script_result_score,
+            "Signals a successful result with a score in a variable search. Used by the coordinate, golden and lhs "
+            "searches, which look for the highest score (or lowest with objective min).")
+{
+	if (args.ArgC() != 2)
+	{
+		Msg("Usage: tas_script_result_score <score>\n");
+		return;
+	}
+
+	scripts::g_TASReader.SearchScore(std::atof(args.Arg(1)));
+}
+
 CON_COMMAND(tas_script_result_stop, "Signals a stop in a variable search.")
 {
 	scripts::g_TASReader.SearchResult(scripts::SearchResult::NoSearch);
 }
 
+CON_COMMAND(tas_strafe_trace_cache_stats, "Prints the hits and misses of the trace cache.")
+{
+	const auto& stats = Strafe::g_TraceCache.GetStats();
+	long long total = stats.hits + stats.misses;
+	Msg("Last tick: %d hits, %d misses\n", stats.lastTickHits, stats.lastTickMisses);
+	Msg("Total: %lld hits, %lld misses (%.1f%% hits)\n",
+	    stats.hits,
+	    stats.misses,
+	    total > 0 ? 100.0 * stats.hits / total : 0.0);
+}
+
 void TASFeature::LoadFeature()
 {
 	if (AfterFramesSignal.Works)
@@ -301,11 +442,14 @@ void TASFeature::LoadFeature()
 		InitCommand(tas_script_search);
 		InitCommand(tas_script_result_success);
 		InitCommand(tas_script_result_fail);
+		InitCommand(tas_script_result_score);
 		InitCommand(tas_script_result_stop);
 
 		InitConcommandBase(tas_script_printvars);
 		InitConcommandBase(tas_script_savestates);
 		InitConcommandBase(tas_script_onsuccess);
+		InitConcommandBase(tas_script_search_autosavestate);
+		InitConcommandBase(tas_script_stream_window);
 
 		AfterFramesSignal.Connect(&scripts::g_TASReader, &scripts::SourceTASReader::OnAfterFrames);
 #ifdef SPT_HUD_ENABLED
@@ -350,6 +494,11 @@ void TASFeature::LoadFeature()
 		InitConcommandBase(tas_strafe_lgagst_min);
 		InitConcommandBase(tas_strafe_lgagst_max);
 		InitConcommandBase(tas_strafe_jumptype);
+		InitConcommandBase(tas_strafe_lookahead_horizon);
+		InitConcommandBase(tas_strafe_lookahead_beam);
+		InitConcommandBase(tas_strafe_lookahead_samples);
+		InitConcommandBase(tas_strafe_lookahead_budget);
+		InitConcommandBase(tas_strafe_lookahead_tracing);
 
 		// Tracing related
 		if (spt_tracing.CanTracePlayerBBox())
@@ -362,5 +511,38 @@ void TASFeature::LoadFeature()
 		{
 			tas_strafe_use_tracing.SetValue(0);
 		}
+
+		// Without ticks the cache can't tell when the world changed
+		if (TickSignal.Works)
+		{
+			TickSignal.Connect(&Strafe::g_TraceCache, &Strafe::TraceCache::OnTick);
+			if (LevelShutdownSignal.Works)
+				LevelShutdownSignal.Connect(&Strafe::g_TraceCache, &Strafe::TraceCache::Clear);
+			Strafe::g_TraceCache.SetEnabled(true);
+			InitConcommandBase(tas_strafe_trace_cache);
+			InitCommand(tas_strafe_trace_cache_stats);
+#ifdef SPT_HUD_ENABLED
+			AddHudCallback(
+			    "trace_cache",
+			    [](std::string)
+			    {
+				    const auto& stats = Strafe::g_TraceCache.GetStats();
+				    spt_hud_feat.DrawTopHudElement(L"trace cache: %d hits, %d misses",
+				                                   stats.lastTickHits,
+				                                   stats.lastTickMisses);
+			    },
+			    y_spt_hud_trace_cache);
+#endif
+		}
+		else
+		{
+			tas_strafe_trace_cache.SetValue(0);
+		}
 	}
-}
\ No newline at end of file
+}
+
+void TASFeature::UnloadFeature()
+{
+	Strafe::g_TraceCache.SetEnabled(false);
+	Strafe::g_TraceCache.Clear();
+}
@@ -11,6 +11,7 @@ public:
 protected:
 	virtual bool ShouldLoadFeature() override;
 	virtual void LoadFeature() override;
+	virtual void UnloadFeature() override;
 };
 
 extern TASFeature spt_tas;
@@ -43,12 +43,30 @@ CON_COMMAND(tas_test_validate, "Validates a test.")
 	}
 }
 
-CON_COMMAND(tas_test_automated_validate, "Validates a test, produces a log file and exits the game.")
+CON_COMMAND(tas_test_automated_validate,
+            "Validates a test, produces a log file and exits the game. Usage: tas_test_automated_validate <test> "
+            "<log file> [shard] [shard count], with shards only every shard count-th test of a folder runs.")
 {
-	if (args.ArgC() > 2)
+	if (args.ArgC() == 3)
 	{
 		scripts::g_Tester.RunAutomatedTest(args.Arg(1), false, args.Arg(2));
 	}
+	else if (args.ArgC() == 5)
+	{
+		int shard = atoi(args.Arg(3));
+		int shardCount = atoi(args.Arg(4));
+		if (shardCount < 1 || shard < 0 || shard >= shardCount)
+		{
+			Msg("The shard has to be between 0 and the shard count - 1.\n");
+			return;
+		}
+
+		scripts::g_Tester.RunAutomatedTest(args.Arg(1), false, args.Arg(2), shard, shardCount);
+	}
+	else
+	{
+		Msg("Usage: tas_test_automated_validate <test> <log file> [shard] [shard count]\n");
+	}
 }
 
 void TestFeature::LoadFeature()
@@ -366,6 +366,152 @@ void ipc::IPCServer::DispatchMessages(const std::string& type)
 	vec.clear();
 }
 
+ipc::IPCClient::IPCClient()
+{
+	socket = INVALID_SOCKET;
+	winsockStarted = false;
+}
+
+bool ipc::IPCClient::Connect(const char* port)
+{
+	Close();
+
+	// WSAStartup is reference counted, the client doesn't depend on the server being enabled
+	WSADATA wsaData;
+	if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0)
+	{
+		Print("WSAStartup failed: %d\n", WSAGetLastError());
+		return false;
+	}
+	winsockStarted = true;
+
+	struct addrinfo *result = NULL, hints;
+
+	ZeroMemory(&hints, sizeof(hints));
+	hints.ai_family = AF_INET;
+	hints.ai_socktype = SOCK_STREAM;
+	hints.ai_protocol = IPPROTO_TCP;
+
+	int iResult = getaddrinfo("127.0.0.1", port, &hints, &result);
+	if (iResult != 0)
+	{
+		Print("getaddrinfo failed: %d\n", iResult);
+		Close();
+		return false;
+	}
+
+	socket = ::socket(result->ai_family, result->ai_socktype, result->ai_protocol);
+	if (socket == INVALID_SOCKET)
+	{
+		Print("Error at socket(): %ld\n", WSAGetLastError());
+		freeaddrinfo(result);
+		Close();
+		return false;
+	}
+
+	// Connecting to localhost is quick enough to block on
+	iResult = connect(socket, result->ai_addr, (int)result->ai_addrlen);
+	freeaddrinfo(result);
+	if (iResult == SOCKET_ERROR)
+	{
+		Print("Unable to connect to port %s: %d\n", port, WSAGetLastError());
+		Close();
+		return false;
+	}
+
+	ioctlsocket(socket, FIONBIO, &BLOCKING);
+	return true;
+}
+
+void ipc::IPCClient::Close()
+{
+	if (socket != INVALID_SOCKET)
+		CloseSocket(socket);
+	if (winsockStarted)
+		WSACleanup();
+
+	winsockStarted = false;
+	pending.clear();
+}
+
+bool ipc::IPCClient::Connected()
+{
+	return socket != INVALID_SOCKET;
+}
+
+bool ipc::IPCClient::SendMsg(const nlohmann::json& msg)
+{
+	if (socket == INVALID_SOCKET)
+		return false;
+
+	std::string out = msg.dump();
+	const char* string = out.c_str();
+
+	// The null terminator separates the messages
+	for (std::size_t i = 0; i <= out.size();)
+	{
+		int result = send(socket, string, out.size() - i + 1, 0);
+		if (result == SOCKET_ERROR)
+		{
+			int error = WSAGetLastError();
+			if (error == WSAEWOULDBLOCK)
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+				continue;
+			}
+
+			Print("Send failed: %d\n", error);
+			CloseSocket(socket);
+			return false;
+		}
+
+		i += result;
+		string += result;
+	}
+
+	return true;
+}
+
+void ipc::IPCClient::ReadMessages(std::vector<nlohmann::json>& out)
+{
+	if (socket == INVALID_SOCKET)
+		return;
+
+	char buffer[4096];
+	int result;
+
+	while ((result = recv(socket, buffer, sizeof(buffer), 0)) > 0)
+		pending.append(buffer, result);
+
+	if (result == 0 || (result == SOCKET_ERROR && WSAGetLastError() != WSAEWOULDBLOCK))
+	{
+		Print("Server disconnected, closing socket.\n");
+		CloseSocket(socket);
+	}
+
+	// Unlike the server, a message split between reads is kept until the rest arrives
+	size_t start = 0;
+	size_t end;
+	while ((end = pending.find('\0', start)) != std::string::npos)
+	{
+		try
+		{
+			out.push_back(nlohmann::json::parse(pending.begin() + start, pending.begin() + end));
+		}
+		catch (const std::exception& ex)
+		{
+			Print("Error parsing message: %s\n", ex.what());
+		}
+		start = end + 1;
+	}
+	pending.erase(0, start);
+}
+
+ipc::IPCClient::~IPCClient()
+{
+	Close();
+}
+
 void ipc::Print(const char* msg, ...)
 {
 	if (PRINT_FUNC != nullptr)
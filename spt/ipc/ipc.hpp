@@ -41,4 +41,23 @@ namespace ipc
 		std::unordered_map<std::string, std::vector<nlohmann::json>> msgQueue;
 	};
 
+	// Connects to another instance's IPCServer, uses the same null terminated JSON messages
+	class IPCClient
+	{
+	public:
+		IPCClient();
+		bool Connect(const char* port);
+		void Close();
+		bool Connected();
+		bool SendMsg(const nlohmann::json& msg);
+		// Appends every complete message received so far
+		void ReadMessages(std::vector<nlohmann::json>& out);
+		~IPCClient();
+
+	private:
+		int socket;
+		bool winsockStarted;
+		std::string pending;
+	};
+
 } // namespace ipc
@@ -0,0 +1,375 @@
+// Checks ParallelBinarySearch, the round and bounds logic of tas_script_search_coordinator. The searches are run
+// against in-process thresholds for every worker count, and on Linux also against Tests/search_worker.py, the fake
+// workers the coordinator is tried out with.
+//
+// Usage: parallel_binary_search_test [python search_worker.py], returns 1 if a check failed
+
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "parallel_binary_search.hpp"
+
+#ifdef __linux__
+#include <arpa/inet.h>
+#include <csignal>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "json.hpp"
+#endif
+
+using scripts::ParallelBinarySearch;
+using scripts::SearchResult;
+
+namespace
+{
+	int failures = 0;
+
+#define CHECK(condition) \
+	do \
+	{ \
+		if (!(condition)) \
+		{ \
+			std::printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+			++failures; \
+		} \
+	} while (0)
+
+	typedef std::function<std::vector<SearchResult>(const std::vector<int>&)> RoundRunner;
+
+	struct SearchOutcome
+	{
+		bool found = false;
+		int best = 0;
+		int rounds = 0;
+		int tested = 0;
+		bool boundsOk = true;
+	};
+
+	SearchOutcome Run(ParallelBinarySearch& search, int workers, const RoundRunner& runRound)
+	{
+		SearchOutcome outcome;
+
+		while (true)
+		{
+			auto indices = search.StartRound(workers);
+			if (indices.empty())
+				break;
+
+			auto roundResults = runRound(indices);
+			std::vector<std::pair<int, SearchResult>> results;
+			for (size_t i = 0; i < indices.size(); ++i)
+				results.emplace_back(indices[i], roundResults[i]);
+			outcome.tested += static_cast<int>(indices.size());
+
+			int best;
+			if (search.FinishRound(results, best))
+			{
+				outcome.found = true;
+				outcome.best = best;
+			}
+			outcome.boundsOk = outcome.boundsOk && search.GetLowIndex() <= search.GetHighIndex();
+		}
+
+		outcome.rounds = search.GetRounds();
+		return outcome;
+	}
+
+	// Rounds needed to cut size + 2 bound candidates down to neighbours with workers points per round
+	int MaxRounds(int size, int workers)
+	{
+		return static_cast<int>(std::ceil(std::log(size + 1.0) / std::log(workers + 1.0))) + 1;
+	}
+
+	// Lowest searches succeed from the threshold up, highest searches up to it
+	RoundRunner Threshold(int threshold, bool lowest)
+	{
+		return [threshold, lowest](const std::vector<int>& indices)
+		{
+			std::vector<SearchResult> results;
+			for (int index : indices)
+			{
+				bool success = lowest ? index >= threshold : index <= threshold;
+				results.push_back(success ? SearchResult::Success : SearchResult::Fail);
+			}
+			return results;
+		};
+	}
+
+	void TestThresholds()
+	{
+		const int LOW = -20;
+		const int HIGH = 80;
+
+		for (int workers = 1; workers <= 8; ++workers)
+		{
+			for (int threshold = LOW - 1; threshold <= HIGH + 1; ++threshold)
+			{
+				ParallelBinarySearch search;
+				search.Start(LOW, HIGH, true);
+				auto lowest = Run(search, workers, Threshold(threshold, true));
+				bool reachable = threshold <= HIGH;
+				CHECK(lowest.found == reachable);
+				CHECK(!reachable || lowest.best == (threshold < LOW ? LOW : threshold));
+				CHECK(lowest.rounds <= MaxRounds(HIGH - LOW + 1, workers));
+				CHECK(lowest.boundsOk);
+
+				search.Start(LOW, HIGH, false);
+				auto highest = Run(search, workers, Threshold(threshold, false));
+				reachable = threshold >= LOW;
+				CHECK(highest.found == reachable);
+				CHECK(!reachable || highest.best == (threshold > HIGH ? HIGH : threshold));
+				CHECK(highest.rounds <= MaxRounds(HIGH - LOW + 1, workers));
+				CHECK(highest.boundsOk);
+			}
+		}
+	}
+
+	void TestRounds()
+	{
+		// A single index is tested once
+		ParallelBinarySearch search;
+		search.Start(5, 5, true);
+		auto indices = search.StartRound(4);
+		CHECK(indices == std::vector<int>{5});
+		int best = 0;
+		CHECK(search.FinishRound({{5, SearchResult::Success}}, best));
+		CHECK(best == 5);
+		CHECK(search.StartRound(4).empty());
+		CHECK(search.GetRounds() == 1);
+
+		// Points are spread evenly and never repeat, even with more workers than indices
+		search.Start(0, 2, true);
+		indices = search.StartRound(10);
+		CHECK((indices == std::vector<int>{0, 1, 2}));
+
+		search.Start(0, 98, true);
+		indices = search.StartRound(3);
+		CHECK((indices == std::vector<int>{24, 49, 74}));
+
+		// A fail after the best success contradicts it and doesn't move the bounds past it
+		std::vector<std::pair<int, SearchResult>> results = {{24, SearchResult::Fail},
+		                                                      {49, SearchResult::Success},
+		                                                      {74, SearchResult::Fail}};
+		CHECK(search.FinishRound(results, best));
+		CHECK(best == 49);
+		CHECK(search.GetLowIndex() == 24);
+		CHECK(search.GetHighIndex() == 49);
+
+		// Rounds without a success only move the fail bound
+		CHECK(!search.FinishRound({{30, SearchResult::Fail}}, best));
+		CHECK(search.GetLowIndex() == 30);
+		CHECK(search.GetHighIndex() == 49);
+	}
+
+#ifdef __linux__
+	const double STEP = 0.1;
+
+	class WorkerProcesses
+	{
+	public:
+		WorkerProcesses(const char* python,
+		                const char* script,
+		                const std::vector<int>& ports,
+		                const char* success)
+		{
+			pid = fork();
+			if (pid == 0)
+			{
+				std::vector<std::string> args = {python, script, "--quiet", "--success", success};
+				args.push_back("--ports");
+				for (int port : ports)
+					args.push_back(std::to_string(port));
+
+				std::vector<char*> argv;
+				for (auto& arg : args)
+					argv.push_back(&arg[0]);
+				argv.push_back(nullptr);
+				execvp(python, argv.data());
+				_exit(127);
+			}
+		}
+
+		~WorkerProcesses()
+		{
+			if (pid > 0)
+			{
+				kill(pid, SIGTERM);
+				waitpid(pid, nullptr, 0);
+			}
+		}
+
+	private:
+		pid_t pid;
+	};
+
+	class WorkerConnection
+	{
+	public:
+		~WorkerConnection()
+		{
+			if (fd != -1)
+				close(fd);
+		}
+
+		// The workers take a moment to start listening
+		bool Connect(int port)
+		{
+			for (int attempt = 0; attempt < 100; ++attempt)
+			{
+				fd = socket(AF_INET, SOCK_STREAM, 0);
+				sockaddr_in address = {};
+				address.sin_family = AF_INET;
+				address.sin_port = htons(static_cast<uint16_t>(port));
+				address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+				if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0)
+					return true;
+
+				close(fd);
+				fd = -1;
+				usleep(50 * 1000);
+			}
+			return false;
+		}
+
+		bool Send(const nlohmann::json& msg)
+		{
+			std::string data = msg.dump();
+			data.push_back('\0');
+			return send(fd, data.data(), data.size(), 0) == static_cast<ssize_t>(data.size());
+		}
+
+		// Messages are null terminated JSON, like the spt_ipc server sends them
+		bool Receive(nlohmann::json& msg)
+		{
+			size_t end;
+			while ((end = pending.find('\0')) == std::string::npos)
+			{
+				char buffer[4096];
+				ssize_t received = recv(fd, buffer, sizeof(buffer), 0);
+				if (received <= 0)
+					return false;
+				pending.append(buffer, received);
+			}
+
+			msg = nlohmann::json::parse(pending.substr(0, end));
+			pending.erase(0, end + 1);
+			return true;
+		}
+
+	private:
+		int fd = -1;
+		std::string pending;
+	};
+
+	// Plays the coordinator: every round hands one index to each worker as a yaw value and collects the results
+	SearchOutcome RunAgainstWorkers(std::vector<WorkerConnection>& connections, bool lowest)
+	{
+		ParallelBinarySearch search;
+		search.Start(0, 400, lowest);
+		int nextId = 0;
+
+		auto runRound = [&](const std::vector<int>& indices)
+		{
+			std::vector<SearchResult> results(indices.size(), SearchResult::NoSearch);
+			for (size_t i = 0; i < indices.size(); ++i)
+			{
+				char value[32];
+				std::snprintf(value, sizeof(value), "%.1f", indices[i] * STEP);
+
+				nlohmann::json job;
+				job["type"] = "search_job";
+				job["id"] = nextId + static_cast<int>(i);
+				job["script"] = "parallel_binary_search_test";
+				job["variables"]["yaw"] = value;
+				CHECK(connections[i].Send(job));
+			}
+
+			for (size_t i = 0; i < indices.size(); ++i)
+			{
+				nlohmann::json reply;
+				CHECK(connections[i].Receive(reply));
+				CHECK(reply.value("type", "") == "search_result");
+				CHECK(reply.value("id", -1) == nextId + static_cast<int>(i));
+
+				std::string result = reply.value("result", "");
+				results[i] = result == "success" ? SearchResult::Success : SearchResult::Fail;
+			}
+
+			nextId += static_cast<int>(indices.size());
+			return results;
+		};
+
+		return Run(search, static_cast<int>(connections.size()), runRound);
+	}
+
+	void TestSearchWorker(const char* python, const char* script)
+	{
+		const int WORKERS = 3;
+		struct Case
+		{
+			const char* success;
+			bool lowest;
+			int expected;
+		};
+		const Case cases[] = {{"yaw >= 12.5", true, 125}, {"yaw <= 7.3", false, 73}};
+
+		for (auto& testCase : cases)
+		{
+			std::vector<int> ports;
+			int base = 27400 + static_cast<int>(getpid() % 500) * 8;
+			for (int i = 0; i < WORKERS; ++i)
+				ports.push_back(base + i);
+
+			WorkerProcesses processes(python, script, ports, testCase.success);
+			std::vector<WorkerConnection> connections(WORKERS);
+			bool connected = true;
+			for (int i = 0; i < WORKERS; ++i)
+				connected = connected && connections[i].Connect(ports[i]);
+			CHECK(connected);
+			if (!connected)
+				continue;
+
+			auto outcome = RunAgainstWorkers(connections, testCase.lowest);
+			CHECK(outcome.found);
+			CHECK(outcome.best == testCase.expected);
+			CHECK(outcome.rounds <= MaxRounds(401, WORKERS));
+			std::printf("%s: index %d after %d rounds, %d jobs on %d workers\n",
+			            testCase.success,
+			            outcome.best,
+			            outcome.rounds,
+			            outcome.tested,
+			            WORKERS);
+		}
+	}
+#endif
+} // namespace
+
+int main(int argc, char* argv[])
+{
+	TestThresholds();
+	TestRounds();
+
+#ifdef __linux__
+	if (argc > 2)
+		TestSearchWorker(argv[1], argv[2]);
+#else
+	if (argc > 2)
+		std::printf("The search_worker.py test only runs on Linux\n");
+#endif
+
+	if (failures > 0)
+	{
+		std::printf("%d checks failed\n", failures);
+		return 1;
+	}
+
+	std::printf("All checks passed\n");
+	return 0;
+}
@@ -0,0 +1,200 @@
+// Runs the golden-section line search of the coordinate and golden script searches on synthetic objectives,
+// without the game. For every range size it prints how many points the search tested next to a bisection on the
+// slope, and whether the points were right.
+//
+// The golden-section search should reuse one of its two inner points after every step, which is what makes it
+// test fewer points than the bisection. The points are rounded to indices, so the bench replays the brackets of
+// GoldenLineSearch::Next to count the steps that reused a point, the rest needed two new points. A replay that
+// gets out of step with Next throws, it only looks at points Next tested.
+//
+// Usage: search_strategy_bench [peaks per range], returns 1 if a search missed the maximum
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <map>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "search_strategy.hpp"
+
+using scripts::GoldenLineSearch;
+
+namespace
+{
+	typedef std::function<double(int)> Objective;
+
+	// Objectives by the distance from the peak, all of them unimodal
+	struct Shape
+	{
+		const char* name;
+		double (*value)(double distance);
+	};
+
+	const Shape SHAPES[] = {
+	    {"parabola", [](double distance) { return -distance * distance; }},
+	    {"abs", [](double distance) { return -std::abs(distance); }},
+	    {"skewed", [](double distance) { return distance < 0 ? 0.1 * distance : -4.0 * distance; }},
+	    {"sqrt", [](double distance) { return -std::sqrt(std::abs(distance)); }},
+	};
+
+	const int RANGES[] = {10, 100, 1000, 10000, 100000};
+
+	// Remembers every tested point, a point tested twice is only run once by the script search as well
+	struct CountingObjective
+	{
+		const Objective& objective;
+		std::map<int, double> tested;
+
+		double operator()(int x)
+		{
+			auto it = tested.find(x);
+			if (it != tested.end())
+				return it->second;
+			return tested[x] = objective(x);
+		}
+	};
+
+	// Maximum of a unimodal objective by bisecting on the sign of its slope, two points per halving
+	int Bisect(int low, int high, CountingObjective& objective)
+	{
+		while (low < high)
+		{
+			int mid = low + (high - low) / 2;
+			if (objective(mid) >= objective(mid + 1))
+				high = mid;
+			else
+				low = mid + 1;
+		}
+
+		return low;
+	}
+
+	struct GoldenRun
+	{
+		int best;
+		int tested;
+		int steps = 0;
+		int reusingSteps = 0;
+	};
+
+	GoldenRun RunGolden(int low, int high, const Objective& objective)
+	{
+		GoldenLineSearch search;
+		search.Start(low, high);
+		std::map<int, double> tested;
+
+		int index;
+		while (search.Next(index))
+		{
+			tested[index] = objective(index);
+			search.Report(index, tested[index]);
+		}
+
+		GoldenRun run;
+		run.best = search.GetBestIndex();
+		run.tested = static_cast<int>(tested.size());
+
+		// Replays the brackets of Next, a step reused a point if only one of its inner points was new
+		const double INV_PHI = 0.6180339887498949;
+		std::set<int> known;
+		int a = low;
+		int b = high;
+		int kept = INT_MIN;
+		while (b - a > 2)
+		{
+			int step = static_cast<int>(std::lround((b - a) * INV_PHI));
+			int c = b - step;
+			int d = a + step;
+			if (c >= d)
+				d = c + 1;
+			if (kept != INT_MIN && std::abs(kept - c) <= 1 && kept < d)
+				c = kept;
+			else if (kept != INT_MIN && std::abs(kept - d) <= 1 && kept > c)
+				d = kept;
+
+			int fresh = (known.insert(c).second ? 1 : 0) + (known.insert(d).second ? 1 : 0);
+			if (run.steps > 0 && fresh < 2)
+				++run.reusingSteps;
+			++run.steps;
+
+			if (tested.at(c) >= tested.at(d))
+			{
+				b = d;
+				kept = c;
+			}
+			else
+			{
+				a = c;
+				kept = d;
+			}
+		}
+
+		return run;
+	}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+	int peaks = argc > 1 ? std::atoi(argv[1]) : 200;
+	if (peaks <= 0)
+	{
+		std::printf("Usage: search_strategy_bench [peaks per range]\n");
+		return 1;
+	}
+
+	std::mt19937 rng(12345);
+	int misses = 0;
+
+	std::printf("%-10s %8s %12s %12s %14s\n", "objective", "range", "golden", "bisection", "steps reusing");
+	for (auto& shape : SHAPES)
+	{
+		for (int range : RANGES)
+		{
+			std::uniform_int_distribution<int> peakDistribution(0, range - 1);
+			double goldenTested = 0;
+			double bisectionTested = 0;
+			int steps = 0;
+			int reusingSteps = 0;
+
+			for (int i = 0; i < peaks; ++i)
+			{
+				int peak = peakDistribution(rng);
+				auto value = shape.value;
+				Objective objective = [peak, value](int x) { return value(x - peak); };
+
+				auto golden = RunGolden(0, range - 1, objective);
+				CountingObjective counting{objective, {}};
+				int bisected = Bisect(0, range - 1, counting);
+
+				misses += golden.best != peak ? 1 : 0;
+				misses += bisected != peak ? 1 : 0;
+				goldenTested += golden.tested;
+				bisectionTested += static_cast<double>(counting.tested.size());
+				steps += golden.steps;
+				reusingSteps += golden.reusingSteps;
+			}
+
+			// The first step of every search has nothing to reuse
+			int reusable = steps - peaks;
+			std::printf("%-10s %8d %12.1f %12.1f %13.1f%%\n",
+			            shape.name,
+			            range,
+			            goldenTested / peaks,
+			            bisectionTested / peaks,
+			            reusable > 0 ? 100.0 * reusingSteps / reusable : 100.0);
+		}
+	}
+
+	if (misses > 0)
+	{
+		std::printf("%d searches missed the maximum\n", misses);
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,168 @@
+// Checks the split of a test folder between the game instances of tas_test_automated_validate: every test runs in
+// exactly one shard, the shards don't depend on the directory order, and with Python the split matches the one
+// Tests/run_tests.py expects each instance to log.
+//
+// Usage: test_shard_test [python run_tests.py], returns 1 if a check failed
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "test_shard.hpp"
+
+#ifdef _WIN32
+#define popen _popen
+#define pclose _pclose
+#endif
+
+namespace fs = std::filesystem;
+using scripts::ShardTests;
+
+namespace
+{
+	int failures = 0;
+
+#define CHECK(condition) \
+	do \
+	{ \
+		if (!(condition)) \
+		{ \
+			std::printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+			++failures; \
+		} \
+	} while (0)
+
+	// Names the way the tester finds them in a game folder
+	std::vector<std::string> MakeNames(int count)
+	{
+		std::vector<std::string> names;
+		for (int i = 0; i < count; ++i)
+		{
+			std::string folder = i % 3 == 0 ? "test\\bhop\\" : (i % 3 == 1 ? "test\\" : "test\\Strafe_2\\");
+			names.push_back(folder + "case_" + std::to_string(i * 7919 % 1000));
+		}
+		return names;
+	}
+
+	void TestSplit()
+	{
+		std::mt19937 rng(1234);
+		for (int count : {0, 1, 2, 5, 17, 64})
+		{
+			std::vector<std::string> names = MakeNames(count);
+			std::vector<std::string> sorted = names;
+			std::sort(sorted.begin(), sorted.end());
+
+			// One shard is the whole sorted list
+			CHECK(ShardTests(names, 0, 1) == sorted);
+
+			for (int shards : {2, 3, 4, 7, 70})
+			{
+				std::vector<std::string> shuffled = names;
+				std::shuffle(shuffled.begin(), shuffled.end(), rng);
+
+				std::vector<std::string> all;
+				size_t smallest = names.size(), largest = 0;
+				for (int shard = 0; shard < shards; ++shard)
+				{
+					std::vector<std::string> part = ShardTests(names, shard, shards);
+					// Another instance lists the folder in another order
+					CHECK(ShardTests(shuffled, shard, shards) == part);
+					CHECK(std::is_sorted(part.begin(), part.end()));
+
+					smallest = (std::min)(smallest, part.size());
+					largest = (std::max)(largest, part.size());
+					all.insert(all.end(), part.begin(), part.end());
+				}
+
+				// Every test in exactly one shard, and the shards differ by one test at most
+				std::sort(all.begin(), all.end());
+				CHECK(all == sorted);
+				CHECK(largest - smallest <= 1);
+			}
+		}
+	}
+
+	std::string Run(const std::string& command)
+	{
+		std::string output;
+		FILE* pipe = popen(command.c_str(), "r");
+		if (!pipe)
+			return output;
+
+		char buffer[256];
+		while (std::fgets(buffer, sizeof(buffer), pipe))
+			output += buffer;
+		pclose(pipe);
+		return output;
+	}
+
+	// Lays out a game folder with scripts, and asks run_tests.py for the tests of every shard
+	void TestRunTests(const char* python, const char* runTests)
+	{
+		fs::path game = fs::temp_directory_path() / "spt_test_shard_test";
+		std::error_code ec;
+		fs::remove_all(game, ec);
+
+		std::vector<std::string> names;
+		for (auto& name : MakeNames(23))
+		{
+			std::string relative = name;
+			std::replace(relative.begin(), relative.end(), '\\', '/');
+			fs::path path = game / relative;
+			fs::create_directories(path.parent_path());
+			std::ofstream(path.string() + ".srctas");
+			std::ofstream(path.string() + ".td");
+			names.push_back(name);
+		}
+		// Neither a script without test data nor a compiled script is a test
+		std::ofstream((game / "test/no_data.srctas").string());
+		std::ofstream((game / "test/bhop/case_0.srctasc").string());
+
+		const int SHARDS = 4;
+		fs::path script = fs::path(runTests).parent_path();
+		std::string code = "import sys; sys.path.insert(0, sys.argv[1]); import run_tests; "
+		                   "tests = run_tests.list_tests(sys.argv[2]); "
+		                   "[print(shard, name) for shard in range(int(sys.argv[3])) "
+		                   "for name in run_tests.shard_tests(tests, shard, int(sys.argv[3]))]";
+		std::string command = "\"" + std::string(python) + "\" -c \"" + code + "\"";
+		command += " \"" + script.string() + "\" \"" + game.string() + "\" " + std::to_string(SHARDS);
+		std::string output = Run(command);
+
+		std::string expected;
+		for (int shard = 0; shard < SHARDS; ++shard)
+		{
+			for (auto& name : ShardTests(names, shard, SHARDS))
+				expected += std::to_string(shard) + " " + name + "\n";
+		}
+		if (output != expected)
+		{
+			std::printf("run_tests.py split the tests differently:\n%s", output.c_str());
+			std::printf("expected:\n%s", expected.c_str());
+			++failures;
+		}
+
+		fs::remove_all(game, ec);
+	}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+	TestSplit();
+	if (argc > 2)
+		TestRunTests(argv[1], argv[2]);
+	else
+		std::printf("No Python given, run_tests.py isn't checked\n");
+
+	if (failures)
+	{
+		std::printf("%d checks failed\n", failures);
+		return 1;
+	}
+	std::printf("all checks passed\n");
+	return 0;
+}
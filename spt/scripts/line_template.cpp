@@ -0,0 +1,114 @@
+#include "stdafx.hpp"
+#include "line_template.hpp"
+
+namespace scripts
+{
+	int TemplateValues::GetIndex(const std::string& name)
+	{
+		auto it = indices.find(name);
+		if (it != indices.end())
+			return it->second;
+
+		int index = static_cast<int>(values.size());
+		Value value;
+		value.name = name;
+		values.push_back(std::move(value));
+		indices.emplace(name, index);
+		return index;
+	}
+
+	void TemplateValues::Set(const std::string& name, const std::string& value)
+	{
+		auto& entry = values[GetIndex(name)];
+		entry.set = true;
+		if (entry.defined && entry.value == value)
+			return;
+
+		entry.value = value;
+		entry.defined = true;
+		entry.changed = ++version;
+	}
+
+	void TemplateValues::FinishUpdate()
+	{
+		for (auto& entry : values)
+		{
+			if (!entry.set && entry.defined)
+			{
+				entry.defined = false;
+				entry.changed = ++version;
+			}
+			entry.set = false;
+		}
+	}
+
+	void TemplateValues::Clear()
+	{
+		values.clear();
+		indices.clear();
+	}
+
+	LineTemplate::LineTemplate(const std::string& line, TemplateValues& values)
+	{
+		size_t literalStart = 0;
+		size_t pos = 0;
+
+		while (true)
+		{
+			size_t close = line.find(']', pos);
+			if (close == std::string::npos)
+				break;
+
+			// The innermost [ before the ], like searching for the whole [name] would find
+			size_t open = line.rfind('[', close);
+			if (open == std::string::npos || open < literalStart)
+			{
+				pos = close + 1;
+				continue;
+			}
+
+			literals.push_back(line.substr(literalStart, open - literalStart));
+			slots.push_back(values.GetIndex(line.substr(open + 1, close - open - 1)));
+			literalStart = close + 1;
+			pos = literalStart;
+		}
+
+		literals.push_back(line.substr(literalStart));
+	}
+
+	const std::string& LineTemplate::Render(const TemplateValues& values)
+	{
+		bool upToDate = renderedVersion != 0;
+		for (int slot : slots)
+		{
+			if (values.values[slot].changed >= renderedVersion)
+			{
+				upToDate = false;
+				break;
+			}
+		}
+
+		if (upToDate)
+			return rendered;
+
+		rendered = literals[0];
+		for (size_t i = 0; i < slots.size(); ++i)
+		{
+			auto& value = values.values[slots[i]];
+			if (value.defined)
+			{
+				rendered += value.value;
+			}
+			else
+			{
+				rendered += '[';
+				rendered += value.name;
+				rendered += ']';
+			}
+			rendered += literals[i + 1];
+		}
+
+		renderedVersion = values.version + 1;
+		return rendered;
+	}
+} // namespace scripts
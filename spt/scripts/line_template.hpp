@@ -0,0 +1,63 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace scripts
+{
+	// Current variable values for rendering templates, every value remembers the update it last changed in
+	class TemplateValues
+	{
+	public:
+		int GetIndex(const std::string& name);
+		const std::string& GetName(int index) const
+		{
+			return values[index].name;
+		}
+		// Marks the variable as defined for the current update
+		void Set(const std::string& name, const std::string& value);
+		// Variables that weren't set since the last call are undefined from now on
+		void FinishUpdate();
+		// Invalidates the slots of every template built with these values
+		void Clear();
+
+	private:
+		friend class LineTemplate;
+
+		struct Value
+		{
+			std::string name;
+			std::string value;
+			uint64_t changed = 0;
+			bool defined = false;
+			bool set = false;
+		};
+
+		std::vector<Value> values;
+		std::unordered_map<std::string, int> indices;
+		uint64_t version = 1;
+	};
+
+	/*
+	* A script line split once into literal text and [variable] slots. Rendering concatenates the pieces with the
+	* current values and is skipped entirely if none of the line's variables changed since the last render.
+	* Slots of undefined variables render as the original [name] text.
+	*/
+	class LineTemplate
+	{
+	public:
+		LineTemplate(const std::string& line, TemplateValues& values);
+		const std::string& Render(const TemplateValues& values);
+		const std::vector<int>& GetSlots() const
+		{
+			return slots;
+		}
+
+	private:
+		std::vector<std::string> literals; // one more than there are slots
+		std::vector<int> slots;
+		std::string rendered;
+		uint64_t renderedVersion = 0;
+	};
+} // namespace scripts
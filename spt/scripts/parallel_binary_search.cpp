@@ -0,0 +1,94 @@
+#include "stdafx.hpp"
+#include "parallel_binary_search.hpp"
+
+#include <algorithm>
+
+namespace scripts
+{
+	void ParallelBinarySearch::Start(int lowIndex, int highIndex, bool lowest)
+	{
+		this->lowest = lowest;
+		rangeLow = lowIndex;
+		rangeHigh = highIndex;
+		low = lowIndex - 1;
+		high = highIndex + 1;
+		rounds = 0;
+	}
+
+	std::vector<int> ParallelBinarySearch::StartRound(int points)
+	{
+		std::vector<int> indices;
+		int previous = low;
+
+		for (int i = 1; i <= points; ++i)
+		{
+			int index = low + static_cast<int>(static_cast<long long>(high - low) * i / (points + 1));
+			if (index <= previous || index >= high)
+				continue;
+
+			indices.push_back(index);
+			previous = index;
+		}
+
+		if (!indices.empty())
+			++rounds;
+		return indices;
+	}
+
+	bool ParallelBinarySearch::FinishRound(const std::vector<std::pair<int, SearchResult>>& results, int& bestIndex)
+	{
+		int successBound = lowest ? high : low;
+		bool succeeded = false;
+
+		for (auto& result : results)
+		{
+			if (result.second != SearchResult::Success)
+				continue;
+
+			if (lowest ? result.first < successBound : result.first > successBound)
+			{
+				successBound = result.first;
+				succeeded = true;
+			}
+		}
+
+		// Fails past the best success contradict the other results and are left out
+		int failBound = lowest ? low : high;
+		for (auto& result : results)
+		{
+			if (result.second != SearchResult::Fail)
+				continue;
+
+			if (lowest ? (result.first > failBound && result.first < successBound)
+			           : (result.first < failBound && result.first > successBound))
+			{
+				failBound = result.first;
+			}
+		}
+
+		if (lowest)
+		{
+			low = failBound;
+			high = successBound;
+		}
+		else
+		{
+			low = successBound;
+			high = failBound;
+		}
+
+		if (succeeded)
+			bestIndex = successBound;
+		return succeeded;
+	}
+
+	int ParallelBinarySearch::GetLowIndex() const
+	{
+		return (std::max)(low, rangeLow);
+	}
+
+	int ParallelBinarySearch::GetHighIndex() const
+	{
+		return (std::min)(high, rangeHigh);
+	}
+} // namespace scripts
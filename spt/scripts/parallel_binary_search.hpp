@@ -0,0 +1,42 @@
+#pragma once
+#include <utility>
+#include <vector>
+
+#include "search_types.hpp"
+
+namespace scripts
+{
+	/*
+	* Binary search over the indices of one range variable that tests several points per round. The bounds start one
+	* past both ends of the range and are only known once they have been tested, every round spreads its points
+	* evenly between them and cuts the range into points + 1 pieces. Like the single instance binary search, the
+	* results are assumed to be monotonic: everything on one side of the answer fails and the rest succeeds.
+	*/
+	class ParallelBinarySearch
+	{
+	public:
+		// lowest searches for the lowest index that succeeds, otherwise the highest one
+		void Start(int lowIndex, int highIndex, bool lowest);
+		// Indices to test in the next round, empty once there's nothing left between the bounds
+		std::vector<int> StartRound(int points);
+		// Narrows the bounds to the results of a round, returns true and the best index if anything succeeded
+		bool FinishRound(const std::vector<std::pair<int, SearchResult>>& results, int& bestIndex);
+
+		// The lowest index that can still be the answer, clamped to the range
+		int GetLowIndex() const;
+		// The highest index that can still be the answer, clamped to the range
+		int GetHighIndex() const;
+		int GetRounds() const
+		{
+			return rounds;
+		}
+
+	private:
+		bool lowest;
+		int rangeLow;
+		int rangeHigh;
+		int low;
+		int high;
+		int rounds;
+	};
+} // namespace scripts
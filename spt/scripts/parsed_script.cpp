@@ -85,6 +85,7 @@ namespace scripts
 		scriptName.clear();
 		demoCount = 1;
 		afterFramesTick = 0;
+		startTick = 0;
 		afterFramesEntries.clear();
 		saveStateIndexes.clear();
 		initCommand =
@@ -114,6 +115,7 @@ namespace scripts
 		{
 			int tick = saveStates[saveStateIndex].tick;
 			saveName = saveStates[saveStateIndex].key;
+			startTick = tick;
 
 			for (size_t i = 0; i < afterFramesEntries.size(); ++i)
 			{
@@ -48,6 +48,11 @@ namespace scripts
 		{
 			return afterFramesTick;
 		}
+		// Tick of the savestate the script starts from
+		int GetStartTick()
+		{
+			return startTick;
+		}
 
 	private:
 		int demoCount;
@@ -55,6 +60,7 @@ namespace scripts
 		std::string saveName;
 		std::string scriptName;
 		int afterFramesTick;
+		int startTick;
 		Savestate GetSaveStateInfo();
 		std::vector<Savestate> saveStates;
 	};
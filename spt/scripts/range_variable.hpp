@@ -2,31 +2,11 @@
 #include <random>
 #include <sstream>
 #include "math.hpp"
+#include "search_types.hpp"
 #include "string_utils.hpp"
 
 namespace scripts
 {
-	class SearchDoneException
-	{
-	};
-
-	enum class SearchResult
-	{
-		NoSearch,
-		Success,
-		Fail
-	};
-	enum class SearchType
-	{
-		None,
-		Lowest,
-		Range,
-		Highest,
-		Random,
-		RandomLowest,
-		RandomHighest
-	};
-
 	template<typename T>
 	class RangeVariable
 	{
@@ -38,6 +18,20 @@ namespace scripts
 		void ParseInput(const std::string& value, bool angle);
 		void ParseValues(const std::string& value);
 
+		// For searches that test several values at once
+		int GetLowIndex() const
+		{
+			return lowIndex;
+		}
+		int GetHighIndex() const
+		{
+			return highIndex;
+		}
+		void SetBounds(int low, int high);
+		void SetIndex(int index);
+		std::string GetValueAt(int index);
+		int GetRandomIndex();
+
 	private:
 		void SelectLow(SearchResult lastResult);
 		void SelectHigh(SearchResult lastResult);
@@ -72,6 +66,33 @@ namespace scripts
 		return std::to_string(GetValueForIndex(valueIndex));
 	}
 
+	template<typename T>
+	inline void RangeVariable<T>::SetBounds(int low, int high)
+	{
+		lowIndex = low;
+		highIndex = high;
+		SelectMiddle();
+	}
+
+	template<typename T>
+	inline void RangeVariable<T>::SetIndex(int index)
+	{
+		valueIndex = index;
+		lastIndex = index;
+	}
+
+	template<typename T>
+	inline std::string RangeVariable<T>::GetValueAt(int index)
+	{
+		return std::to_string(GetValueForIndex(index));
+	}
+
+	template<typename T>
+	inline int RangeVariable<T>::GetRandomIndex()
+	{
+		return uniformRandom(rng);
+	}
+
 	template<typename T>
 	inline std::string RangeVariable<T>::GetRangeString()
 	{
@@ -0,0 +1,241 @@
+#include "stdafx.hpp"
+#include "search_strategy.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <stdexcept>
+
+namespace scripts
+{
+	const double INV_PHI = 0.6180339887498949;
+	const int MAX_COORDINATE_PASSES = 16;
+
+	void GoldenLineSearch::Start(int low, int high)
+	{
+		a = low;
+		b = high;
+		kept = NO_POINT;
+		objectives.clear();
+	}
+
+	bool GoldenLineSearch::GetNextUntested(int& index)
+	{
+		for (int i = a; i <= b; ++i)
+		{
+			if (objectives.find(i) == objectives.end())
+			{
+				index = i;
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	bool GoldenLineSearch::Next(int& index)
+	{
+		while (b - a > 2)
+		{
+			int step = static_cast<int>(std::lround((b - a) * INV_PHI));
+			int c = b - step;
+			int d = a + step;
+			if (c >= d)
+				d = c + 1;
+
+			// The inner point left from the last step is reused when rounding puts it next to a new point,
+			// otherwise every step would need two new points instead of one
+			if (kept != NO_POINT && std::abs(kept - c) <= 1 && kept < d)
+				c = kept;
+			else if (kept != NO_POINT && std::abs(kept - d) <= 1 && kept > c)
+				d = kept;
+
+			auto cIt = objectives.find(c);
+			if (cIt == objectives.end())
+			{
+				index = c;
+				return true;
+			}
+
+			auto dIt = objectives.find(d);
+			if (dIt == objectives.end())
+			{
+				index = d;
+				return true;
+			}
+
+			// The maximum of a unimodal function can't be on the far side of the lower point
+			if (cIt->second >= dIt->second)
+			{
+				b = d;
+				kept = c;
+			}
+			else
+			{
+				a = c;
+				kept = d;
+			}
+		}
+
+		// Few enough points left to just test them all
+		return GetNextUntested(index);
+	}
+
+	void GoldenLineSearch::Report(int index, double objective)
+	{
+		objectives[index] = objective;
+	}
+
+	int GoldenLineSearch::GetBestIndex() const
+	{
+		int best = a;
+		double bestObjective = -INFINITY;
+		for (auto& pair : objectives)
+		{
+			if (pair.second > bestObjective)
+			{
+				best = pair.first;
+				bestObjective = pair.second;
+			}
+		}
+
+		return best;
+	}
+
+	GoldenSectionStrategy::GoldenSectionStrategy(const std::vector<SearchDimension>& dimensions)
+	{
+		if (dimensions.size() != 1)
+			throw std::invalid_argument("Golden-section search only accepts one range variable");
+
+		line.Start(dimensions[0].low, dimensions[0].high);
+	}
+
+	bool GoldenSectionStrategy::Next(std::vector<int>& point)
+	{
+		point.resize(1);
+		return line.Next(point[0]);
+	}
+
+	void GoldenSectionStrategy::Report(const std::vector<int>& point, double objective)
+	{
+		line.Report(point[0], objective);
+	}
+
+	CoordinateDescentStrategy::CoordinateDescentStrategy(const std::vector<SearchDimension>& dimensions)
+	    : dimensions(dimensions), dimension(0), pass(0), moved(false)
+	{
+		if (dimensions.empty())
+			throw std::invalid_argument("Coordinate descent needs at least one range variable");
+
+		for (auto& dim : dimensions)
+			current.push_back((dim.low + dim.high) / 2);
+
+		line.Start(dimensions[0].low, dimensions[0].high);
+	}
+
+	bool CoordinateDescentStrategy::Next(std::vector<int>& point)
+	{
+		while (true)
+		{
+			int index;
+			if (line.Next(index))
+			{
+				point = current;
+				point[dimension] = index;
+				return true;
+			}
+
+			// Line search done, move along this variable and go to the next one
+			int best = line.GetBestIndex();
+			if (best != current[dimension])
+			{
+				current[dimension] = best;
+				moved = true;
+			}
+
+			if (++dimension == dimensions.size())
+			{
+				dimension = 0;
+				++pass;
+
+				// With one variable the second pass can't find anything new
+				if (!moved || pass >= MAX_COORDINATE_PASSES || dimensions.size() == 1)
+				{
+					point = current;
+					return false;
+				}
+				moved = false;
+			}
+
+			line.Start(dimensions[dimension].low, dimensions[dimension].high);
+		}
+	}
+
+	void CoordinateDescentStrategy::Report(const std::vector<int>& point, double objective)
+	{
+		line.Report(point[dimension], objective);
+	}
+
+	LatinHypercubeStrategy::LatinHypercubeStrategy(const std::vector<SearchDimension>& dimensions,
+	                                               int sampleCount,
+	                                               std::mt19937& rng)
+	    : nextSample(0)
+	{
+		if (sampleCount <= 0)
+			throw std::invalid_argument("Latin hypercube search needs a positive sample count");
+
+		samples.assign(sampleCount, std::vector<int>(dimensions.size()));
+
+		// Every variable's range is cut into one stratum per sample and every stratum is used exactly once
+		for (size_t dim = 0; dim < dimensions.size(); ++dim)
+		{
+			std::vector<int> strata(sampleCount);
+			for (int i = 0; i < sampleCount; ++i)
+				strata[i] = i;
+			std::shuffle(strata.begin(), strata.end(), rng);
+
+			int range = dimensions[dim].high - dimensions[dim].low + 1;
+			double width = static_cast<double>(range) / sampleCount;
+			for (int i = 0; i < sampleCount; ++i)
+			{
+				std::uniform_real_distribution<double> offset(0.0, width);
+				int index = dimensions[dim].low + static_cast<int>(strata[i] * width + offset(rng));
+				samples[i][dim] = std::min(index, dimensions[dim].high);
+			}
+		}
+	}
+
+	bool LatinHypercubeStrategy::Next(std::vector<int>& point)
+	{
+		if (nextSample >= samples.size())
+			return false;
+
+		point = samples[nextSample++];
+		return true;
+	}
+
+	bool IsStrategySearch(SearchType type)
+	{
+		return type == SearchType::CoordinateDescent || type == SearchType::GoldenSection
+		       || type == SearchType::LatinHypercube;
+	}
+
+	std::shared_ptr<SearchStrategy> CreateSearchStrategy(SearchType type,
+	                                                     const std::vector<SearchDimension>& dimensions,
+	                                                     int samples)
+	{
+		static std::mt19937 rng(std::random_device{}());
+
+		switch (type)
+		{
+		case SearchType::CoordinateDescent:
+			return std::make_shared<CoordinateDescentStrategy>(dimensions);
+		case SearchType::GoldenSection:
+			return std::make_shared<GoldenSectionStrategy>(dimensions);
+		case SearchType::LatinHypercube:
+			return std::make_shared<LatinHypercubeStrategy>(dimensions, samples, rng);
+		default:
+			throw std::invalid_argument("Search type is not a multi-variable search");
+		}
+	}
+} // namespace scripts
@@ -0,0 +1,98 @@
+#pragma once
+#include <climits>
+#include <map>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "search_types.hpp"
+
+namespace scripts
+{
+	// Index range of one range variable, both ends included
+	struct SearchDimension
+	{
+		int low;
+		int high;
+	};
+
+	/*
+	* Searches over several range variables at once for the highest objective. The strategies only see variable
+	* indices, the VariableContainer turns those into values and the iteration results into objectives.
+	*/
+	class SearchStrategy
+	{
+	public:
+		virtual ~SearchStrategy() = default;
+		// Fills in the next point to test, returns false once the search is done
+		virtual bool Next(std::vector<int>& point) = 0;
+		virtual void Report(const std::vector<int>& point, double objective) = 0;
+	};
+
+	// Golden-section search over one dimension for a unimodal objective, evaluated points are remembered
+	class GoldenLineSearch
+	{
+	public:
+		void Start(int low, int high);
+		// Index to test next, returns false once the best index is known
+		bool Next(int& index);
+		void Report(int index, double objective);
+		int GetBestIndex() const;
+
+	private:
+		bool GetNextUntested(int& index);
+
+		static const int NO_POINT = INT_MIN;
+
+		int a;
+		int b;
+		int kept; // inner point of the last step that is still inside the bracket
+		std::map<int, double> objectives;
+	};
+
+	class GoldenSectionStrategy : public SearchStrategy
+	{
+	public:
+		GoldenSectionStrategy(const std::vector<SearchDimension>& dimensions);
+		virtual bool Next(std::vector<int>& point) override;
+		virtual void Report(const std::vector<int>& point, double objective) override;
+
+	private:
+		GoldenLineSearch line;
+	};
+
+	// Golden-section searches along one variable at a time, until a whole pass doesn't move the point
+	class CoordinateDescentStrategy : public SearchStrategy
+	{
+	public:
+		CoordinateDescentStrategy(const std::vector<SearchDimension>& dimensions);
+		virtual bool Next(std::vector<int>& point) override;
+		virtual void Report(const std::vector<int>& point, double objective) override;
+
+	private:
+		std::vector<SearchDimension> dimensions;
+		std::vector<int> current;
+		GoldenLineSearch line;
+		size_t dimension;
+		int pass;
+		bool moved;
+	};
+
+	// Tests a fixed number of samples that cover every variable's range evenly
+	class LatinHypercubeStrategy : public SearchStrategy
+	{
+	public:
+		LatinHypercubeStrategy(const std::vector<SearchDimension>& dimensions, int samples, std::mt19937& rng);
+		virtual bool Next(std::vector<int>& point) override;
+		virtual void Report(const std::vector<int>&, double) override {}
+
+	private:
+		std::vector<std::vector<int>> samples;
+		size_t nextSample;
+	};
+
+	bool IsStrategySearch(SearchType type);
+	std::shared_ptr<SearchStrategy> CreateSearchStrategy(SearchType type,
+	                                                     const std::vector<SearchDimension>& dimensions,
+	                                                     int samples);
+} // namespace scripts
@@ -0,0 +1,28 @@
+#pragma once
+
+namespace scripts
+{
+	class SearchDoneException
+	{
+	};
+
+	enum class SearchResult
+	{
+		NoSearch,
+		Success,
+		Fail
+	};
+	enum class SearchType
+	{
+		None,
+		Lowest,
+		Range,
+		Highest,
+		Random,
+		RandomLowest,
+		RandomHighest,
+		CoordinateDescent,
+		GoldenSection,
+		LatinHypercube
+	};
+} // namespace scripts
@@ -18,6 +18,7 @@
 
 extern ConVar y_spt_gamedir;
 extern ConVar tas_script_onsuccess;
+extern ConVar tas_script_search_autosavestate;
 
 namespace scripts
 {
@@ -27,15 +28,21 @@ namespace scripts
 	const char* RESET_VARS[] = {"cl_forwardspeed", "cl_sidespeed", "cl_yawspeed"};
 
 	const int RESET_VARS_COUNT = ARRAYSIZE(RESET_VARS);
+	const int DEFAULT_SEARCH_SAMPLES = 16;
+	const size_t MAX_LINE_TEMPLATES = 65536;
 
 	SourceTASReader::SourceTASReader()
 	{
 		InitPropertyHandlers();
+		lineTemplate = nullptr;
 		iterationFinished = true;
+		searching = false;
+		parseOnly = false;
 	}
 
 	void SourceTASReader::ExecuteScript(const std::string& script)
 	{
+		jobCallback = nullptr;
 		freezeVariables = false;
 		fileName = script;
 		CommonExecuteScript(false);
@@ -44,6 +51,7 @@ namespace scripts
 	void SourceTASReader::ExecuteScriptWithResume(const std::string& script, int resumeTicks)
 	{
 		char buffer[80];
+		jobCallback = nullptr;
 		freezeVariables = false;
 		fileName = script;
 		CommonExecuteScript(false);
@@ -57,6 +65,7 @@ namespace scripts
 
 	void SourceTASReader::StartSearch(const std::string& script)
 	{
+		jobCallback = nullptr;
 		freezeVariables = false;
 		fileName = script;
 		CommonExecuteScript(true);
@@ -65,6 +74,15 @@ namespace scripts
 
 	void SourceTASReader::SearchResult(scripts::SearchResult result)
 	{
+		if (jobCallback)
+		{
+			auto callback = std::move(jobCallback);
+			jobCallback = nullptr;
+			iterationFinished = true;
+			callback(result, GetCurrentTick());
+			return;
+		}
+
 		try
 		{
 			variables.SetResult(result);
@@ -86,12 +104,60 @@ namespace scripts
 		}
 	}
 
-	void SourceTASReader::CommonExecuteScript(bool search)
+	void SourceTASReader::SearchScore(double score)
+	{
+		if (!jobCallback)
+			variables.SetScore(score);
+		SearchResult(SearchResult::Success);
+	}
+
+	void SourceTASReader::RunSearchJob(const std::string& script,
+	                                   const std::map<std::string, std::string>& assignment,
+	                                   SearchJobCallback callback)
 	{
+		freezeVariables = false;
+		fileName = script;
+		jobAssignment = assignment;
+		jobCallback = std::move(callback);
+
+		if (!CommonExecuteScript(true) && jobCallback)
+		{
+			// Nothing is running, so there won't be a result otherwise
+			SearchResult(SearchResult::NoSearch);
+		}
+		jobAssignment.clear();
+	}
+
+	bool SourceTASReader::LoadSearchVariables(const std::string& script, VariableContainer& out, SearchType& type)
+	{
+		jobCallback = nullptr;
+		freezeVariables = false;
+		fileName = script;
+		parseOnly = true;
+		bool success = CommonExecuteScript(true);
+		parseOnly = false;
+
+		out = variables;
+		type = searchType;
+		return success;
+	}
+
+	bool SourceTASReader::CommonExecuteScript(bool search)
+	{
+		bool success = false;
+		searching = search;
 		try
 		{
 			DevMsg("Attempting to parse a version 1 TAS script...\n");
 			Reset();
+
+			if (templateFile != fileName || lineTemplates.size() > MAX_LINE_TEMPLATES)
+			{
+				lineTemplates.clear();
+				templateValues.Clear();
+				templateFile = fileName;
+			}
+			UpdateTemplateValues();
 #if OE
 			const char* dir = y_spt_gamedir.GetString();
 			if (dir == NULL || dir[0] == '\0')
@@ -121,7 +187,9 @@ namespace scripts
 					    "Unexpected section order in file. Expected order is props - variables - frames");
 			}
 
-			Execute();
+			if (!parseOnly)
+				Execute();
+			success = true;
 		}
 		catch (const std::exception& ex)
 		{
@@ -138,6 +206,7 @@ namespace scripts
 		}
 
 		scriptStream.close();
+		return success;
 	}
 
 	void SourceTASReader::OnAfterFrames()
@@ -193,9 +262,10 @@ namespace scripts
 		iterationFinished = false;
 		SetFpsAndPlayspeed();
 		spt_demostuff.Demo_StopRecording();
-		currentTick = 0;
 		spt_afterframes.ResetAfterframesQueue();
 		currentScript.Init(fileName);
+		// Conditions count ticks from the start of the script, not from the savestate
+		currentTick = currentScript.GetStartTick();
 
 		auto demoName = currentScript.GetDemoName();
 
@@ -258,6 +328,17 @@ namespace scripts
 		if (end != std::string::npos)
 			line.erase(end);
 
+		// Only lines with brackets can contain variables
+		lineTemplate = nullptr;
+		if (line.find('[') != std::string::npos)
+		{
+			auto it = lineTemplates.find(line);
+			if (it == lineTemplates.end())
+				it = lineTemplates.emplace(line, LineTemplate(line, templateValues)).first;
+			lineTemplate = &it->second;
+		}
+
+		lineUsesSearchedVariable = searching && UsesSearchedVariable();
 		ReplaceVariables();
 		lineStream.str(line);
 		lineStream.clear();
@@ -265,11 +346,36 @@ namespace scripts
 	}
 
 	void SourceTASReader::ReplaceVariables()
+	{
+		if (lineTemplate)
+			line = lineTemplate->Render(templateValues);
+	}
+
+	void SourceTASReader::UpdateTemplateValues()
 	{
 		for (auto& variable : variables.variableMap)
+			templateValues.Set(variable.first, variable.second.GetValue());
+		templateValues.FinishUpdate();
+	}
+
+	bool SourceTASReader::UsesSearchedVariable()
+	{
+		if (!lineTemplate)
+			return false;
+
+		for (int slot : lineTemplate->GetSlots())
 		{
-			ReplaceAll(line, GetVarIdentifier(variable.first), variable.second.GetValue());
+			auto& name = templateValues.GetName(slot);
+			auto it = variables.variableMap.find(name);
+			if (it == variables.variableMap.end())
+				continue;
+
+			// Search jobs have their range variables fixed to the job's values
+			if (it->second.IsSearched() || jobAssignment.count(name) != 0)
+				return true;
 		}
+
+		return false;
 	}
 
 	void SourceTASReader::ResetConvars()
@@ -338,8 +444,13 @@ namespace scripts
 		scriptStream.clear();
 		lineStream.clear();
 		line.clear();
+		lineTemplate = nullptr;
 		currentLine = 0;
+		autoSaveStateAdded = false;
+		lineUsesSearchedVariable = false;
 		searchType = SearchType::None;
+		maximizeObjective = true;
+		searchSamples = DEFAULT_SEARCH_SAMPLES;
 		playbackSpeed = 1.0f;
 		demoDelay = 0;
 		currentScript.Reset();
@@ -394,8 +505,20 @@ namespace scripts
 				ParseVariable();
 		}
 
+		for (auto& pair : jobAssignment)
+		{
+			auto it = variables.variableMap.find(pair.first);
+			if (it == variables.variableMap.end() || !it->second.IsSearched())
+				throw std::exception("Search job contained an unknown variable");
+
+			it->second = ScriptVariable("var", pair.second);
+		}
+
+		variables.maximizeObjective = maximizeObjective;
+		variables.searchSamples = searchSamples;
 		variables.Iteration(searchType);
 		variables.PrintState();
+		UpdateTemplateValues();
 	}
 
 	void SourceTASReader::ParseVariable()
@@ -408,6 +531,7 @@ namespace scripts
 		std::string value;
 		GetTriplet(lineStream, type, name, value, ' ');
 		variables.AddNewVariable(type, name, value);
+		UpdateTemplateValues();
 	}
 
 	void SourceTASReader::ParseFrames()
@@ -434,6 +558,9 @@ namespace scripts
 		}
 		else
 		{
+			if (lineUsesSearchedVariable)
+				AddAutoSaveState();
+
 			FrameBulkInfo info(lineStream);
 			auto output = HandleFrameBulk(info);
 
@@ -441,12 +568,29 @@ namespace scripts
 		}
 	}
 
+	void SourceTASReader::AddAutoSaveState()
+	{
+		// Everything before the first bulk that uses a searched variable is the same in every iteration, so the
+		// savestate's key stays the same and later iterations load it instead of replaying the start
+		if (autoSaveStateAdded || !tas_script_search_autosavestate.GetBool())
+			return;
+
+		autoSaveStateAdded = true;
+		if (currentScript.GetScriptLength() > 0)
+		{
+			DevMsg("Adding a search savestate at tick %i\n", currentScript.GetScriptLength());
+			currentScript.AddSaveState();
+		}
+	}
+
 	void SourceTASReader::InitPropertyHandlers()
 	{
 		propertyHandlers["save"] = &SourceTASReader::HandleSave;
 		propertyHandlers["demo"] = &SourceTASReader::HandleDemo;
 		propertyHandlers["demodelay"] = &SourceTASReader::HandleDemoDelay;
 		propertyHandlers["search"] = &SourceTASReader::HandleSearch;
+		propertyHandlers["objective"] = &SourceTASReader::HandleObjective;
+		propertyHandlers["samples"] = &SourceTASReader::HandleSamples;
 		propertyHandlers["playspeed"] = &SourceTASReader::HandlePlaybackSpeed;
 		propertyHandlers["settings"] = &SourceTASReader::HandleSettings;
 
@@ -501,10 +645,33 @@ namespace scripts
 			searchType = SearchType::RandomLowest;
 		else if (value == "randomhigh")
 			searchType = SearchType::RandomHighest;
+		else if (value == "coordinate")
+			searchType = SearchType::CoordinateDescent;
+		else if (value == "golden" || value == "ternary")
+			searchType = SearchType::GoldenSection;
+		else if (value == "lhs")
+			searchType = SearchType::LatinHypercube;
 		else
 			throw std::exception("Search type was invalid");
 	}
 
+	void SourceTASReader::HandleObjective(const std::string& value)
+	{
+		if (value == "max")
+			maximizeObjective = true;
+		else if (value == "min")
+			maximizeObjective = false;
+		else
+			throw std::exception("Objective was invalid, expected max or min");
+	}
+
+	void SourceTASReader::HandleSamples(const std::string& value)
+	{
+		searchSamples = ParseValue<int>(value);
+		if (searchSamples <= 0)
+			throw std::exception("Sample count has to be positive");
+	}
+
 	void SourceTASReader::HandlePlaybackSpeed(const std::string& value)
 	{
 		playbackSpeed = ParseValue<float>(value);
@@ -1,10 +1,13 @@
 #pragma once
 #include <fstream>
+#include <functional>
 #include <map>
 #include <sstream>
 #include <string>
+#include <unordered_map>
 
 #include "condition.hpp"
+#include "line_template.hpp"
 #include "parsed_script.hpp"
 #include "range_variable.hpp"
 #include "variable_container.hpp"
@@ -12,6 +15,7 @@
 namespace scripts
 {
 	extern const std::string SCRIPT_EXT;
+	typedef std::function<void(SearchResult result, int tick)> SearchJobCallback;
 
 	class SourceTASReader
 	{
@@ -21,6 +25,14 @@ namespace scripts
 		void ExecuteScriptWithResume(const std::string& script, int resumeTicks);
 		void StartSearch(const std::string& script);
 		void SearchResult(scripts::SearchResult result);
+		void SearchScore(double score);
+		// Runs one iteration of a search with the range variables set to the given values, the result goes to
+		// the callback instead of starting the next iteration
+		void RunSearchJob(const std::string& script,
+		                  const std::map<std::string, std::string>& assignment,
+		                  SearchJobCallback callback);
+		// Parses the properties and variables of a search script without running it
+		bool LoadSearchVariables(const std::string& script, VariableContainer& out, SearchType& type);
 		void OnAfterFrames();
 		int GetCurrentTick();
 		int GetCurrentScriptLength();
@@ -29,6 +41,12 @@ namespace scripts
 	private:
 		bool iterationFinished;
 		bool freezeVariables;
+		bool searching;
+		bool autoSaveStateAdded;
+		bool lineUsesSearchedVariable;
+		bool parseOnly;
+		std::map<std::string, std::string> jobAssignment;
+		SearchJobCallback jobCallback;
 		std::string fileName;
 		std::ifstream scriptStream;
 		std::istringstream lineStream;
@@ -36,16 +54,24 @@ namespace scripts
 		int currentLine;
 		long long int currentTick;
 		SearchType searchType;
+		bool maximizeObjective;
+		int searchSamples;
 		float tickTime;
 		float playbackSpeed;
 		int demoDelay;
 
 		VariableContainer variables;
 		ParsedScript currentScript;
+		// Lines split into text and variables, keyed by their contents, so search iterations only render the
+		// lines whose variables changed
+		std::unordered_map<std::string, LineTemplate> lineTemplates;
+		std::string templateFile;
+		TemplateValues templateValues;
+		LineTemplate* lineTemplate;
 		std::map<std::string, void (SourceTASReader::*)(const std::string&)> propertyHandlers;
 		std::vector<std::unique_ptr<Condition>> conditions;
 
-		void CommonExecuteScript(bool search);
+		bool CommonExecuteScript(bool search);
 		void Reset();
 		void ResetIterationState();
 		void Execute();
@@ -54,6 +80,8 @@ namespace scripts
 		bool ParseLine();
 		void SetNewLine();
 		void ReplaceVariables();
+		void UpdateTemplateValues();
+		bool UsesSearchedVariable();
 		void ResetConvars();
 
 		void InitPropertyHandlers();
@@ -64,6 +92,8 @@ namespace scripts
 		void HandleDemo(const std::string& value);
 		void HandleDemoDelay(const std::string& value);
 		void HandleSearch(const std::string& value);
+		void HandleObjective(const std::string& value);
+		void HandleSamples(const std::string& value);
 		void HandlePlaybackSpeed(const std::string& value);
 		void HandleTickRange(const std::string& value);
 		void HandleTicksFromEndRange(const std::string& value);
@@ -117,6 +147,7 @@ namespace scripts
 
 		void ParseFrames();
 		void ParseFrameBulk();
+		void AddAutoSaveState();
 
 		bool isLineEmpty();
 		bool IsFramesLine();
@@ -0,0 +1,19 @@
+#include "stdafx.hpp"
+#include "test_shard.hpp"
+
+#include <algorithm>
+
+namespace scripts
+{
+	std::vector<std::string> ShardTests(std::vector<std::string> testNames, int shard, int shardCount)
+	{
+		std::sort(testNames.begin(), testNames.end());
+		if (shardCount <= 1)
+			return testNames;
+
+		std::vector<std::string> shardNames;
+		for (size_t i = shard; i < testNames.size(); i += shardCount)
+			shardNames.push_back(testNames[i]);
+		return shardNames;
+	}
+} // namespace scripts
@@ -0,0 +1,13 @@
+#pragma once
+#include <string>
+#include <vector>
+
+namespace scripts
+{
+	/*
+	* Sorts the test names and keeps every shardCount-th one, starting from shard. The directory order isn't
+	* guaranteed, so the sort is what makes the shards of one folder agree on the split. Tests/run_tests.py splits
+	* the list the same way in shard_tests.
+	*/
+	std::vector<std::string> ShardTests(std::vector<std::string> testNames, int shard, int shardCount);
+} // namespace scripts
@@ -5,6 +5,7 @@
 #include "..\sptlib-wrapper.hpp"
 #include "file.hpp"
 #include "srctas_reader.hpp"
+#include "test_shard.hpp"
 #include "dbg.h"
 
 namespace scripts
@@ -13,6 +14,8 @@ namespace scripts
 
 	Tester::Tester()
 	{
+		shard = 0;
+		shardCount = 1;
 		ResetIteration();
 		Reset();
 		trackers[VELOCITY_NO] = std::unique_ptr<Tracker>(new VelocityTracker(9));
@@ -23,6 +26,12 @@ namespace scripts
 	void Tester::LoadTest(const std::string& testName, bool generating, bool autoTest)
 	{
 		this->automatedTest = autoTest;
+		if (!autoTest)
+		{
+			shard = 0;
+			shardCount = 1;
+		}
+
 		std::string folder(GetFolder(testName));
 		if (std::filesystem::is_directory(folder))
 		{
@@ -221,8 +230,14 @@ namespace scripts
 		}
 	}
 
-	void Tester::RunAutomatedTest(const std::string& folder, bool generating, const std::string& fileName)
+	void Tester::RunAutomatedTest(const std::string& folder,
+	                              bool generating,
+	                              const std::string& fileName,
+	                              int shardIndex,
+	                              int shards)
 	{
+		shard = shardIndex;
+		shardCount = shards;
 		OpenLogFile(fileName);
 		LoadTest(folder, generating, true);
 	}
@@ -235,12 +250,12 @@ namespace scripts
 		for (auto& entry : std::filesystem::recursive_directory_iterator(folder))
 		{
 			auto& path = entry.path();
-			auto str = path.string().substr(GetGameDir().length() + 1);
-			int extPos = str.find(SCRIPT_EXT);
 
-			if (extPos != -1)
+			// Compiled .srctasc files would match a plain find of the extension
+			if (path.extension() == SCRIPT_EXT)
 			{
-				str = str.substr(0, extPos);
+				auto str = path.string().substr(GetGameDir().length() + 1);
+				str = str.substr(0, str.length() - SCRIPT_EXT.length());
 
 				if (RequiredFilesExist(str, generating))
 				{
@@ -249,10 +264,19 @@ namespace scripts
 			}
 		}
 
+		testNames = ShardTests(std::move(testNames), shard, shardCount);
+
 		if (!testNames.empty())
 			LoadTest(testNames[0], generating, automatedTest);
 		else
+		{
 			PrintTestMessage("No valid tests found in the folder.");
+			if (automatedTest)
+			{
+				CloseLogFile();
+				EngineConCmd("quit");
+			}
+		}
 	}
 
 	void Tester::ResetIteration()
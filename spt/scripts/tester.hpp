@@ -46,7 +46,12 @@ namespace scripts
 		void GenerationIteration();
 		void TestDone();
 
-		void RunAutomatedTest(const std::string& folder, bool generating, const std::string& testFileName);
+		// With several shards, only every shardCount-th test of the sorted test list runs, starting from shard
+		void RunAutomatedTest(const std::string& folder,
+		                      bool generating,
+		                      const std::string& testFileName,
+		                      int shard = 0,
+		                      int shardCount = 1);
 		void RunAllTests(const std::string& folder, bool generating, bool automatedTest = false);
 		void ResetIteration();
 		void Reset();
@@ -70,6 +75,8 @@ namespace scripts
 		bool runningTest;
 		bool generatingData;
 		bool automatedTest;
+		int shard;
+		int shardCount;
 
 		std::string testFileName;
 		std::size_t currentTestItem;
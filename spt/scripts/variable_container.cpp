@@ -3,6 +3,8 @@
 #include "dbg.h"
 #include "srctas_reader.hpp"
 
+#include <cmath>
+
 extern ConVar tas_script_printvars;
 
 namespace scripts
@@ -29,6 +31,11 @@ namespace scripts
 		lastSuccessPrint.clear();
 		iterationPrint.clear();
 		lastSuccessTick = FAIL_TICK;
+		strategy.reset();
+		strategyVariables.clear();
+		strategyPoint.clear();
+		hasScore = false;
+		bestObjective = -INFINITY;
 	}
 
 	void VariableContainer::Iteration(SearchType type)
@@ -37,6 +44,12 @@ namespace scripts
 		int changes = 0;
 		searchType = type;
 
+		if (IsStrategySearch(type))
+		{
+			StrategyIteration(type);
+			return;
+		}
+
 		if (type == SearchType::None)
 			maxChanges = 0;
 		else if (type == SearchType::Highest || type == SearchType::Lowest || type == SearchType::Range)
@@ -59,6 +72,35 @@ namespace scripts
 		}
 	}
 
+	void VariableContainer::StrategyIteration(SearchType type)
+	{
+		if (!strategy)
+		{
+			std::vector<SearchDimension> dimensions;
+			for (auto& var : variableMap)
+			{
+				if (!var.second.IsSearched())
+					continue;
+
+				strategyVariables.push_back(var.first);
+				SearchDimension dimension{var.second.GetLowIndex(), var.second.GetHighIndex()};
+				dimensions.push_back(dimension);
+			}
+
+			strategy = CreateSearchStrategy(type, dimensions, searchSamples);
+		}
+		else if (lastResult != SearchResult::NoSearch)
+		{
+			strategy->Report(strategyPoint, lastObjective);
+		}
+
+		if (!strategy->Next(strategyPoint))
+			throw SearchDoneException();
+
+		for (size_t i = 0; i < strategyVariables.size(); ++i)
+			variableMap[strategyVariables[i]].SetIndex(strategyPoint[i]);
+	}
+
 	void VariableContainer::AddNewVariable(const std::string& type,
 	                                       const std::string& name,
 	                                       const std::string& value)
@@ -76,6 +118,12 @@ namespace scripts
 
 		lastResult = result;
 
+		if (IsStrategySearch(searchType))
+		{
+			SetStrategyResult(result);
+			return;
+		}
+
 		if (Successful(result))
 		{
 			lastSuccessTick = g_TASReader.GetCurrentTick();
@@ -85,6 +133,36 @@ namespace scripts
 		}
 	}
 
+	void VariableContainer::SetScore(double value)
+	{
+		hasScore = true;
+		score = value;
+	}
+
+	void VariableContainer::SetStrategyResult(SearchResult result)
+	{
+		// The strategies look for the highest objective, failing is worse than any score
+		if (result == SearchResult::Fail)
+			lastObjective = -INFINITY;
+		else
+			lastObjective = hasScore ? score : 0.0;
+
+		if (!maximizeObjective && result != SearchResult::Fail)
+			lastObjective = -lastObjective;
+
+		if (result == SearchResult::Success && lastObjective > bestObjective)
+		{
+			bestObjective = lastObjective;
+			lastSuccessTick = g_TASReader.GetCurrentTick();
+			lastSuccessPrint = iterationPrint + "\t- tick: " + std::to_string(lastSuccessTick);
+			if (hasScore)
+				lastSuccessPrint += ", score: " + std::to_string(score);
+			lastSuccessPrint += "\n";
+		}
+
+		hasScore = false;
+	}
+
 	void VariableContainer::PrintState()
 	{
 		if (variableMap.size() == 0)
@@ -182,6 +260,94 @@ namespace scripts
 		}
 	}
 
+	int ScriptVariable::GetLowIndex()
+	{
+		switch (variableType)
+		{
+		case VariableType::IntRange:
+			return data.intRange.GetLowIndex();
+		case VariableType::FloatRange:
+		case VariableType::AngleRange:
+			return data.floatRange.GetLowIndex();
+		default:
+			throw std::exception("Variable is not a range variable");
+		}
+	}
+
+	int ScriptVariable::GetHighIndex()
+	{
+		switch (variableType)
+		{
+		case VariableType::IntRange:
+			return data.intRange.GetHighIndex();
+		case VariableType::FloatRange:
+		case VariableType::AngleRange:
+			return data.floatRange.GetHighIndex();
+		default:
+			throw std::exception("Variable is not a range variable");
+		}
+	}
+
+	void ScriptVariable::SetBounds(int low, int high)
+	{
+		switch (variableType)
+		{
+		case VariableType::IntRange:
+			data.intRange.SetBounds(low, high);
+			break;
+		case VariableType::FloatRange:
+		case VariableType::AngleRange:
+			data.floatRange.SetBounds(low, high);
+			break;
+		default:
+			throw std::exception("Variable is not a range variable");
+		}
+	}
+
+	void ScriptVariable::SetIndex(int index)
+	{
+		switch (variableType)
+		{
+		case VariableType::IntRange:
+			data.intRange.SetIndex(index);
+			break;
+		case VariableType::FloatRange:
+		case VariableType::AngleRange:
+			data.floatRange.SetIndex(index);
+			break;
+		default:
+			throw std::exception("Variable is not a range variable");
+		}
+	}
+
+	std::string ScriptVariable::GetValueAt(int index)
+	{
+		switch (variableType)
+		{
+		case VariableType::IntRange:
+			return data.intRange.GetValueAt(index);
+		case VariableType::FloatRange:
+		case VariableType::AngleRange:
+			return data.floatRange.GetValueAt(index);
+		default:
+			throw std::exception("Variable is not a range variable");
+		}
+	}
+
+	int ScriptVariable::GetRandomIndex()
+	{
+		switch (variableType)
+		{
+		case VariableType::IntRange:
+			return data.intRange.GetRandomIndex();
+		case VariableType::FloatRange:
+		case VariableType::AngleRange:
+			return data.floatRange.GetRandomIndex();
+		default:
+			throw std::exception("Variable is not a range variable");
+		}
+	}
+
 	bool ScriptVariable::Iteration(SearchResult search, SearchType type)
 	{
 		switch (variableType)
@@ -1,9 +1,12 @@
 #pragma once
 
 #include <map>
+#include <memory>
 #include <random>
 #include <string>
+#include <vector>
 #include "range_variable.hpp"
+#include "search_strategy.hpp"
 
 namespace scripts
 {
@@ -38,6 +41,18 @@ namespace scripts
 		std::string GetPrint(); // For printing the variable state
 		std::string GetValue(); // Returns the actual value of the variable in a string
 		bool Iteration(SearchResult search, SearchType type);
+		// Range variables change between search iterations
+		bool IsSearched() const
+		{
+			return variableType != VariableType::Var && variableType != VariableType::Error;
+		}
+		// Index based access to range variables for the search coordinator
+		int GetLowIndex();
+		int GetHighIndex();
+		void SetBounds(int low, int high);
+		void SetIndex(int index);
+		std::string GetValueAt(int index);
+		int GetRandomIndex();
 
 	private:
 		VariableType variableType;
@@ -53,16 +68,32 @@ namespace scripts
 		std::string iterationPrint;
 		SearchType searchType;
 		std::map<std::string, ScriptVariable> variableMap;
+		// Settings for the multi-variable searches, set from the script properties
+		bool maximizeObjective;
+		int searchSamples;
 
 		void PrintBest();
 		void Clear();
 		void Iteration(SearchType type);
 		void AddNewVariable(const std::string& type, const std::string& name, const std::string& value);
 		void SetResult(SearchResult result);
+		// Successful result with a score for the multi-variable searches
+		void SetScore(double score);
 		void PrintState();
 
 	private:
 		bool Successful(SearchResult result);
+		void StrategyIteration(SearchType type);
+		void SetStrategyResult(SearchResult result);
 		SearchResult lastResult;
+
+		// Shared so that the container stays copyable
+		std::shared_ptr<SearchStrategy> strategy;
+		std::vector<std::string> strategyVariables;
+		std::vector<int> strategyPoint;
+		bool hasScore;
+		double score;
+		double lastObjective;
+		double bestObjective;
 	};
 } // namespace scripts
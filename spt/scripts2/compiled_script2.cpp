@@ -0,0 +1,200 @@
+#include "stdafx.hpp"
+#include "compiled_script2.hpp"
+#include "framebulk_handler2.hpp"
+#include "game_detection.hpp"
+#include "variable_container2.hpp"
+#include "thirdparty\md5.hpp"
+
+#include <fstream>
+
+namespace scripts2
+{
+	const std::string COMPILED_SCRIPT_EXT = ".srctasc";
+
+	static const uint32_t COMPILED_MAGIC = 0x43545053; // "SPTC"
+	static const uint32_t COMPILED_VERSION = 1;
+	// Sanity limit so that a corrupt file can't make us allocate gigabytes
+	static const uint32_t MAX_COMPILED_ENTRIES = 16 * 1024 * 1024;
+
+	template<typename T>
+	static void Write(std::ofstream& os, const T& value)
+	{
+		os.write(reinterpret_cast<const char*>(&value), sizeof(T));
+	}
+
+	static void WriteString(std::ofstream& os, const std::string& str)
+	{
+		Write(os, static_cast<uint32_t>(str.size()));
+		os.write(str.data(), str.size());
+	}
+
+	template<typename T>
+	static bool Read(std::ifstream& is, T& value)
+	{
+		return static_cast<bool>(is.read(reinterpret_cast<char*>(&value), sizeof(T)));
+	}
+
+	static bool ReadString(std::ifstream& is, std::string& str)
+	{
+		uint32_t size;
+		if (!Read(is, size) || size > MAX_COMPILED_ENTRIES)
+			return false;
+
+		str.resize(size);
+		return size == 0 || static_cast<bool>(is.read(&str[0], size));
+	}
+
+	void CompiledFrames::Clear()
+	{
+		key.clear();
+		ops.clear();
+		strings.clear();
+		stringIndices.clear();
+		nextTick = 0;
+	}
+
+	uint32_t CompiledFrames::Intern(const std::string& str)
+	{
+		auto it = stringIndices.find(str);
+		if (it != stringIndices.end())
+			return it->second;
+
+		uint32_t index = static_cast<uint32_t>(strings.size());
+		strings.push_back(str);
+		stringIndices.emplace(str, index);
+		return index;
+	}
+
+	void CompiledFrames::AddBulk(const FrameBulkOutput& output, int line)
+	{
+		if (output.ticks < 0 && output.ticks != NO_AFTERFRAMES_BULK)
+			throw std::exception("Frame bulk length was negative");
+
+		int tick = output.ticks >= 0 ? nextTick : NO_AFTERFRAMES_BULK;
+		ops.push_back(FrameOp{FrameOpType::Bulk,
+		                      tick,
+		                      output.ticks,
+		                      Intern(output.initialCommand),
+		                      Intern(output.repeatingCommand),
+		                      line});
+
+		if (output.ticks >= 0)
+			nextTick += output.ticks;
+	}
+
+	void CompiledFrames::AddSaveState(int line)
+	{
+		ops.push_back(FrameOp{FrameOpType::SaveState, nextTick, 0, 0, 0, line});
+	}
+
+	void CompiledFrames::AddSaveLoad(int line)
+	{
+		ops.push_back(FrameOp{FrameOpType::SaveLoad, nextTick, 1, 0, 0, line});
+		++nextTick;
+	}
+
+	bool CompiledFrames::Load(const std::string& path, const std::string& expectedKey)
+	{
+		std::ifstream is(path, std::ios::binary);
+		if (!is.is_open())
+			return false;
+
+		uint32_t magic, version;
+		std::string fileKey;
+		if (!Read(is, magic) || !Read(is, version) || magic != COMPILED_MAGIC || version != COMPILED_VERSION
+		    || !ReadString(is, fileKey) || fileKey != expectedKey)
+			return false;
+
+		Clear();
+
+		uint32_t stringCount;
+		if (!Read(is, stringCount) || stringCount > MAX_COMPILED_ENTRIES)
+			return false;
+
+		strings.resize(stringCount);
+		for (auto& str : strings)
+		{
+			if (!ReadString(is, str))
+				return false;
+		}
+
+		uint32_t opCount;
+		if (!Read(is, opCount) || opCount > MAX_COMPILED_ENTRIES)
+			return false;
+
+		ops.resize(opCount);
+		for (auto& op : ops)
+		{
+			uint8_t type;
+			if (!Read(is, type) || !Read(is, op.tick) || !Read(is, op.ticks) || !Read(is, op.initialCommand)
+			    || !Read(is, op.repeatingCommand) || !Read(is, op.line))
+				return false;
+
+			if (type > static_cast<uint8_t>(FrameOpType::SaveLoad))
+				return false;
+
+			op.type = static_cast<FrameOpType>(type);
+			if (op.type == FrameOpType::Bulk
+			    && (op.initialCommand >= stringCount || op.repeatingCommand >= stringCount))
+				return false;
+		}
+
+		for (uint32_t i = 0; i < stringCount; ++i)
+			stringIndices.emplace(strings[i], i);
+		key = expectedKey;
+		return true;
+	}
+
+	bool CompiledFrames::Save(const std::string& path) const
+	{
+		std::ofstream os(path, std::ios::binary | std::ios::trunc);
+		if (!os.is_open())
+			return false;
+
+		Write(os, COMPILED_MAGIC);
+		Write(os, COMPILED_VERSION);
+		WriteString(os, key);
+
+		Write(os, static_cast<uint32_t>(strings.size()));
+		for (auto& str : strings)
+			WriteString(os, str);
+
+		Write(os, static_cast<uint32_t>(ops.size()));
+		for (auto& op : ops)
+		{
+			Write(os, static_cast<uint8_t>(op.type));
+			Write(os, op.tick);
+			Write(os, op.ticks);
+			Write(os, op.initialCommand);
+			Write(os, op.repeatingCommand);
+			Write(os, op.line);
+		}
+
+		return os.good();
+	}
+
+	std::string GetCompiledScriptKey(std::string_view scriptContents, VariableContainer& variables)
+	{
+		MD5 hash;
+		hash.update(scriptContents.data(), static_cast<MD5::size_type>(scriptContents.size()));
+
+		// Frame bulks are parsed after the variables have been replaced, and DMoMM has its own field layout.
+		// The handlers can change without COMPILED_VERSION changing, they have their own version.
+		std::string state = utils::DoesGameLookLikeDMoMM() ? "dmomm" : "default";
+		state += '\n';
+		state += std::to_string(FRAMEBULK_HANDLER_VERSION);
+		state += '\n';
+		state += std::to_string(COMPILED_VERSION);
+		for (auto& variable : variables.variableMap)
+		{
+			state += '\n';
+			state += variable.first;
+			state += '=';
+			state += variable.second.GetValue();
+		}
+		hash.update(state.data(), static_cast<MD5::size_type>(state.size()));
+		hash.finalize();
+
+		return hash.hexdigest();
+	}
+} // namespace scripts2
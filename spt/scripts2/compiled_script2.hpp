@@ -0,0 +1,60 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace scripts2
+{
+	struct FrameBulkOutput;
+	class VariableContainer;
+
+	extern const std::string COMPILED_SCRIPT_EXT;
+
+	enum class FrameOpType : uint8_t
+	{
+		Bulk,
+		SaveState,
+		SaveLoad
+	};
+
+	struct FrameOp
+	{
+		FrameOpType type;
+		int tick; // tick the op starts on, NO_AFTERFRAMES_BULK for bulks that run during loads
+		int ticks;
+		uint32_t initialCommand; // index into the string pool
+		uint32_t repeatingCommand;
+		int line; // for error messages
+	};
+
+	/*
+	* The frames section of a script after variables have been replaced and the frame bulks have been turned into
+	* commands. Identical commands are only stored once. It's saved next to the script and is only valid for the
+	* same script contents, variable values, game and frame bulk handlers, see GetCompiledScriptKey.
+	*/
+	class CompiledFrames
+	{
+	public:
+		std::string key;
+		std::vector<FrameOp> ops;
+		std::vector<std::string> strings;
+
+		void Clear();
+		void AddBulk(const FrameBulkOutput& output, int line);
+		void AddSaveState(int line);
+		void AddSaveLoad(int line);
+
+		bool Load(const std::string& path, const std::string& expectedKey);
+		bool Save(const std::string& path) const;
+
+	private:
+		uint32_t Intern(const std::string& str);
+
+		std::unordered_map<std::string, uint32_t> stringIndices;
+		int nextTick = 0;
+	};
+
+	std::string GetCompiledScriptKey(std::string_view scriptContents, VariableContainer& variables);
+} // namespace scripts2
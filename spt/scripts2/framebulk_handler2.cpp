@@ -2,9 +2,13 @@
 
 #include "framebulk_handler2.hpp"
 
-#include "string_utils.hpp"
 #include "game_detection.hpp"
 
+#include <charconv>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
 namespace scripts2
 {
 	typedef void (*CommandCallback)(FrameBulkInfo& frameBulkInfo);
@@ -19,6 +23,49 @@ namespace scripts2
 	const char WILDCARD = '*';
 	const char DELIMITER = '|';
 
+	// Same rules as extracting the value from a stream: leading whitespace and trailing garbage are allowed
+	static std::string_view GetNumberStart(std::string_view value)
+	{
+		size_t start = value.find_first_not_of(" \t\n\v\f\r");
+		if (start == std::string_view::npos)
+			return std::string_view();
+
+		value.remove_prefix(start);
+		if (!value.empty() && value[0] == '+' && (value.size() == 1 || value[1] != '-'))
+			value.remove_prefix(1);
+
+		return value;
+	}
+
+	static bool IsIntValue(std::string_view value, int& result)
+	{
+		value = GetNumberStart(value);
+		auto parse = std::from_chars(value.data(), value.data() + value.size(), result);
+		return parse.ec == std::errc();
+	}
+
+	static bool IsFloatValue(std::string_view value)
+	{
+		float result;
+		value = GetNumberStart(value);
+		// no inf or nan
+		size_t digit = !value.empty() && value[0] == '-' ? 1 : 0;
+		if (digit >= value.size())
+			return false;
+		if (!isdigit(static_cast<unsigned char>(value[digit])) && value[digit] != '.')
+			return false;
+
+		auto parse = std::from_chars(value.data(), value.data() + value.size(), result);
+		return parse.ec == std::errc();
+	}
+
+	static int ParseInt(std::string_view value)
+	{
+		int result = 0;
+		IsIntValue(value, result);
+		return result;
+	}
+
 	const auto STRAFE = std::pair<int, int>(0, 0);
 	const auto STRAFE_TYPE = std::pair<int, int>(0, 1);
 	const auto JUMP_TYPE = std::pair<int, int>(0, 2);
@@ -64,33 +111,33 @@ namespace scripts2
 		if (frameBulkInfo.IsSectionNoop(0))
 			return;
 
-		if (frameBulkInfo.ContainsFlag(STRAFE, "s"))
+		if (frameBulkInfo.ContainsFlag(STRAFE, 's'))
 		{
 			frameBulkInfo.AddCommand("spt_tas_strafe 1");
 
 			if (!frameBulkInfo.IsInt(JUMP_TYPE) || !frameBulkInfo.IsInt(STRAFE_TYPE))
-				throw std::exception("Jump type or strafe type was not an integer");
+				throw std::runtime_error("Jump type or strafe type was not an integer");
 
-			frameBulkInfo.AddCommand("spt_tas_strafe_jumptype " + frameBulkInfo[JUMP_TYPE]);
-			frameBulkInfo.AddCommand("spt_tas_strafe_type " + frameBulkInfo[STRAFE_TYPE]);
+			frameBulkInfo.AddCommand("spt_tas_strafe_jumptype ", frameBulkInfo[JUMP_TYPE]);
+			frameBulkInfo.AddCommand("spt_tas_strafe_type ", frameBulkInfo[STRAFE_TYPE]);
 		}
 		else
 			frameBulkInfo.AddCommand("spt_tas_strafe 0");
 
-		if (frameBulkInfo.ContainsFlag(AUTOJUMP, "j"))
+		if (frameBulkInfo.ContainsFlag(AUTOJUMP, 'j'))
 			frameBulkInfo.AddCommand("spt_autojump 1");
 		else
 			frameBulkInfo.AddCommand("spt_autojump 0");
 
-		frameBulkInfo.AddPlusMinusCmd("spt_spam duck", frameBulkInfo.ContainsFlag(DUCKSPAM, "d"));
-		frameBulkInfo.AddPlusMinusCmd("spt_spam use", frameBulkInfo.ContainsFlag(USESPAM, "u"));
+		frameBulkInfo.AddPlusMinusCmd("spt_spam duck", frameBulkInfo.ContainsFlag(DUCKSPAM, 'd'));
+		frameBulkInfo.AddPlusMinusCmd("spt_spam use", frameBulkInfo.ContainsFlag(USESPAM, 'u'));
 
-		if (frameBulkInfo.ContainsFlag(JUMPBUG, "b"))
+		if (frameBulkInfo.ContainsFlag(JUMPBUG, 'b'))
 			frameBulkInfo.AddCommand("spt_tas_strafe_autojb 1");
 		else
 			frameBulkInfo.AddCommand("spt_tas_strafe_autojb 0");
 
-		if (frameBulkInfo.ContainsFlag(LGAGST, "l"))
+		if (frameBulkInfo.ContainsFlag(LGAGST, 'l'))
 			frameBulkInfo.AddCommand("spt_tas_strafe_lgagst 1");
 		else
 			frameBulkInfo.AddCommand("spt_tas_strafe_lgagst 0");
@@ -98,9 +145,9 @@ namespace scripts2
 #pragma warning(push)
 #pragma warning(disable : 4390)
 		// todo
-		if (frameBulkInfo.ContainsFlag(DUCK_BEFORE_COLLISION, "c"))
+		if (frameBulkInfo.ContainsFlag(DUCK_BEFORE_COLLISION, 'c'))
 			;
-		if (frameBulkInfo.ContainsFlag(DUCK_BEFORE_GROUND, "g"))
+		if (frameBulkInfo.ContainsFlag(DUCK_BEFORE_GROUND, 'g'))
 			;
 #pragma warning(pop)
 	}
@@ -110,12 +157,12 @@ namespace scripts2
 		if (frameBulkInfo.IsSectionNoop(1))
 			return;
 
-		frameBulkInfo.AddPlusMinusCmd("forward", frameBulkInfo.ContainsFlag(FORWARD, "f"));
-		frameBulkInfo.AddPlusMinusCmd("moveleft", frameBulkInfo.ContainsFlag(LEFT, "l"));
-		frameBulkInfo.AddPlusMinusCmd("moveright", frameBulkInfo.ContainsFlag(RIGHT, "r"));
-		frameBulkInfo.AddPlusMinusCmd("back", frameBulkInfo.ContainsFlag(BACK, "b"));
-		frameBulkInfo.AddPlusMinusCmd("moveup", frameBulkInfo.ContainsFlag(UP, "u"));
-		frameBulkInfo.AddPlusMinusCmd("movedown", frameBulkInfo.ContainsFlag(DOWN, "d"));
+		frameBulkInfo.AddPlusMinusCmd("forward", frameBulkInfo.ContainsFlag(FORWARD, 'f'));
+		frameBulkInfo.AddPlusMinusCmd("moveleft", frameBulkInfo.ContainsFlag(LEFT, 'l'));
+		frameBulkInfo.AddPlusMinusCmd("moveright", frameBulkInfo.ContainsFlag(RIGHT, 'r'));
+		frameBulkInfo.AddPlusMinusCmd("back", frameBulkInfo.ContainsFlag(BACK, 'b'));
+		frameBulkInfo.AddPlusMinusCmd("moveup", frameBulkInfo.ContainsFlag(UP, 'u'));
+		frameBulkInfo.AddPlusMinusCmd("movedown", frameBulkInfo.ContainsFlag(DOWN, 'd'));
 	}
 
 	void Field3(FrameBulkInfo& frameBulkInfo)
@@ -124,26 +171,26 @@ namespace scripts2
 			return;
 
 		frameBulkInfo.AddPlusMinusCmd("jump",
-		                              frameBulkInfo.ContainsFlag(JUMP, "j")
-		                                  || frameBulkInfo.ContainsFlag(AUTOJUMP, "j"));
-		frameBulkInfo.AddPlusMinusCmd("duck", frameBulkInfo.ContainsFlag(DUCK, "d"));
-		frameBulkInfo.AddPlusMinusCmd("use", frameBulkInfo.ContainsFlag(USE, "u"));
-		frameBulkInfo.AddPlusMinusCmd("attack", frameBulkInfo.ContainsFlag(ATTACK1, "1"));
-		frameBulkInfo.AddPlusMinusCmd("attack2", frameBulkInfo.ContainsFlag(ATTACK2, "2"));
+		                              frameBulkInfo.ContainsFlag(JUMP, 'j')
+		                                  || frameBulkInfo.ContainsFlag(AUTOJUMP, 'j'));
+		frameBulkInfo.AddPlusMinusCmd("duck", frameBulkInfo.ContainsFlag(DUCK, 'd'));
+		frameBulkInfo.AddPlusMinusCmd("use", frameBulkInfo.ContainsFlag(USE, 'u'));
+		frameBulkInfo.AddPlusMinusCmd("attack", frameBulkInfo.ContainsFlag(ATTACK1, '1'));
+		frameBulkInfo.AddPlusMinusCmd("attack2", frameBulkInfo.ContainsFlag(ATTACK2, '2'));
 		if (utils::DoesGameLookLikeDMoMM())
 		{
-			frameBulkInfo.AddPlusMinusCmd("speed", frameBulkInfo.ContainsFlag(MM_WALK, "w"));
-			frameBulkInfo.AddPlusMinusCmd("sprint", frameBulkInfo.ContainsFlag(MM_SPRINT, "s"));
-			frameBulkInfo.AddPlusMinusCmd("kick", frameBulkInfo.ContainsFlag(MM_KICK, "k"));
-			frameBulkInfo.AddPlusMinusCmd("leanleft", frameBulkInfo.ContainsFlag(MM_LEANLEFT, "l"));
-			frameBulkInfo.AddPlusMinusCmd("leanright", frameBulkInfo.ContainsFlag(MM_LEANRIGHT, "r"));
-			frameBulkInfo.AddPlusMinusCmd("xana", frameBulkInfo.ContainsFlag(MM_XANA, "x"));
+			frameBulkInfo.AddPlusMinusCmd("speed", frameBulkInfo.ContainsFlag(MM_WALK, 'w'));
+			frameBulkInfo.AddPlusMinusCmd("sprint", frameBulkInfo.ContainsFlag(MM_SPRINT, 's'));
+			frameBulkInfo.AddPlusMinusCmd("kick", frameBulkInfo.ContainsFlag(MM_KICK, 'k'));
+			frameBulkInfo.AddPlusMinusCmd("leanleft", frameBulkInfo.ContainsFlag(MM_LEANLEFT, 'l'));
+			frameBulkInfo.AddPlusMinusCmd("leanright", frameBulkInfo.ContainsFlag(MM_LEANRIGHT, 'r'));
+			frameBulkInfo.AddPlusMinusCmd("xana", frameBulkInfo.ContainsFlag(MM_XANA, 'x'));
 		}
 		else
 		{
-			frameBulkInfo.AddPlusMinusCmd("reload", frameBulkInfo.ContainsFlag(RELOAD, "r"));
-			frameBulkInfo.AddPlusMinusCmd("walk", frameBulkInfo.ContainsFlag(WALK, "w"));
-			frameBulkInfo.AddPlusMinusCmd("speed", frameBulkInfo.ContainsFlag(SPEED, "s"));
+			frameBulkInfo.AddPlusMinusCmd("reload", frameBulkInfo.ContainsFlag(RELOAD, 'r'));
+			frameBulkInfo.AddPlusMinusCmd("walk", frameBulkInfo.ContainsFlag(WALK, 'w'));
+			frameBulkInfo.AddPlusMinusCmd("speed", frameBulkInfo.ContainsFlag(SPEED, 's'));
 		}
 	}
 
@@ -151,27 +198,26 @@ namespace scripts2
 	{
 		if (frameBulkInfo.IsFloat(YAW_KEY))
 		{
-			if (frameBulkInfo.ContainsFlag(STRAFE, "s"))
-				frameBulkInfo.AddCommand("spt_tas_strafe_yaw " + frameBulkInfo[YAW_KEY]);
+			if (frameBulkInfo.ContainsFlag(STRAFE, 's'))
+				frameBulkInfo.AddCommand("spt_tas_strafe_yaw ", frameBulkInfo[YAW_KEY]);
 			else
-				frameBulkInfo.AddCommand("spt_setyaw " + frameBulkInfo[YAW_KEY]);
+				frameBulkInfo.AddCommand("spt_setyaw ", frameBulkInfo[YAW_KEY]);
 		}
 		else if (frameBulkInfo[YAW_KEY] != EMPTY_FIELD)
-			throw std::exception("Unable to parse the yaw angle");
+			throw std::runtime_error("Unable to parse the yaw angle");
 
 		if (frameBulkInfo.IsFloat(PITCH_KEY))
-			frameBulkInfo.AddCommand("spt_setpitch " + frameBulkInfo[PITCH_KEY]);
+			frameBulkInfo.AddCommand("spt_setpitch ", frameBulkInfo[PITCH_KEY]);
 		else if (frameBulkInfo[PITCH_KEY] != EMPTY_FIELD)
-			throw std::exception("Unable to parse the pitch angle");
+			throw std::runtime_error("Unable to parse the pitch angle");
 	}
 
 	void Field6(FrameBulkInfo& frameBulkInfo)
 	{
 		if (!frameBulkInfo.IsInt(TICKS))
-			throw std::exception("Tick value was not an integer");
+			throw std::runtime_error("Tick value was not an integer");
 
-		int ticks = std::atoi(frameBulkInfo[TICKS].c_str());
-		frameBulkInfo.data.ticks = ticks;
+		frameBulkInfo.data.ticks = ParseInt(frameBulkInfo[TICKS]);
 	}
 
 	void Field7(FrameBulkInfo& frameBulkInfo)
@@ -219,6 +265,13 @@ namespace scripts2
 		initialCommand += newCmd;
 	}
 
+	void FrameBulkOutput::AddCommand(const std::string& newCmd, std::string_view arg)
+	{
+		initialCommand.push_back(';');
+		initialCommand += newCmd;
+		initialCommand.append(arg.data(), arg.size());
+	}
+
 	void FrameBulkOutput::AddCommand(char initChar, const std::string& newCmd)
 	{
 		initialCommand.push_back(';');
@@ -226,75 +279,82 @@ namespace scripts2
 		initialCommand += newCmd;
 	}
 
-	FrameBulkInfo::FrameBulkInfo(std::istringstream& stream)
+	FrameBulkInfo::FrameBulkInfo(std::string_view line)
 	{
 		int section = 0;
-		std::string line;
+		size_t start = 0;
 
-		do
+		while (true)
 		{
-			std::getline(stream, line, DELIMITER);
+			size_t end = line.find(DELIMITER, start);
+			auto value = line.substr(start, end - start); // npos - start still reaches the end
 
-			// The sections after the first three are single string (could map section index to value type here but probably not worth the effort)
-			if (section > 2)
+			// Commands can't contain the delimiter, anything after the last known section is dropped
+			if (section < MAX_SECTIONS)
 			{
-				dataMap[std::make_pair(section, 0)] = line;
+				sections[section] = value;
+				sectionCount = section + 1;
 			}
-			else
-			{
-				for (size_t i = 0; i < line.size(); ++i)
-					dataMap[std::make_pair(section, i)] = line[i];
-			}
-
-			bool isNoop = true;
-			bool allNotNoop = true;
 
-			for (size_t i = 0; i < line.size(); ++i)
+			size_t noops = 0;
+			for (char c : value)
 			{
-				if (line[i] != NOOP)
-				{
-					isNoop = false;
-				}
-				else
-				{
-					allNotNoop = false;
-				}
+				if (c == NOOP)
+					++noops;
 			}
 
-			if (isNoop)
+			if (noops == value.size())
 			{
-				noopSections.insert(section);
+				if (section < 32)
+					noopSections |= 1u << section;
 			}
-			else if (!allNotNoop)
-				throw std::exception("Some characters in a noop block were not noop!");
+			else if (noops != 0)
+				throw std::runtime_error("Some characters in a noop block were not noop!");
 
 			++section;
-		} while (stream.good());
+			if (end == std::string_view::npos)
+				break;
+			start = end + 1;
+		}
 	}
 
-	const std::string& FrameBulkInfo::operator[](std::pair<int, int> i)
+	bool FrameBulkInfo::HasKey(const std::pair<int, int>& key) const
 	{
-		if (dataMap.find(i) == dataMap.end())
+		if (key.first < 0 || key.first >= sectionCount || key.second < 0)
+			return false;
+
+		// The first three sections are indexed by character
+		if (key.first <= 2)
+			return static_cast<size_t>(key.second) < sections[key.first].size();
+		else
+			return key.second == 0;
+	}
+
+	std::string_view FrameBulkInfo::operator[](std::pair<int, int> i)
+	{
+		if (!HasKey(i))
 		{
 			char buffer[50];
 			std::snprintf(buffer, 50, "Unable to find index (%i, %i) in frame bulk", i.first, i.second);
 
-			throw std::exception(buffer);
+			throw std::runtime_error(buffer);
 		}
 
-		return dataMap[i];
+		if (i.first <= 2)
+			return sections[i.first].substr(i.second, 1);
+		else
+			return sections[i.first];
 	}
 
 	bool FrameBulkInfo::IsInt(std::pair<int, int> i)
 	{
-		std::string value = this->operator[](i);
-		return IsValue<int>(value);
+		int result;
+		return IsIntValue(this->operator[](i), result);
 	}
 
 	bool FrameBulkInfo::IsFloat(std::pair<int, int> i)
 	{
-		std::string value = this->operator[](i);
-		return IsValue<float>(value);
+		return IsFloatValue(this->operator[](i));
 	}
 
 	void FrameBulkInfo::AddPlusMinusCmd(const std::string& command, bool set)
@@ -309,25 +369,27 @@ namespace scripts2
 	{
 		for (size_t i = 0; i < fields.length(); ++i)
 		{
-			auto key = std::make_pair(index, i);
-			if (fields[i] != WILDCARD && frameBulkInfo.dataMap.find(key) != frameBulkInfo.dataMap.end())
+			auto key = std::make_pair(index, static_cast<int>(i));
+			if (fields[i] != WILDCARD && frameBulkInfo.HasKey(key))
 			{
-				auto& value = frameBulkInfo[key];
-				if (value[0] != fields[i] && value[0] != '-' && value[0] != NOOP)
+				char value = frameBulkInfo[key][0];
+				if (value != fields[i] && value != '-' && value != NOOP)
 				{
 					std::ostringstream os;
 					os << "Expected " << fields[i] << ", got " << value << " in field: " << fields;
-					throw std::exception(os.str().c_str());
+					throw std::runtime_error(os.str().c_str());
 				}
 			}
 		}
 	}
-	bool FrameBulkInfo::ContainsFlag(const std::pair<int, int>& key, const std::string& flag)
+
+	bool FrameBulkInfo::ContainsFlag(const std::pair<int, int>& key, char flag)
 	{
-		return dataMap.find(key) != dataMap.end() && this->operator[](key) == flag;
+		return HasKey(key) && this->operator[](key)[0] == flag;
 	}
+
 	bool FrameBulkInfo::IsSectionNoop(int section)
 	{
-		return noopSections.find(section) != noopSections.end();
+		return section >= 0 && section < 32 && (noopSections & (1u << section)) != 0;
 	}
 } // namespace scripts2
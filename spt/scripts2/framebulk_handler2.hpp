@@ -1,10 +1,14 @@
 #pragma once
 
-#include "srctas_reader2.hpp"
+#include <string>
+#include <string_view>
+#include <utility>
 
 namespace scripts2
 {
 	const int NO_AFTERFRAMES_BULK = -1;
+	// Part of the compiled script key, bump it whenever a handler changes the commands it outputs
+	const int FRAMEBULK_HANDLER_VERSION = 1;
 
 	struct FrameBulkOutput
 	{
@@ -13,29 +17,44 @@ namespace scripts2
 		int ticks;
 
 		void AddCommand(const std::string& newCmd);
+		void AddCommand(const std::string& newCmd, std::string_view arg);
 		void AddCommand(char initChar, const std::string& newCmd);
 	};
 
+	/*
+	* Fields and flags of a single frame bulk. The line is only tokenized, the fields are views into it, so the line
+	* has to outlive this object.
+	*/
 	class FrameBulkInfo
 	{
 	public:
-		FrameBulkInfo(std::istringstream& stream);
-		const std::string& operator[](std::pair<int, int> i);
+		static const int MAX_SECTIONS = 8;
+
+		FrameBulkInfo(std::string_view line);
+		std::string_view operator[](std::pair<int, int> i);
 		bool IsInt(std::pair<int, int> i);
 		bool IsFloat(std::pair<int, int> i);
 		void AddCommand(const std::string& cmd)
 		{
 			data.AddCommand(cmd);
 		}
+		void AddCommand(const std::string& cmd, std::string_view arg)
+		{
+			data.AddCommand(cmd, arg);
+		}
 		void AddPlusMinusCmd(const std::string& command, bool set);
 		void ValidateFieldFlags(FrameBulkInfo& frameBulkInfo, const std::string& fields, int index);
-		bool ContainsFlag(const std::pair<int, int>& key, const std::string& flag);
+		bool ContainsFlag(const std::pair<int, int>& key, char flag);
 		bool IsSectionNoop(int field);
 		FrameBulkOutput data;
 
 	private:
-		std::map<std::pair<int, int>, std::string> dataMap;
-		std::set<int> noopSections;
+		bool HasKey(const std::pair<int, int>& key) const;
+
+		// The first three sections are single character flags, the rest are whole strings
+		std::string_view sections[MAX_SECTIONS];
+		int sectionCount = 0;
+		unsigned int noopSections = 0;
 	};
 
 	FrameBulkOutput HandleFrameBulk(FrameBulkInfo& frameBulkInfo);
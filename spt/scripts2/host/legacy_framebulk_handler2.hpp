@@ -0,0 +1,35 @@
+#pragma once
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <utility>
+
+#include "framebulk_handler2.hpp"
+
+namespace legacy
+{
+	class FrameBulkInfo
+	{
+	public:
+		FrameBulkInfo(std::istringstream& stream);
+		const std::string& operator[](std::pair<int, int> i);
+		bool IsInt(std::pair<int, int> i);
+		bool IsFloat(std::pair<int, int> i);
+		void AddCommand(const std::string& cmd)
+		{
+			data.AddCommand(cmd);
+		}
+		void AddPlusMinusCmd(const std::string& command, bool set);
+		void ValidateFieldFlags(FrameBulkInfo& frameBulkInfo, const std::string& fields, int index);
+		bool ContainsFlag(const std::pair<int, int>& key, const std::string& flag);
+		bool IsSectionNoop(int field);
+		scripts2::FrameBulkOutput data;
+
+	private:
+		std::map<std::pair<int, int>, std::string> dataMap;
+		std::set<int> noopSections;
+	};
+
+	scripts2::FrameBulkOutput HandleFrameBulk(FrameBulkInfo& frameBulkInfo);
+} // namespace legacy
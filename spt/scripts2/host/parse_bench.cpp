@@ -0,0 +1,245 @@
+// Parses the frame bulks of every .srctas script under Tests/ without the game, once with the pipeline the plugin
+// uses and once with the one it replaced. Prints the parsing speed of both and a hash of the generated commands,
+// which has to stay the same unless the output of the parser changes on purpose.
+//
+// Usage: parse_bench [scripts directory] [passes]
+//
+// Every pass reads the scripts from disk again. The current pipeline maps the file, splits it with ScriptLines and
+// tokenizes the frame bulks into views. The legacy one reads the file into an istringstream, reads every line with
+// std::getline and copies the fields of a frame bulk into a std::map, see legacy_framebulk_handler2.cpp.
+//
+// Lines are filtered the way SourceTASReader filters the frames section: comments are cut off, empty lines are
+// skipped and savestate lines aren't frame bulks. Lines that use script variables can't be parsed without the
+// values, they are counted but left out. Every line is parsed on its own, without the cache of the reader.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "framebulk_handler2.hpp"
+#include "hash_utils.hpp"
+#include "legacy_framebulk_handler2.hpp"
+#include "mapped_file.hpp"
+#include "script_lines2.hpp"
+
+namespace fs = std::filesystem;
+
+namespace utils
+{
+	// The field layout of DMoMM isn't timed
+	bool DoesGameLookLikeDMoMM()
+	{
+		return false;
+	}
+} // namespace utils
+
+namespace
+{
+	enum class LineKind
+	{
+		Skip,
+		FrameBulk,
+		WithVariables,
+	};
+
+	struct Results
+	{
+		size_t bulks = 0;
+		size_t withVariables = 0;
+		size_t errors = 0;
+		uint64_t hash = utils::FNV1A_64_OFFSET;
+	};
+
+	// Cuts the comment off and tells whether the line is a frame bulk of the frames section
+	LineKind Classify(std::string& line, bool& inFrames)
+	{
+		size_t comment = line.find("//");
+		if (comment != std::string::npos)
+			line.erase(comment);
+
+		if (!inFrames)
+		{
+			inFrames = line.find("frames") == 0;
+			return LineKind::Skip;
+		}
+
+		bool empty = line.find_first_not_of(' ') == std::string::npos;
+		if (empty || line.find("ss") == 0 || line.find("sl") == 0)
+			return LineKind::Skip;
+		if (line.find('[') != std::string::npos)
+			return LineKind::WithVariables;
+		return LineKind::FrameBulk;
+	}
+
+	void AddOutput(const scripts2::FrameBulkOutput& output, Results& results)
+	{
+		auto& initial = output.initialCommand;
+		auto& repeating = output.repeatingCommand;
+		results.hash = utils::Fnv1a64(initial.data(), initial.size(), results.hash);
+		results.hash = utils::Fnv1a64(repeating.data(), repeating.size(), results.hash);
+		results.hash = utils::Fnv1a64(&output.ticks, sizeof(output.ticks), results.hash);
+	}
+
+	template<typename Parse>
+	void ParseLine(std::string& line, bool& inFrames, bool firstPass, Results& results, Parse parse)
+	{
+		LineKind kind = Classify(line, inFrames);
+		if (kind == LineKind::Skip)
+			return;
+
+		if (firstPass)
+		{
+			if (kind == LineKind::WithVariables)
+			{
+				++results.withVariables;
+				return;
+			}
+			++results.bulks;
+		}
+		else if (kind == LineKind::WithVariables)
+		{
+			return;
+		}
+
+		try
+		{
+			auto output = parse(line);
+			if (firstPass)
+				AddOutput(output, results);
+		}
+		catch (const std::exception& ex)
+		{
+			if (firstPass)
+			{
+				std::printf("Unable to parse \"%s\": %s\n", line.c_str(), ex.what());
+				++results.errors;
+			}
+		}
+	}
+
+	void ParseMapped(const fs::path& path, bool firstPass, Results& results)
+	{
+		MappedFile file;
+		if (!file.Open(path.string()))
+			return;
+
+		scripts2::ScriptLines lines;
+		lines.Reset(file.GetContents());
+		std::string line;
+		bool inFrames = false;
+
+		while (lines.Next(line))
+		{
+			ParseLine(line,
+			          inFrames,
+			          firstPass,
+			          results,
+			          [](const std::string& bulk)
+			          {
+				          scripts2::FrameBulkInfo info(bulk);
+				          return scripts2::HandleFrameBulk(info);
+			          });
+		}
+	}
+
+	void ParseLegacy(const fs::path& path, bool firstPass, Results& results)
+	{
+		std::ifstream file(path);
+		if (!file.is_open())
+			return;
+
+		std::string contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+		std::istringstream scriptStream(contents);
+		std::istringstream lineStream;
+		std::string line;
+		bool inFrames = false;
+
+		while (scriptStream.good())
+		{
+			std::getline(scriptStream, line);
+			// Text mode drops these on Windows, where this parser ran
+			if (!line.empty() && line.back() == '\r')
+				line.pop_back();
+
+			ParseLine(line,
+			          inFrames,
+			          firstPass,
+			          results,
+			          [&lineStream](const std::string& bulk)
+			          {
+				          lineStream.str(bulk);
+				          lineStream.clear();
+				          legacy::FrameBulkInfo info(lineStream);
+				          return legacy::HandleFrameBulk(info);
+			          });
+		}
+	}
+
+	template<typename Parse>
+	double Time(const std::vector<fs::path>& scripts, int passes, Results& results, Parse parse)
+	{
+		auto start = std::chrono::steady_clock::now();
+		for (int pass = 0; pass < passes; ++pass)
+		{
+			for (auto& script : scripts)
+				parse(script, pass == 0, results);
+		}
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+		return elapsed.count();
+	}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+	fs::path root = argc > 1 ? argv[1] : SPT_TESTS_DIR;
+	int passes = argc > 2 ? std::atoi(argv[2]) : 200;
+
+	std::error_code ec;
+	if (!fs::is_directory(root, ec) || passes <= 0)
+	{
+		std::printf("Usage: parse_bench [scripts directory] [passes]\n");
+		return 1;
+	}
+
+	std::vector<fs::path> scripts;
+	for (auto& entry : fs::recursive_directory_iterator(root, ec))
+	{
+		if (entry.path().extension() == ".srctas")
+			scripts.push_back(entry.path());
+	}
+
+	Results legacy;
+	double legacySeconds = Time(scripts, passes, legacy, ParseLegacy);
+	Results mapped;
+	double mappedSeconds = Time(scripts, passes, mapped, ParseMapped);
+
+	double parsed = static_cast<double>(mapped.bulks) * passes;
+	std::printf("%u scripts, %u frame bulks, %u with variables left out, %u not parsed\n",
+	            static_cast<unsigned>(scripts.size()),
+	            static_cast<unsigned>(mapped.bulks),
+	            static_cast<unsigned>(mapped.withVariables),
+	            static_cast<unsigned>(mapped.errors));
+	std::printf("legacy:  %d passes in %.3f s, %.0f lines/s\n", passes, legacySeconds, parsed / legacySeconds);
+	std::printf("current: %d passes in %.3f s, %.0f lines/s, %.2fx\n",
+	            passes,
+	            mappedSeconds,
+	            parsed / mappedSeconds,
+	            legacySeconds / mappedSeconds);
+	std::printf("hash %016llx\n", static_cast<unsigned long long>(mapped.hash));
+
+	bool same = legacy.hash == mapped.hash && legacy.bulks == mapped.bulks && legacy.errors == mapped.errors;
+	if (!same)
+	{
+		std::printf("The legacy parser gave different output, hash %016llx\n",
+		            static_cast<unsigned long long>(legacy.hash));
+		return 2;
+	}
+	return mapped.errors > 0 ? 2 : 0;
+}
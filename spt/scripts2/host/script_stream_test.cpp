@@ -0,0 +1,213 @@
+// Checks that ScriptStream generates the same afterframes entries in the same order as the parsed script used to
+// queue them: every entry of the frame ops and the savestate saves in one list, cut at the savestate the script is
+// loaded from and stably sorted by tick. Random scripts are compared against that, along with GetCount.
+//
+// Usage: script_stream_test [scripts], returns 1 if a check failed
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "framebulk_handler2.hpp"
+#include "script_stream2.hpp"
+
+using namespace scripts2;
+
+namespace
+{
+	int failures = 0;
+
+#define CHECK(condition) \
+	do \
+	{ \
+		if (!(condition)) \
+		{ \
+			std::printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+			++failures; \
+		} \
+	} while (0)
+
+	typedef std::vector<std::pair<int, std::string>> Entries;
+
+	struct Script
+	{
+		std::shared_ptr<CompiledFrames> frames = std::make_shared<CompiledFrames>();
+		std::vector<SaveLoadCommands> saveLoads;
+		std::vector<SaveEntry> saveEntries;
+		std::vector<int> savestateTicks;
+	};
+
+	uint32_t AddString(CompiledFrames& frames, const std::string& str)
+	{
+		frames.strings.push_back(str);
+		return static_cast<uint32_t>(frames.strings.size() - 1);
+	}
+
+	Script MakeScript(std::mt19937& rng, int ops)
+	{
+		Script script;
+		auto& frames = *script.frames;
+		int tick = 0;
+
+		for (int i = 0; i < ops; ++i)
+		{
+			int kind = std::uniform_int_distribution<int>(0, 9)(rng);
+			std::string name = std::to_string(i);
+			if (kind < 6)
+			{
+				int ticks = std::uniform_int_distribution<int>(0, 3)(rng);
+				uint32_t initial = AddString(frames, "init " + name);
+				uint32_t repeating = AddString(frames, "repeat " + name);
+				frames.ops.push_back(FrameOp{FrameOpType::Bulk, tick, ticks, initial, repeating, i});
+				tick += ticks;
+			}
+			else if (kind == 6)
+			{
+				uint32_t initial = AddString(frames, "load init " + name);
+				uint32_t repeating = AddString(frames, "load repeat " + name);
+				const int LOAD = NO_AFTERFRAMES_BULK;
+				frames.ops.push_back(FrameOp{FrameOpType::Bulk, LOAD, LOAD, initial, repeating, i});
+			}
+			else if (kind == 7)
+			{
+				SaveLoadCommands commands;
+				commands.save = "saveload " + name;
+				if (rng() % 2)
+					commands.record = "record " + name;
+				script.saveLoads.push_back(commands);
+				frames.ops.push_back(FrameOp{FrameOpType::SaveLoad, tick, 1, 0, 0, i});
+				++tick;
+			}
+			else
+			{
+				// Savestates that don't exist yet get a save
+				script.savestateTicks.push_back(tick);
+				if (rng() % 2)
+					script.saveEntries.push_back(SaveEntry{tick, "save " + name});
+				frames.ops.push_back(FrameOp{FrameOpType::SaveState, tick, 0, 0, 0, i});
+			}
+		}
+
+		return script;
+	}
+
+	// What ParsedScript did before the entries were streamed
+	Entries Expected(const Script& script, bool fromSavestate, int startTick)
+	{
+		auto& frames = *script.frames;
+		Entries entries;
+		size_t saveLoad = 0;
+
+		for (auto& op : frames.ops)
+		{
+			if (op.type == FrameOpType::Bulk)
+			{
+				entries.emplace_back(op.tick, frames.strings[op.initialCommand]);
+				entries.emplace_back(op.tick, frames.strings[op.repeatingCommand]);
+			}
+			else if (op.type == FrameOpType::SaveLoad)
+			{
+				auto& commands = script.saveLoads[saveLoad++];
+				entries.emplace_back(op.tick, commands.save);
+				if (!commands.record.empty())
+					entries.emplace_back(op.tick + 1, commands.record);
+			}
+		}
+		for (auto& save : script.saveEntries)
+			entries.emplace_back(save.tick, save.command);
+
+		if (fromSavestate)
+		{
+			Entries kept;
+			for (auto& entry : entries)
+			{
+				if (entry.first >= startTick)
+					kept.emplace_back(entry.first - startTick, entry.second);
+			}
+			entries = kept;
+		}
+
+		std::stable_sort(entries.begin(),
+		                 entries.end(),
+		                 [](const std::pair<int, std::string>& a, const std::pair<int, std::string>& b)
+		                 { return a.first < b.first; });
+		return entries;
+	}
+
+	Entries Streamed(const Script& script, bool fromSavestate, int startTick, size_t& count)
+	{
+		int firstTick = fromSavestate ? startTick : NO_AFTERFRAMES_BULK;
+		int offset = fromSavestate ? startTick : 0;
+		ScriptStream stream(script.frames, script.saveLoads, script.saveEntries, firstTick, offset);
+		count = stream.GetCount();
+
+		Entries entries;
+		afterframes_stream_entry_t entry;
+		while (stream.Next(entry))
+			entries.emplace_back(entry.framesLeft, *entry.command);
+		return entries;
+	}
+
+	void Compare(const Script& script, bool fromSavestate, int startTick)
+	{
+		size_t count;
+		Entries expected = Expected(script, fromSavestate, startTick);
+		Entries streamed = Streamed(script, fromSavestate, startTick, count);
+
+		CHECK(count == expected.size());
+		CHECK(streamed.size() == expected.size());
+		for (size_t i = 0; i < std::min(streamed.size(), expected.size()); ++i)
+		{
+			if (streamed[i] != expected[i])
+			{
+				std::printf("entry %u: expected %d \"%s\", got %d \"%s\"\n",
+				            static_cast<unsigned>(i),
+				            expected[i].first,
+				            expected[i].second.c_str(),
+				            streamed[i].first,
+				            streamed[i].second.c_str());
+				++failures;
+				break;
+			}
+		}
+	}
+
+	void TestEmpty()
+	{
+		Script script;
+		Compare(script, false, 0);
+		Compare(script, true, 0);
+	}
+
+	void TestRandom(int scripts)
+	{
+		std::mt19937 rng(1234);
+		for (int i = 0; i < scripts && failures == 0; ++i)
+		{
+			Script script = MakeScript(rng, std::uniform_int_distribution<int>(1, 60)(rng));
+			Compare(script, false, 0);
+			for (int tick : script.savestateTicks)
+				Compare(script, true, tick);
+		}
+	}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+	int scripts = argc > 1 ? std::atoi(argv[1]) : 2000;
+
+	TestEmpty();
+	TestRandom(scripts);
+
+	if (failures)
+	{
+		std::printf("%d checks failed\n", failures);
+		return 1;
+	}
+	std::printf("all checks passed\n");
+	return 0;
+}
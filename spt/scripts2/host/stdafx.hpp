@@ -0,0 +1,3 @@
+#pragma once
+
+// The host build has no precompiled header, this stands in for spt\utils\stdafx.hpp
@@ -0,0 +1,229 @@
+// Checks that a .tdb trace comes back unchanged after Save and Load, that Load rejects files whose checkpoints don't
+// match the tick data, and, with Python, that Tests/trace_tool.py accepts the files and its diverge command reports
+// the first tick where two traces differ.
+//
+// Usage: trace_test [python trace_tool.py], returns 1 if a check failed
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "trace2.hpp"
+
+#ifdef _WIN32
+#define popen _popen
+#define pclose _pclose
+#endif
+
+namespace fs = std::filesystem;
+using scripts2::TRACKER_VALUES;
+using scripts2::TraceData;
+
+namespace
+{
+	int failures = 0;
+
+#define CHECK(condition) \
+	do \
+	{ \
+		if (!(condition)) \
+		{ \
+			std::printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+			++failures; \
+		} \
+	} while (0)
+
+	const uint32_t TRACKERS = 3;
+	const int TICKS = 300; // four full checkpoint blocks and a partial one
+
+	TraceData MakeTrace(int ticks)
+	{
+		TraceData trace;
+		trace.Clear();
+		trace.trackerCount = TRACKERS;
+
+		float values[TRACKERS * TRACKER_VALUES];
+		for (int tick = 0; tick < ticks; ++tick)
+		{
+			for (uint32_t i = 0; i < TRACKERS * TRACKER_VALUES; ++i)
+				values[i] = tick * 0.5f + i * 100.25f;
+			trace.AddTick(tick, values);
+		}
+		return trace;
+	}
+
+	// The same trace with one value changed from the given tick record on
+	TraceData MakeDiverged(int ticks, int from)
+	{
+		TraceData trace = MakeTrace(from);
+		float values[TRACKERS * TRACKER_VALUES];
+		for (int tick = from; tick < ticks; ++tick)
+		{
+			for (uint32_t i = 0; i < TRACKERS * TRACKER_VALUES; ++i)
+				values[i] = tick * 0.5f + i * 100.25f;
+			values[TRACKER_VALUES + 1] += 0.125f;
+			trace.AddTick(tick, values);
+		}
+		return trace;
+	}
+
+	std::vector<char> ReadBytes(const fs::path& path)
+	{
+		std::ifstream is(path, std::ios::binary);
+		return std::vector<char>(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+	}
+
+	void WriteBytes(const fs::path& path, const std::vector<char>& bytes)
+	{
+		std::ofstream os(path, std::ios::binary | std::ios::trunc);
+		os.write(bytes.data(), bytes.size());
+	}
+
+	void TestRoundTrip(const fs::path& dir)
+	{
+		TraceData trace = MakeTrace(TICKS);
+		fs::path path = dir / "round_trip.tdb";
+		CHECK(trace.Save(path.string()));
+
+		TraceData loaded;
+		CHECK(loaded.Load(path.string()));
+		CHECK(loaded.trackerCount == TRACKERS);
+		CHECK(loaded.checkpointInterval == trace.checkpointInterval);
+		CHECK(loaded.ticks == trace.ticks);
+		CHECK(loaded.values == trace.values);
+
+		fs::path again = dir / "round_trip_again.tdb";
+		CHECK(loaded.Save(again.string()));
+		CHECK(ReadBytes(path) == ReadBytes(again));
+
+		// An empty trace is valid too
+		TraceData empty = MakeTrace(0);
+		fs::path emptyPath = dir / "empty.tdb";
+		CHECK(empty.Save(emptyPath.string()));
+		CHECK(loaded.Load(emptyPath.string()));
+		CHECK(loaded.ticks.empty());
+	}
+
+	void TestVerify(const fs::path& dir)
+	{
+		fs::path path = dir / "verify.tdb";
+		CHECK(MakeTrace(TICKS).Save(path.string()));
+		std::vector<char> bytes = ReadBytes(path);
+
+		const size_t header = 5 * sizeof(uint32_t);
+		const size_t tickSize = sizeof(int32_t) + TRACKERS * TRACKER_VALUES * sizeof(float);
+		TraceData loaded;
+
+		// A changed value no longer matches its checkpoint
+		std::vector<char> changed = bytes;
+		changed[header + 10 * tickSize + sizeof(int32_t)] ^= 1;
+		WriteBytes(path, changed);
+		CHECK(!loaded.Load(path.string()));
+
+		// So does a changed checkpoint
+		changed = bytes;
+		changed[bytes.size() - 1] ^= 1;
+		WriteBytes(path, changed);
+		CHECK(!loaded.Load(path.string()));
+
+		// A value after the last checkpoint isn't covered by one, but the file is still cut short
+		changed.assign(bytes.begin(), bytes.end() - sizeof(uint64_t));
+		WriteBytes(path, changed);
+		CHECK(!loaded.Load(path.string()));
+
+		changed = bytes;
+		changed[0] = 'X';
+		WriteBytes(path, changed);
+		CHECK(!loaded.Load(path.string()));
+
+		WriteBytes(path, bytes);
+		CHECK(loaded.Load(path.string()));
+	}
+
+	std::string Run(const std::string& command, int& status)
+	{
+		std::string output;
+		FILE* pipe = popen(command.c_str(), "r");
+		if (!pipe)
+		{
+			status = -1;
+			return output;
+		}
+
+		char buffer[256];
+		while (std::fgets(buffer, sizeof(buffer), pipe))
+			output += buffer;
+		status = pclose(pipe);
+		return output;
+	}
+
+	std::string Quote(const std::string& arg)
+	{
+		return "\"" + arg + "\"";
+	}
+
+	void TestTraceTool(const fs::path& dir, const char* python, const char* tool)
+	{
+		std::string prefix = Quote(python) + " " + Quote(tool) + " ";
+		fs::path base = dir / "base.tdb";
+		CHECK(MakeTrace(TICKS).Save(base.string()));
+
+		int status;
+		std::string output = Run(prefix + "verify " + Quote(base.string()), status);
+		CHECK(status == 0);
+		CHECK(output.find("ok, 300 ticks") != std::string::npos);
+
+		output = Run(prefix + "diverge " + Quote(base.string()) + " " + Quote(base.string()), status);
+		CHECK(status == 0);
+		CHECK(output.find("Traces are identical, 300 ticks") != std::string::npos);
+
+		// The first tick, inside a block, on a block boundary and in the partial block after the last
+		// checkpoint
+		for (int from : {0, 37, 64, 191, 256, 299})
+		{
+			fs::path diverged = dir / ("diverged_" + std::to_string(from) + ".tdb");
+			CHECK(MakeDiverged(TICKS, from).Save(diverged.string()));
+
+			std::string paths = Quote(base.string()) + " " + Quote(diverged.string());
+			output = Run(prefix + "diverge " + paths, status);
+			std::string expected = "First divergence at tick " + std::to_string(from) + "\n";
+			if (output.find(expected) == std::string::npos)
+			{
+				std::printf("diverging from tick %d: %s", from, output.c_str());
+				++failures;
+			}
+		}
+
+		fs::path shorter = dir / "shorter.tdb";
+		CHECK(MakeTrace(200).Save(shorter.string()));
+		output = Run(prefix + "diverge " + Quote(base.string()) + " " + Quote(shorter.string()), status);
+		CHECK(output.find("identical for 200 ticks") != std::string::npos);
+	}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+	fs::path dir = fs::temp_directory_path() / "spt_trace_test";
+	fs::create_directories(dir);
+
+	TestRoundTrip(dir);
+	TestVerify(dir);
+	if (argc > 2)
+		TestTraceTool(dir, argv[1], argv[2]);
+	else
+		std::printf("No Python given, trace_tool.py isn't checked\n");
+
+	std::error_code ec;
+	fs::remove_all(dir, ec);
+
+	if (failures)
+	{
+		std::printf("%d checks failed\n", failures);
+		return 1;
+	}
+	std::printf("all checks passed\n");
+	return 0;
+}
@@ -4,7 +4,6 @@
 #include "parsed_script2.hpp"
 #include "..\features\demo.hpp"
 #include "..\spt-serverplugin.hpp"
-#include "thirdparty\md5.hpp"
 
 extern ConVar tas_script_savestates;
 
@@ -26,15 +25,15 @@ namespace scripts2
 	{
 		if (output.ticks >= 0)
 		{
-			AddAfterFramesEntry(afterFramesTick, output.initialCommand);
-			AddAfterFramesEntry(afterFramesTick, output.repeatingCommand);
+			AddEntry(afterFramesTick, output.initialCommand);
+			AddEntry(afterFramesTick, output.repeatingCommand);
 
 			afterFramesTick += output.ticks;
 		}
 		else if (output.ticks == NO_AFTERFRAMES_BULK)
 		{
-			AddAfterFramesEntry(NO_AFTERFRAMES_BULK, output.initialCommand);
-			AddAfterFramesEntry(NO_AFTERFRAMES_BULK, output.repeatingCommand);
+			AddEntry(NO_AFTERFRAMES_BULK, output.initialCommand);
+			AddEntry(NO_AFTERFRAMES_BULK, output.repeatingCommand);
 		}
 		else
 		{
@@ -67,12 +66,16 @@ namespace scripts2
 		}
 
 		++demoCount;
-		AddAfterFramesEntry(afterFramesTick,
-		                    "save " + sName + "; load " + sName + +";  spt_afterframes_await_load");
+		SaveLoadCommands commands;
+		commands.save = "save " + sName + "; load " + sName + +";  spt_afterframes_await_load";
+		AddEntry(afterFramesTick, commands.save);
 		// Only manually record if autorecording isn't available
 		if (!spt_demostuff.Demo_IsAutoRecordingAvailable() && !demoName.empty())
-			AddAfterFramesEntry(afterFramesTick + 1,
-			                    "record " + demoName + "-" + std::to_string(demoCount));
+		{
+			commands.record = "record " + demoName + "-" + std::to_string(demoCount);
+			AddEntry(afterFramesTick + 1, commands.record);
+		}
+		saveLoads.push_back(std::move(commands));
 		++afterFramesTick;
 	}
 
@@ -82,7 +85,13 @@ namespace scripts2
 		scriptName.clear();
 		demoCount = 1;
 		afterFramesTick = 0;
-		afterFramesEntries.clear();
+		entriesHash = MD5();
+		entriesHashStarted = false;
+		entryCount = 0;
+		saveLoads.clear();
+		saveEntries.clear();
+		startTick = 0;
+		fromSavestate = false;
 		saveStateIndexes.clear();
 		initCommand =
 		    "sv_cheats 1; spt_pause 0; spt_afterframes_await_load; spt_afterframes_reset_on_server_activate 0; spt_resetpitchyaw;"
@@ -96,6 +105,7 @@ namespace scripts2
 	{
 		this->scriptName = std::move(name);
 		int saveStateIndex = -1;
+		saveEntries.clear();
 
 		for (size_t i = 0; i < saveStates.size(); ++i)
 		{
@@ -103,35 +113,17 @@ namespace scripts2
 				saveStateIndex = i;
 			else
 			{
-				AddAfterFramesEntry(saveStates[i].tick, "save " + saveStates[i].key);
+				saveEntries.push_back(SaveEntry{saveStates[i].tick, "save " + saveStates[i].key});
 			}
 		}
 
-		if (saveStateIndex != -1)
+		// The stream drops everything before the save, entries on the save's tick run right after the load
+		fromSavestate = saveStateIndex != -1;
+		startTick = 0;
+		if (fromSavestate)
 		{
-			int tick = saveStates[saveStateIndex].tick;
+			startTick = saveStates[saveStateIndex].tick;
 			saveName = saveStates[saveStateIndex].key;
-
-			for (size_t i = 0; i < afterFramesEntries.size(); ++i)
-			{
-				if (afterFramesEntries[i].framesLeft >= tick)
-				{
-					// If the entry is on the same tick as the save, add a new during load entry
-					if (afterFramesEntries[i].framesLeft == tick)
-					{
-						afterframes_entry_t copy = afterFramesEntries[i];
-						copy.framesLeft = NO_AFTERFRAMES_BULK;
-						afterFramesEntries.push_back(copy);
-					}
-
-					afterFramesEntries[i].framesLeft -= tick;
-				}
-				else
-				{
-					afterFramesEntries.erase(afterFramesEntries.begin() + i);
-					--i;
-				}
-			}
 		}
 
 		if (!saveName.empty())
@@ -144,9 +136,30 @@ namespace scripts2
 		demoName = std::move(name);
 	}
 
-	void ParsedScript::AddAfterFramesEntry(long long int tick, std::string command)
+	std::unique_ptr<AfterframesStream> ParsedScript::CreateStream(
+	    std::shared_ptr<const CompiledFrames> frames) const
+	{
+		// Without a savestate nothing is dropped, not even the bulks that run during loads
+		int firstTick = fromSavestate ? startTick : NO_AFTERFRAMES_BULK;
+		return std::make_unique<ScriptStream>(std::move(frames), saveLoads, saveEntries, firstTick, startTick);
+	}
+
+	void ParsedScript::StartEntriesHash()
 	{
-		afterFramesEntries.emplace_back(tick, std::move(command));
+		if (entriesHashStarted)
+			return;
+
+		entriesHash.update(saveName.data(), static_cast<MD5::size_type>(saveName.size()));
+		entriesHashStarted = true;
+	}
+
+	void ParsedScript::AddEntry(int tick, const std::string& command)
+	{
+		StartEntriesHash();
+		std::string ticks = std::to_string(tick);
+		entriesHash.update(ticks.data(), static_cast<MD5::size_type>(ticks.size()));
+		entriesHash.update(command.data(), static_cast<MD5::size_type>(command.size()));
+		++entryCount;
 	}
 
 	void ParsedScript::SetSave(std::string save)
@@ -157,20 +170,12 @@ namespace scripts2
 
 	Savestate ParsedScript::GetSaveStateInfo()
 	{
-		std::string data = saveName;
-
-		for (auto& entry : afterFramesEntries)
-		{
-			data += std::to_string(entry.framesLeft);
-			data += entry.command;
-		}
-
-		MD5 hash(data);
-		std::string digest = hash.hexdigest();
+		// Same key as hashing the initial save and every entry so far in one go
+		StartEntriesHash();
+		MD5 hash = entriesHash;
+		std::string digest = hash.finalize().hexdigest();
 
-		return Savestate(afterFramesTick,
-		                 afterFramesEntries.size(),
-		                 "ss-" + digest + "-" + std::to_string(afterFramesTick));
+		return Savestate(afterFramesTick, entryCount, "ss-" + digest + "-" + std::to_string(afterFramesTick));
 	}
 
 	Savestate::Savestate(int tick, int index, std::string key) : tick(tick), index(index), key(std::move(key))
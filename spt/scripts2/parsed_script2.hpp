@@ -1,6 +1,8 @@
 #pragma once
 
-#include "..\features\afterframes.hpp"
+#include "script_stream2.hpp"
+#include "thirdparty\md5.hpp"
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -21,12 +23,15 @@ namespace scripts2
 		void TestExists();
 	};
 
+	/*
+	* What a script does besides its frame bulks. The afterframes entries of the frame bulks aren't kept, they only
+	* go into the savestate keys. CreateStream generates them again from the compiled frames while the script plays.
+	*/
 	class ParsedScript
 	{
 	public:
 		std::string initCommand;
 		std::string duringLoad;
-		std::vector<afterframes_entry_t> afterFramesEntries;
 		std::vector<int> saveStateIndexes;
 
 		void Reset();
@@ -42,8 +47,9 @@ namespace scripts2
 		void AddFrameBulk(FrameBulkOutput& output);
 		void AddSaveState();
 		void AddSaveLoad();
-		void AddAfterFramesEntry(long long int tick, std::string command);
 		void SetSave(std::string save);
+		// The afterframes entries of the frames the script was parsed from, call after Init
+		std::unique_ptr<AfterframesStream> CreateStream(std::shared_ptr<const CompiledFrames> frames) const;
 		int GetScriptLength()
 		{
 			return afterFramesTick;
@@ -55,6 +61,17 @@ namespace scripts2
 		std::string saveName;
 		std::string scriptName;
 		int afterFramesTick;
+		// Every entry so far, in the order they were added, hashed after the initial save
+		MD5 entriesHash;
+		bool entriesHashStarted;
+		int entryCount;
+		std::vector<SaveLoadCommands> saveLoads;
+		std::vector<SaveEntry> saveEntries;
+		int startTick; // of the savestate the script is loaded from
+		bool fromSavestate;
+
+		void AddEntry(int tick, const std::string& command);
+		void StartEntriesHash();
 		Savestate GetSaveStateInfo();
 		std::vector<Savestate> saveStates;
 	};
@@ -0,0 +1,64 @@
+#pragma once
+#include <string>
+#include <string_view>
+
+namespace scripts2
+{
+	/*
+	* Splits the contents of a script into lines the same way std::getline does, a trailing newline gives one more
+	* empty line. Carriage returns at the end of a line are dropped.
+	*/
+	class ScriptLines
+	{
+	public:
+		void Reset(std::string_view contents)
+		{
+			this->contents = contents;
+			Rewind();
+		}
+		void Rewind()
+		{
+			pos = 0;
+			done = false;
+		}
+		// Skips the rest of the lines
+		void Finish()
+		{
+			done = true;
+		}
+		bool IsDone() const
+		{
+			return done;
+		}
+		std::string_view GetContents() const
+		{
+			return contents;
+		}
+
+		// The line buffer is reused so reading a line doesn't allocate once it's grown big enough
+		bool Next(std::string& line)
+		{
+			if (done)
+				return false;
+
+			size_t end = contents.find('\n', pos);
+			if (end == std::string_view::npos)
+			{
+				end = contents.size();
+				done = true;
+			}
+
+			size_t length = end - pos;
+			if (length > 0 && contents[end - 1] == '\r')
+				--length;
+			line.assign(contents.substr(pos, length));
+			pos = end + 1;
+			return true;
+		}
+
+	private:
+		std::string_view contents;
+		size_t pos = 0;
+		bool done = true;
+	};
+} // namespace scripts2
@@ -0,0 +1,122 @@
+#include "stdafx.hpp"
+#include "script_stream2.hpp"
+#include "framebulk_handler2.hpp"
+
+namespace scripts2
+{
+	ScriptStream::ScriptStream(std::shared_ptr<const CompiledFrames> frames,
+	                           std::vector<SaveLoadCommands> saveLoads,
+	                           std::vector<SaveEntry> saveEntries,
+	                           int firstTick,
+	                           int offset)
+	    : frames(std::move(frames))
+	    , saveLoads(std::move(saveLoads))
+	    , saveEntries(std::move(saveEntries))
+	    , firstTick(firstTick)
+	    , offset(offset)
+	{
+	}
+
+	bool ScriptStream::PeekOpEntry(int& tick, const std::string*& command)
+	{
+		auto& ops = frames->ops;
+
+		while (true)
+		{
+			if (opIndex >= ops.size())
+			{
+				if (loadBulksDone)
+					return false;
+
+				loadBulksDone = true;
+				opIndex = 0;
+				opEntry = 0;
+				saveLoadIndex = 0;
+				continue;
+			}
+
+			auto& op = ops[opIndex];
+			bool loadBulk = op.type == FrameOpType::Bulk && op.tick == NO_AFTERFRAMES_BULK;
+
+			if (opEntry < 2 && op.type != FrameOpType::SaveState && loadBulk != loadBulksDone)
+			{
+				if (op.type == FrameOpType::Bulk)
+				{
+					tick = op.tick;
+					uint32_t index = opEntry == 0 ? op.initialCommand : op.repeatingCommand;
+					command = &frames->strings[index];
+					return true;
+				}
+
+				auto& commands = saveLoads[saveLoadIndex];
+				if (opEntry == 0)
+				{
+					tick = op.tick;
+					command = &commands.save;
+					return true;
+				}
+				if (!commands.record.empty())
+				{
+					tick = op.tick + 1;
+					command = &commands.record;
+					return true;
+				}
+			}
+
+			if (op.type == FrameOpType::SaveLoad && loadBulksDone)
+				++saveLoadIndex;
+			++opIndex;
+			opEntry = 0;
+		}
+	}
+
+	void ScriptStream::SkipOpEntry()
+	{
+		++opEntry;
+	}
+
+	bool ScriptStream::Next(afterframes_stream_entry_t& entry)
+	{
+		while (true)
+		{
+			int tick;
+			const std::string* command;
+			bool fromOps = PeekOpEntry(tick, command);
+
+			// Saves go after the other entries of their tick, they were added after the frames were parsed
+			if (loadBulksDone && saveEntryIndex < saveEntries.size()
+			    && (!fromOps || saveEntries[saveEntryIndex].tick < tick))
+			{
+				auto& save = saveEntries[saveEntryIndex++];
+				tick = save.tick;
+				command = &save.command;
+			}
+			else if (fromOps)
+			{
+				SkipOpEntry();
+			}
+			else
+			{
+				return false;
+			}
+
+			if (tick < firstTick)
+				continue;
+
+			entry.framesLeft = tick - offset;
+			entry.command = command;
+			return true;
+		}
+	}
+
+	size_t ScriptStream::GetCount() const
+	{
+		ScriptStream copy(*this);
+		afterframes_stream_entry_t entry;
+		size_t count = 0;
+		while (copy.Next(entry))
+			++count;
+
+		return count;
+	}
+} // namespace scripts2
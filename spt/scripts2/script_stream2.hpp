@@ -0,0 +1,60 @@
+#pragma once
+
+#include "afterframes_stream.hpp"
+#include "compiled_script2.hpp"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace scripts2
+{
+	// The commands of a save/load bulk, record is empty if demos are recorded automatically
+	struct SaveLoadCommands
+	{
+		std::string save;
+		std::string record;
+	};
+
+	// Saves the savestate that is made on the tick, for savestates that don't exist yet
+	struct SaveEntry
+	{
+		int tick;
+		std::string command;
+	};
+
+	/*
+	* Generates the afterframes entries of a script from its compiled frames while it plays, so besides the compiled
+	* frames only a cursor into them is kept. The entries come out in the order the whole script used to be queued
+	* in: the bulks that run during loads first, then by tick, with the saves of new savestates after the other
+	* entries of their tick. Entries before firstTick are dropped and the rest are moved offset ticks earlier.
+	*/
+	class ScriptStream : public AfterframesStream
+	{
+	public:
+		ScriptStream(std::shared_ptr<const CompiledFrames> frames,
+		             std::vector<SaveLoadCommands> saveLoads,
+		             std::vector<SaveEntry> saveEntries,
+		             int firstTick,
+		             int offset);
+
+		virtual bool Next(afterframes_stream_entry_t& entry) override;
+		virtual size_t GetCount() const override;
+
+	private:
+		// Returns the next entry of the frame ops without moving past it
+		bool PeekOpEntry(int& tick, const std::string*& command);
+		void SkipOpEntry();
+
+		std::shared_ptr<const CompiledFrames> frames;
+		std::vector<SaveLoadCommands> saveLoads;
+		std::vector<SaveEntry> saveEntries;
+		int firstTick;
+		int offset;
+
+		bool loadBulksDone = false; // the bulks that run during loads are gone through first
+		size_t opIndex = 0;
+		int opEntry = 0; // bulks and save/loads have two entries each
+		size_t saveLoadIndex = 0;
+		size_t saveEntryIndex = 0;
+	};
+} // namespace scripts2
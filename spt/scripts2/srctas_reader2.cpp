@@ -1,5 +1,6 @@
 #include "stdafx.hpp"
 
+#include "compiled_script2.hpp"
 #include "file.hpp"
 #include "framebulk_handler2.hpp"
 #include "game_detection.hpp"
@@ -15,6 +16,7 @@
 #include "..\sptlib-wrapper.hpp"
 
 extern ConVar tas_script_onsuccess;
+extern ConVar tas_script_stream_window;
 extern ConVar y_spt_gamedir;
 
 namespace scripts2
@@ -25,6 +27,7 @@ namespace scripts2
 	const char* RESET_VARS[] = {"cl_forwardspeed", "cl_sidespeed", "cl_yawspeed"};
 
 	const int RESET_VARS_COUNT = ARRAYSIZE(RESET_VARS);
+	const size_t MAX_CACHED_BULKS = 65536;
 
 	SourceTASReader::SourceTASReader()
 	{
@@ -92,6 +95,7 @@ namespace scripts2
 	LoadResult SourceTASReader::CommonExecuteScript(bool search) 
 	{
 		LoadResult result = LoadResult::Success;
+		searching = search;
 		try
 		{
 			DevMsg("Attempting to parse a version 2 TAS script...\n");
@@ -103,10 +107,12 @@ namespace scripts2
 #endif
 
 			std::string gameDir = GetGameDir();
-			scriptStream.open(gameDir + "\\" + fileName + SCRIPT_EXT);
-
-			if (!scriptStream.is_open())
+			if (!scriptFile.Open(gameDir + "\\" + fileName + SCRIPT_EXT))
 				throw std::exception("File does not exist");
+
+			// Lines are read straight from the mapping, the contents are also used to check whether the compiled
+			// frames are still valid
+			scriptLines.Reset(scriptFile.GetContents());
 			auto propResult = ParseProps();
 
 			if (propResult == LoadResult::V1Script)
@@ -120,7 +126,7 @@ namespace scripts2
 				else if (!search && searchType != SearchType::None)
 					throw std::exception("Not in search mode but search property is set");
 
-				while (!scriptStream.eof())
+				while (!scriptLines.IsDone())
 				{
 					if (IsFramesLine())
 						ParseFrames();
@@ -150,7 +156,8 @@ namespace scripts2
 			result = LoadResult::Error;
 		}
 
-		scriptStream.close();
+		scriptLines.Reset(std::string_view());
+		scriptFile.Close();
 		return result;
 	}
 
@@ -209,10 +216,9 @@ namespace scripts2
 		currentTick = 0;
 		currentScript.Init(fileName);
 
-		for (auto& entry : currentScript.afterFramesEntries)
-		{
-			spt_afterframes.AddAfterFramesEntry(entry);
-		}
+		// Long scripts are only queued a window of ticks ahead
+		spt_afterframes.SetAfterFramesStream(currentScript.CreateStream(compiledFrames),
+		                                     std::max(tas_script_stream_window.GetInt(), 0));
 	}
 
 	void SourceTASReader::SetFpsAndPlayspeed()
@@ -226,12 +232,11 @@ namespace scripts2
 
 	bool SourceTASReader::ParseLine()
 	{
-		if (!scriptStream.good())
+		if (!scriptLines.Next(line))
 		{
 			return false;
 		}
 
-		std::getline(scriptStream, line);
 		SetNewLine();
 
 		return true;
@@ -245,13 +250,14 @@ namespace scripts2
 			line.erase(end);
 
 		ReplaceVariables();
-		lineStream.str(line);
-		lineStream.clear();
 		++currentLine;
 	}
 
 	void SourceTASReader::ReplaceVariables()
 	{
+		if (line.find('[') == std::string::npos)
+			return;
+
 		for (auto& variable : variables.variableMap)
 		{
 			ReplaceAll(line, GetVarIdentifier(variable.first), variable.second.GetValue());
@@ -321,7 +327,7 @@ namespace scripts2
 	{
 		ResetConvars();
 		conditions.clear();
-		scriptStream.clear();
+		scriptLines.Rewind();
 		lineStream.clear();
 		line.clear();
 		currentLine = 0;
@@ -369,6 +375,8 @@ namespace scripts2
 
 		std::string prop;
 		std::string value;
+		lineStream.str(line);
+		lineStream.clear();
 		GetDoublet(lineStream, prop, value, ' ');
 
 		if (propertyHandlers.find(prop) != propertyHandlers.end())
@@ -409,16 +417,52 @@ namespace scripts2
 		std::string type;
 		std::string name;
 		std::string value;
+		lineStream.str(line);
+		lineStream.clear();
 		GetTriplet(lineStream, type, name, value, ' ');
 		variables.AddNewVariable(type, name, value);
 	}
 
 	void SourceTASReader::ParseFrames()
 	{
-		while (ParseLine())
+		std::string key = GetCompiledScriptKey(scriptLines.GetContents(), variables);
+		std::string compiledPath = GetGameDir() + "\\" + fileName + COMPILED_SCRIPT_EXT;
+
+		// The stream of the last run can still be reading the old frames, so they're replaced instead of changed
+		if (!compiledFrames || compiledFrames->key != key)
+		{
+			auto frames = std::make_shared<CompiledFrames>();
+			if (!frames->Load(compiledPath, key))
+				frames->Clear();
+			compiledFrames = std::move(frames);
+		}
+
+		if (compiledFrames->key == key)
 		{
-			ParseFrameBulk();
+			// The frames section is the rest of the file
+			scriptLines.Finish();
+			DevMsg("Using the compiled frames of %s\n", fileName.c_str());
+		}
+		else
+		{
+			if (bulkCacheFile != fileName || bulkCache.size() > MAX_CACHED_BULKS)
+			{
+				bulkCache.clear();
+				bulkCacheFile = fileName;
+			}
+
+			while (ParseLine())
+			{
+				ParseFrameBulk();
+			}
+			compiledFrames->key = key;
+
+			// Search iterations change the variables every time, there's no point in writing those out
+			if (!searching && !compiledFrames->Save(compiledPath))
+				DevWarning("Unable to write compiled script %s\n", compiledPath.c_str());
 		}
+
+		ApplyCompiledFrames();
 	}
 
 	void SourceTASReader::ParseFrameBulk()
@@ -429,18 +473,53 @@ namespace scripts2
 		}
 		else if (line.find("ss") == 0)
 		{
-			currentScript.AddSaveState();
+			compiledFrames->AddSaveState(currentLine);
 		}
 		else if (line.find("sl") == 0)
 		{
-			currentScript.AddSaveLoad();
+			compiledFrames->AddSaveLoad(currentLine);
 		}
 		else
 		{
-			FrameBulkInfo info(lineStream);
+			auto cached = bulkCache.find(line);
+			if (cached != bulkCache.end())
+			{
+				compiledFrames->AddBulk(*cached->second, currentLine);
+				return;
+			}
+
+			FrameBulkInfo info(line);
 			auto output = HandleFrameBulk(info);
 
-			currentScript.AddFrameBulk(output);
+			compiledFrames->AddBulk(output, currentLine);
+			bulkCache.emplace(line, std::make_unique<FrameBulkOutput>(std::move(output)));
+		}
+	}
+
+	void SourceTASReader::ApplyCompiledFrames()
+	{
+		for (auto& op : compiledFrames->ops)
+		{
+			currentLine = op.line;
+
+			switch (op.type)
+			{
+			case FrameOpType::Bulk:
+			{
+				FrameBulkOutput output;
+				output.initialCommand = compiledFrames->strings[op.initialCommand];
+				output.repeatingCommand = compiledFrames->strings[op.repeatingCommand];
+				output.ticks = op.ticks;
+				currentScript.AddFrameBulk(output);
+				break;
+			}
+			case FrameOpType::SaveState:
+				currentScript.AddSaveState();
+				break;
+			case FrameOpType::SaveLoad:
+				currentScript.AddSaveLoad();
+				break;
+			}
 		}
 	}
 
@@ -1,18 +1,25 @@
 #pragma once
 #include <fstream>
 #include <map>
+#include <memory>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 
+#include "compiled_script2.hpp"
 #include "condition2.hpp"
+#include "mapped_file.hpp"
 #include "parsed_script2.hpp"
 #include "range_variable2.hpp"
+#include "script_lines2.hpp"
 #include "variable_container2.hpp"
 
 namespace scripts2
 {
 	extern const std::string SCRIPT_EXT;
 	enum class LoadResult { V1Script, Success, Error };
+	struct FrameBulkOutput;
 
 	class SourceTASReader
 	{
@@ -30,8 +37,10 @@ namespace scripts2
 	private:
 		bool iterationFinished;
 		bool freezeVariables;
+		bool searching;
 		std::string fileName;
-		std::ifstream scriptStream;
+		MappedFile scriptFile;
+		ScriptLines scriptLines;
 		std::istringstream lineStream;
 		std::string line;
 		int currentLine;
@@ -43,6 +52,11 @@ namespace scripts2
 
 		VariableContainer variables;
 		ParsedScript currentScript;
+		std::shared_ptr<CompiledFrames> compiledFrames;
+		// Parsed frame bulks by their line after variable replacement, so search iterations only parse the
+		// bulks whose variables changed
+		std::unordered_map<std::string, std::unique_ptr<FrameBulkOutput>> bulkCache;
+		std::string bulkCacheFile;
 		std::map<std::string, void (SourceTASReader::*)(const std::string&)> propertyHandlers;
 		std::vector<std::unique_ptr<Condition>> conditions;
 
@@ -118,6 +132,7 @@ namespace scripts2
 
 		void ParseFrames();
 		void ParseFrameBulk();
+		void ApplyCompiledFrames();
 
 		bool isLineEmpty();
 		bool IsFramesLine();
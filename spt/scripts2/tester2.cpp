@@ -41,7 +41,19 @@ namespace scripts2
 			else
 			{
 				runningTest = true;
-				testItems = GetTestData(TestDataFile(testName));
+
+				// Binary traces validate without parsing text every tick
+				if (FileExists(TraceFile(testName)))
+				{
+					bool loaded = trace.Load(TraceFile(testName));
+					if (!loaded || trace.trackerCount != trackers.size())
+						throw std::exception("Binary test data is invalid");
+					usingTrace = true;
+				}
+				else
+				{
+					testItems = GetTestData(TestDataFile(testName));
+				}
 			}
 
 			g_TASReader.ExecuteScript(testName);
@@ -61,7 +73,8 @@ namespace scripts2
 		if (generating)
 			return FileExists(ScriptFile(testName));
 		else
-			return FileExists(ScriptFile(testName)) && FileExists(TestDataFile(testName));
+			return FileExists(ScriptFile(testName))
+			       && (FileExists(TestDataFile(testName)) || FileExists(TraceFile(testName)));
 	}
 
 	std::string Tester::TestDataFile(const std::string& testName)
@@ -69,6 +82,11 @@ namespace scripts2
 		return GetGameDir() + "\\" + testName + DATA_EXT;
 	}
 
+	std::string Tester::TraceFile(const std::string& testName)
+	{
+		return GetGameDir() + "\\" + testName + TRACE_EXT;
+	}
+
 	std::string Tester::ScriptFile(const std::string& testName)
 	{
 		return GetGameDir() + "\\" + testName + SCRIPT_EXT;
@@ -106,7 +124,10 @@ namespace scripts2
 		{
 			if (runningTest)
 			{
-				TestIteration();
+				if (usingTrace)
+					TraceTestIteration();
+				else
+					TestIteration();
 				++dataTick;
 			}
 			else if (generatingData)
@@ -149,8 +170,38 @@ namespace scripts2
 		}
 	}
 
+	void Tester::TraceTestIteration()
+	{
+		while (currentTraceTick < trace.ticks.size() && trace.ticks[currentTraceTick] < dataTick)
+			++currentTraceTick;
+
+		if (currentTraceTick >= trace.ticks.size() || trace.ticks[currentTraceTick] != dataTick)
+			return;
+
+		const float* values = trace.GetValues(currentTraceTick);
+		for (std::size_t i = 0; i < trackers.size(); ++i)
+		{
+			auto& tracker = trackers[i];
+			auto result = tracker->Validate(values + i * TRACKER_VALUES);
+
+			if (!result.successful)
+			{
+				std::ostringstream oss;
+				oss << "Tracker \"" << tracker->TrackerName() << "\" difference at tick " << dataTick
+				    << " : \"" << result.errorMsg << "\"";
+				throw std::exception(oss.str().c_str());
+			}
+		}
+
+		++currentTraceTick;
+	}
+
 	void Tester::GenerationIteration()
 	{
+		std::vector<float> values(trackers.size() * TRACKER_VALUES);
+		if (trace.ticks.empty())
+			trace.trackerCount = trackers.size();
+
 		for (std::size_t i = 0; i < trackers.size(); ++i)
 		{
 			auto& tracker = trackers[i];
@@ -166,7 +217,10 @@ namespace scripts2
 			}
 
 			testItems.emplace_back(dataTick, i, tracker->GenerateTestData());
+			tracker->GetValues(values.data() + i * TRACKER_VALUES);
 		}
+
+		trace.AddTick(dataTick, values.data());
 	}
 
 	void Tester::TestDone()
@@ -179,6 +233,8 @@ namespace scripts2
 		else
 		{
 			WriteTestDataToFile(testItems, TestDataFile(currentTest));
+			if (!trace.Save(TraceFile(currentTest)))
+				PrintTestMessage("Unable to write the binary test data");
 		}
 
 		if (successfulTest && runningTest)
@@ -235,12 +291,12 @@ namespace scripts2
 		for (auto& entry : std::filesystem::recursive_directory_iterator(folder))
 		{
 			auto& path = entry.path();
-			auto str = path.string().substr(GetGameDir().length() + 1);
-			int extPos = str.find(SCRIPT_EXT);
 
-			if (extPos != -1)
+			// Compiled .srctasc files would match a plain find of the extension
+			if (path.extension() == SCRIPT_EXT)
 			{
-				str = str.substr(0, extPos);
+				auto str = path.string().substr(GetGameDir().length() + 1);
+				str = str.substr(0, str.length() - SCRIPT_EXT.length());
 
 				if (RequiredFilesExist(str, generating))
 				{
@@ -258,6 +314,9 @@ namespace scripts2
 	void Tester::ResetIteration()
 	{
 		testItems.clear();
+		trace.Clear();
+		usingTrace = false;
+		currentTraceTick = 0;
 		currentTestItem = 0;
 		afterFramesTick = 0;
 		dataTick = 0;
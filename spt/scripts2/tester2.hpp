@@ -1,5 +1,6 @@
 #pragma once
 #include "test_item2.hpp"
+#include "trace2.hpp"
 #include "tracker2.hpp"
 #include <fstream>
 #include <string>
@@ -37,12 +38,14 @@ namespace scripts2
 		void LoadTest(const std::string& testName, bool generating, bool automatedTest = false);
 		static bool RequiredFilesExist(const std::string& testName, bool generating);
 		static std::string TestDataFile(const std::string& testName);
+		static std::string TraceFile(const std::string& testName);
 		static std::string ScriptFile(const std::string& testName);
 		static std::string GetFolder(const std::string& testName);
 
 		void OnAfterFrames();
 		void DataIteration();
 		void TestIteration();
+		void TraceTestIteration();
 		void GenerationIteration();
 		void TestDone();
 
@@ -60,6 +63,10 @@ namespace scripts2
 
 		std::map<int, std::unique_ptr<Tracker>> trackers;
 		std::vector<TestItem> testItems;
+		// Used instead of testItems when the test has a binary trace
+		TraceData trace;
+		bool usingTrace;
+		std::size_t currentTraceTick;
 		std::vector<std::string> testNames;
 		std::vector<int> failedTests;
 		std::string currentTest;
@@ -0,0 +1,122 @@
+#include "stdafx.hpp"
+#include "trace2.hpp"
+#include "hash_utils.hpp"
+
+#include <fstream>
+
+namespace scripts2
+{
+	static const uint32_t TRACE_MAGIC = 0x54545053; // "SPTT"
+	static const uint32_t TRACE_VERSION = 1;
+	// Sanity limits so that a corrupt file can't make us allocate gigabytes
+	static const uint32_t MAX_TRACE_TICKS = 16 * 1024 * 1024;
+	static const uint32_t MAX_TRACE_TRACKERS = 64;
+
+	template<typename T>
+	static void Write(std::ofstream& os, const T& value)
+	{
+		os.write(reinterpret_cast<const char*>(&value), sizeof(T));
+	}
+
+	template<typename T>
+	static bool Read(std::ifstream& is, T& value)
+	{
+		return static_cast<bool>(is.read(reinterpret_cast<char*>(&value), sizeof(T)));
+	}
+
+	void TraceData::Clear()
+	{
+		ticks.clear();
+		values.clear();
+		checkpoints.clear();
+		checkpointInterval = DEFAULT_CHECKPOINT_INTERVAL;
+		runningHash = utils::FNV1A_64_OFFSET;
+	}
+
+	void TraceData::AddTick(int32_t tick, const float* tickValues)
+	{
+		if (ticks.empty())
+			runningHash = utils::FNV1A_64_OFFSET;
+
+		ticks.push_back(tick);
+		values.insert(values.end(), tickValues, tickValues + trackerCount * TRACKER_VALUES);
+
+		runningHash = HashTick(ticks.size() - 1, runningHash);
+		if (ticks.size() % checkpointInterval == 0)
+			checkpoints.push_back(runningHash);
+	}
+
+	uint64_t TraceData::HashTick(size_t index, uint64_t hash) const
+	{
+		hash = utils::Fnv1a64(&ticks[index], sizeof(int32_t), hash);
+		return utils::Fnv1a64(GetValues(index), trackerCount * TRACKER_VALUES * sizeof(float), hash);
+	}
+
+	bool TraceData::Load(const std::string& fileName)
+	{
+		std::ifstream is(fileName, std::ios::binary);
+		if (!is.is_open())
+			return false;
+
+		uint32_t magic, version;
+		if (!Read(is, magic) || !Read(is, version) || magic != TRACE_MAGIC || version != TRACE_VERSION)
+			return false;
+
+		Clear();
+		uint32_t tickCount;
+		if (!Read(is, trackerCount) || !Read(is, checkpointInterval) || !Read(is, tickCount)
+		    || trackerCount > MAX_TRACE_TRACKERS || checkpointInterval == 0 || tickCount > MAX_TRACE_TICKS)
+			return false;
+
+		std::vector<float> tickValues(trackerCount * TRACKER_VALUES);
+		for (uint32_t i = 0; i < tickCount; ++i)
+		{
+			int32_t tick;
+			if (!Read(is, tick)
+			    || !is.read(reinterpret_cast<char*>(tickValues.data()), tickValues.size() * sizeof(float)))
+				return false;
+
+			AddTick(tick, tickValues.data());
+		}
+
+		// AddTick recomputed the checkpoints, the stored ones have to match them
+		uint32_t checkpointCount;
+		if (!Read(is, checkpointCount) || checkpointCount != checkpoints.size())
+			return false;
+
+		for (uint64_t expected : checkpoints)
+		{
+			uint64_t hash;
+			if (!Read(is, hash) || hash != expected)
+				return false;
+		}
+
+		return true;
+	}
+
+	bool TraceData::Save(const std::string& fileName) const
+	{
+		std::ofstream os(fileName, std::ios::binary | std::ios::trunc);
+		if (!os.is_open())
+			return false;
+
+		Write(os, TRACE_MAGIC);
+		Write(os, TRACE_VERSION);
+		Write(os, trackerCount);
+		Write(os, checkpointInterval);
+
+		Write(os, static_cast<uint32_t>(ticks.size()));
+		size_t tickSize = trackerCount * TRACKER_VALUES * sizeof(float);
+		for (size_t i = 0; i < ticks.size(); ++i)
+		{
+			Write(os, ticks[i]);
+			os.write(reinterpret_cast<const char*>(GetValues(i)), tickSize);
+		}
+
+		Write(os, static_cast<uint32_t>(checkpoints.size()));
+		for (uint64_t hash : checkpoints)
+			Write(os, hash);
+
+		return os.good();
+	}
+} // namespace scripts2
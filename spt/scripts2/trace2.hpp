@@ -0,0 +1,48 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace scripts2
+{
+	const std::string TRACE_EXT = ".tdb";
+	const int TRACKER_VALUES = 3; // floats every tracker records per tick
+	const uint32_t DEFAULT_CHECKPOINT_INTERVAL = 64;
+
+	/*
+	* Binary version of the .td test data. Every tick stores the raw floats of every tracker, and every
+	* checkpointInterval ticks the file stores a hash of all tick records so far, so two traces can be compared
+	* a block at a time before looking at single ticks. Tests/trace_tool.py reads and writes the same format.
+	*
+	* Layout, little endian:
+	*	char magic[4] "SPTT", uint32 version, uint32 trackerCount, uint32 checkpointInterval
+	*	uint32 tickCount, then per tick: int32 tick, float values[trackerCount * TRACKER_VALUES]
+	*	uint32 checkpointCount, then uint64 hashes
+	*
+	* A checkpoint hash is FNV-1a 64 chained over the tick records (tick and values) from the first tick up to and
+	* including tick number (i + 1) * checkpointInterval - 1.
+	*/
+	class TraceData
+	{
+	public:
+		uint32_t trackerCount = 0;
+		uint32_t checkpointInterval = DEFAULT_CHECKPOINT_INTERVAL;
+		std::vector<int32_t> ticks;
+		std::vector<float> values; // trackerCount * TRACKER_VALUES per tick
+
+		void Clear();
+		void AddTick(int32_t tick, const float* tickValues);
+		const float* GetValues(size_t index) const
+		{
+			return values.data() + index * trackerCount * TRACKER_VALUES;
+		}
+		uint64_t HashTick(size_t index, uint64_t hash) const;
+
+		bool Load(const std::string& fileName);
+		bool Save(const std::string& fileName) const;
+
+	private:
+		std::vector<uint64_t> checkpoints;
+		uint64_t runningHash = 0;
+	};
+} // namespace scripts2
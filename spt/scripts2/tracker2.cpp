@@ -11,13 +11,10 @@ namespace scripts2
 		return std::abs(v.x) <= maxDiff && std::abs(v.y) <= maxDiff && std::abs(v.z) <= maxDiff;
 	}
 
-	ValidationResult VectorValidation(const Vector& current, const std::string& expectedValue, int decimals)
+	ValidationResult VectorValidation(const Vector& current, const Vector& expected, int decimals)
 	{
-		Vector expectedVel;
 		ValidationResult result;
-		GetTriplet<float>(expectedValue, expectedVel.x, expectedVel.y, expectedVel.z, '|');
-
-		Vector diff = current - expectedVel;
+		Vector diff = current - expected;
 		float maxDiff = std::powf(0.1f, decimals);
 
 		if (ValidDiff(diff, maxDiff))
@@ -35,6 +32,33 @@ namespace scripts2
 		return result;
 	}
 
+	ValidationResult VectorValidation(const Vector& current, const std::string& expectedValue, int decimals)
+	{
+		Vector expected;
+		GetTriplet<float>(expectedValue, expected.x, expected.y, expected.z, '|');
+		return VectorValidation(current, expected, decimals);
+	}
+
+	ValidationResult VectorValidation(const Vector& current, const float* expectedValues, int decimals)
+	{
+		Vector expected(expectedValues[0], expectedValues[1], expectedValues[2]);
+		return VectorValidation(current, expected, decimals);
+	}
+
+	void GetVectorValues(const Vector& v, float* out)
+	{
+		out[0] = v.x;
+		out[1] = v.y;
+		out[2] = v.z;
+	}
+
+	static Vector GetViewAngles()
+	{
+		float va[3];
+		EngineGetViewAngles(va);
+		return Vector(va[0], va[1], va[2]);
+	}
+
 	std::string GenerateVectorData(Vector v, int decimals)
 	{
 		std::ostringstream oss;
@@ -55,6 +79,16 @@ namespace scripts2
 		return VectorValidation(spt_playerio.GetPlayerVelocity(), expectedValue, decimals);
 	}
 
+	void VelocityTracker::GetValues(float* out) const
+	{
+		GetVectorValues(spt_playerio.GetPlayerVelocity(), out);
+	}
+
+	ValidationResult VelocityTracker::Validate(const float* expectedValues) const
+	{
+		return VectorValidation(spt_playerio.GetPlayerVelocity(), expectedValues, decimals);
+	}
+
 	std::string VelocityTracker::TrackerName() const
 	{
 		return "velocity";
@@ -75,6 +109,16 @@ namespace scripts2
 		return VectorValidation(spt_playerio.GetPlayerEyePos(), expectedValue, decimals);
 	}
 
+	void PosTracker::GetValues(float* out) const
+	{
+		GetVectorValues(spt_playerio.GetPlayerEyePos(), out);
+	}
+
+	ValidationResult PosTracker::Validate(const float* expectedValues) const
+	{
+		return VectorValidation(spt_playerio.GetPlayerEyePos(), expectedValues, decimals);
+	}
+
 	std::string PosTracker::TrackerName() const
 	{
 		return "position";
@@ -98,6 +142,16 @@ namespace scripts2
 		return VectorValidation(Vector(va[0], va[1], va[2]), expectedValue, decimals);
 	}
 
+	void AngTracker::GetValues(float* out) const
+	{
+		GetVectorValues(GetViewAngles(), out);
+	}
+
+	ValidationResult AngTracker::Validate(const float* expectedValues) const
+	{
+		return VectorValidation(GetViewAngles(), expectedValues, decimals);
+	}
+
 	std::string AngTracker::TrackerName() const
 	{
 		return "angle";
@@ -15,6 +15,9 @@ namespace scripts2
 	public:
 		virtual std::string GenerateTestData() const = 0;
 		virtual ValidationResult Validate(const std::string& expectedValue) const = 0;
+		// Raw values for binary traces, TRACKER_VALUES floats
+		virtual void GetValues(float* out) const = 0;
+		virtual ValidationResult Validate(const float* expectedValues) const = 0;
 		virtual std::string TrackerName() const = 0;
 		virtual ~Tracker() {}
 	};
@@ -25,6 +28,8 @@ namespace scripts2
 		VelocityTracker(int decimals);
 		std::string GenerateTestData() const override;
 		ValidationResult Validate(const std::string& expectedValue) const override;
+		void GetValues(float* out) const override;
+		ValidationResult Validate(const float* expectedValues) const override;
 		std::string TrackerName() const override;
 
 	private:
@@ -37,6 +42,8 @@ namespace scripts2
 		PosTracker(int decimals);
 		std::string GenerateTestData() const override;
 		ValidationResult Validate(const std::string& expectedValue) const override;
+		void GetValues(float* out) const override;
+		ValidationResult Validate(const float* expectedValues) const override;
 		std::string TrackerName() const override;
 
 	private:
@@ -49,6 +56,8 @@ namespace scripts2
 		AngTracker(int decimals);
 		std::string GenerateTestData() const override;
 		ValidationResult Validate(const std::string& expectedValue) const override;
+		void GetValues(float* out) const override;
+		ValidationResult Validate(const float* expectedValues) const override;
 		std::string TrackerName() const override;
 
 	private:
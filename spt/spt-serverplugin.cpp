@@ -12,6 +12,7 @@
 #include "math.hpp"
 #include "string_utils.hpp"
 #include "game_detection.hpp"
+#include "thread_pool.hpp"
 #include "..\features\generic.hpp"
 #include "..\features\playerio.hpp"
 #include "custom_interfaces.hpp"
@@ -479,6 +480,8 @@ void CSourcePauseTool::Unload(void)
 	Cvar_UnregisterSPTCvars();
 	DisconnectTier1Libraries();
 	Feature::UnloadFeatures();
+	// Worker threads can't outlive the plugin
+	utils::GetThreadPool().Shutdown();
 	Hooks::Free();
 	pluginLoaded = false;
 }
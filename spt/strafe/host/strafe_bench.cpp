@@ -0,0 +1,570 @@
+// Runs the strafe core without the game: a player bunnyhopping and strafing over an endless flat floor.
+// Prints the simulation speed and a hash of the whole run, which has to stay the same for the same settings
+// unless the movement code changes on purpose.
+//
+// Usage: strafe_bench [ticks] [strafe type] [strafe version] [lookahead horizon] [lookahead beam width]
+//
+// Strafe type 4 plans with LookaheadPlanner without a time budget, so the hash stays the same for it as well. The
+// planner is told the player jumps whenever it lands, like it is in the game with +jump held.
+//
+// strafe_bench sweep [ticks] [yaws per tick] times the batch yaw evaluation against VectorFME instead. The exact
+// mode has to match VectorFME bit for bit, the program fails if it doesn't.
+//
+// strafe_bench corner [ticks] [lookahead horizon] [lookahead beam width] bunnyhops past the corner of a wall with max
+// accel strafing and with the planner, and prints how far each got and on which tick it was past the corner.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "hash_utils.hpp"
+#include "strafe_batch.hpp"
+#include "strafe_core.hpp"
+#include "strafe_lookahead.hpp"
+
+namespace
+{
+	const float FLOOR_Z = 0;
+	const float JUMP_SPEED = 160;
+
+	// Hull boxes stand on their origin, so only the origin has to stay above the floor
+	class FlatFloorTraces : public Strafe::ITraceProvider
+	{
+	public:
+		bool onGround = false;
+
+		virtual bool CanTrace() override
+		{
+			return true;
+		}
+
+		virtual bool IsGroundEntitySet() override
+		{
+			return onGround;
+		}
+
+		virtual Strafe::TraceResult TracePlayer(const Vector& start,
+		                                        const Vector& end,
+		                                        Strafe::HullType) override
+		{
+			Strafe::TraceResult tr;
+			tr.StartSolid = start.z < FLOOR_Z;
+			tr.AllSolid = tr.StartSolid && end.z < FLOOR_Z;
+			tr.PlaneNormal = Vector(0, 0, 1);
+
+			if (tr.AllSolid)
+			{
+				tr.Fraction = 0;
+				tr.EndPos = start;
+				tr.HitEntity = true;
+			}
+			else if (end.z < FLOOR_Z && start.z >= FLOOR_Z)
+			{
+				tr.Fraction = (start.z - FLOOR_Z) / (start.z - end.z);
+				tr.EndPos = Vector(start.x + (end.x - start.x) * tr.Fraction,
+				                   start.y + (end.y - start.y) * tr.Fraction,
+				                   FLOOR_Z);
+				tr.HitEntity = true;
+			}
+			else
+			{
+				tr.Fraction = 1;
+				tr.EndPos = end;
+				tr.PlaneNormal = Vector(0, 0, 0);
+				tr.HitEntity = false;
+			}
+
+			return tr;
+		}
+
+		virtual Strafe::TraceResult TracePlayerForGround(const Vector& start,
+		                                                 const Vector& end,
+		                                                 Strafe::HullType hull) override
+		{
+			return TracePlayer(start, end, hull);
+		}
+	};
+
+	struct Box
+	{
+		Vector mins;
+		Vector maxs;
+	};
+
+	// The floor with boxes standing on it. Traces stop DIST_EPSILON short of a box like the game's do, so the
+	// player never ends up touching one.
+	class BoxTraces : public FlatFloorTraces
+	{
+	public:
+		std::vector<Box> boxes;
+
+		virtual Strafe::TraceResult TracePlayer(const Vector& start,
+		                                        const Vector& end,
+		                                        Strafe::HullType hull) override
+		{
+			const double DIST_EPSILON = 0.03125;
+			float halfWidth = hull == Strafe::HullType::POINT ? 0 : 16;
+			float height = 0;
+			if (hull == Strafe::HullType::NORMAL)
+				height = 72;
+			else if (hull == Strafe::HullType::DUCKED)
+				height = 36;
+
+			Strafe::TraceResult tr = FlatFloorTraces::TracePlayer(start, end, hull);
+			double s[3] = {start.x, start.y, start.z};
+			double d[3] = {end.x - start.x, end.y - start.y, end.z - start.z};
+			double length = std::sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+
+			for (const Box& box : boxes)
+			{
+				// The box grown by the hull, which stands on its origin
+				double lo[3] = {box.mins.x - halfWidth, box.mins.y - halfWidth, box.mins.z - height};
+				double hi[3] = {box.maxs.x + halfWidth, box.maxs.y + halfWidth, box.maxs.z};
+
+				double enter = -1e30, exit = 1e30;
+				int axis = -1;
+				bool miss = false;
+				for (int k = 0; k < 3 && !miss; ++k)
+				{
+					if (d[k] == 0)
+					{
+						miss = s[k] <= lo[k] || s[k] >= hi[k];
+						continue;
+					}
+
+					double t1 = (lo[k] - s[k]) / d[k];
+					double t2 = (hi[k] - s[k]) / d[k];
+					if (t1 > t2)
+						std::swap(t1, t2);
+					if (t1 > enter)
+					{
+						enter = t1;
+						axis = k;
+					}
+					exit = (std::min)(exit, t2);
+				}
+				if (miss || enter >= exit || enter > 1 || exit <= 0)
+					continue;
+
+				if (enter < 0)
+				{
+					tr.StartSolid = true;
+					tr.AllSolid = exit >= 1;
+					tr.Fraction = 0;
+					tr.EndPos = start;
+					tr.HitEntity = true;
+					continue;
+				}
+
+				float fraction = static_cast<float>((std::max)(0.0, enter - DIST_EPSILON / length));
+				if (fraction >= tr.Fraction)
+					continue;
+
+				tr.Fraction = fraction;
+				tr.EndPos = Vector(start.x + static_cast<float>(d[0] * fraction),
+				                   start.y + static_cast<float>(d[1] * fraction),
+				                   start.z + static_cast<float>(d[2] * fraction));
+				tr.PlaneNormal = Vector(0, 0, 0);
+				tr.PlaneNormal[axis] = d[axis] > 0 ? -1.0f : 1.0f;
+				tr.HitEntity = true;
+			}
+
+			return tr;
+		}
+	};
+
+	Strafe::MovementVars GetHL2Vars()
+	{
+		Strafe::MovementVars vars = Strafe::MovementVars();
+		vars.Accelerate = 10;
+		vars.Airaccelerate = 10;
+		vars.EntFriction = 1;
+		vars.Frametime = 0.015f;
+		vars.Friction = 4;
+		vars.Maxspeed = 190;
+		vars.Stopspeed = 100;
+		vars.WishspeedCap = 30;
+		vars.EntGravity = 1;
+		vars.Maxvelocity = 3500;
+		vars.Gravity = 600;
+		vars.Stepsize = 18;
+		vars.Bounce = 0;
+		return vars;
+	}
+
+	struct SweepState
+	{
+		Strafe::PlayerData player;
+		bool onground;
+		Strafe::Button button;
+	};
+
+	double Seconds(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	int Sweep(long long ticks, size_t count)
+	{
+		Strafe::MovementVars vars = GetHL2Vars();
+		double wishspeed = vars.Maxspeed;
+		std::vector<double> yaws(count);
+		for (size_t i = 0; i < count; ++i)
+			yaws[i] = -M_PI + 2 * M_PI * i / count;
+
+		std::vector<float> x(count), y(count), speed(count);
+		Strafe::YawBatch batch = {count, yaws.data(), x.data(), y.data(), speed.data()};
+
+		// Every tick takes the fastest yaw, with a ground tick now and then and all the buttons
+		std::vector<SweepState> states(ticks);
+		Strafe::PlayerData player = Strafe::PlayerData();
+		player.Velocity = Vector(0, 0, 0);
+		for (long long i = 0; i < ticks; ++i)
+		{
+			SweepState& state = states[i];
+			state.onground = i % 8 == 0;
+			state.button = static_cast<Strafe::Button>(i % 8);
+			if (state.onground)
+				Strafe::Friction(player, true, vars);
+			state.player = player;
+
+			Strafe::EvaluateYaws(player,
+			                     vars,
+			                     state.onground,
+			                     wishspeed,
+			                     state.button,
+			                     batch,
+			                     Strafe::BatchMode::EXACT);
+			size_t best = 0;
+			for (size_t j = 1; j < count; ++j)
+			{
+				if (speed[j] > speed[best])
+					best = j;
+			}
+			player.Velocity.x = x[best];
+			player.Velocity.y = y[best];
+		}
+
+		// Scalar reference
+		std::vector<float> refX(ticks * count), refY(ticks * count), refSpeed(ticks * count);
+		auto start = std::chrono::steady_clock::now();
+		for (long long i = 0; i < ticks; ++i)
+		{
+			const SweepState& state = states[i];
+			double phi = Strafe::ButtonsPhi(state.button);
+			for (size_t j = 0; j < count; ++j)
+			{
+				Strafe::PlayerData pl = state.player;
+				Strafe::VectorFME(pl,
+				                  vars,
+				                  state.onground,
+				                  wishspeed,
+				                  Vector2D(std::cos(yaws[j] + phi), std::sin(yaws[j] + phi)));
+				refX[i * count + j] = pl.Velocity.x;
+				refY[i * count + j] = pl.Velocity.y;
+				refSpeed[i * count + j] = pl.Velocity.Length2D();
+			}
+		}
+		double scalarTime = Seconds(start);
+
+		double evaluations = static_cast<double>(ticks) * count;
+		std::printf("scalar: %.0f yaws/s\n", evaluations / scalarTime);
+
+		const Strafe::BatchMode modes[] = {Strafe::BatchMode::EXACT, Strafe::BatchMode::FAST};
+		const char* names[] = {"exact", "fast"};
+		bool failed = false;
+		for (int m = 0; m < 2; ++m)
+		{
+			long long mismatches = 0;
+			float maxError = 0;
+			double elapsed = 0;
+			for (long long i = 0; i < ticks; ++i)
+			{
+				const SweepState& state = states[i];
+				start = std::chrono::steady_clock::now();
+				Strafe::EvaluateYaws(state.player,
+				                     vars,
+				                     state.onground,
+				                     wishspeed,
+				                     state.button,
+				                     batch,
+				                     modes[m]);
+				elapsed += Seconds(start);
+
+				const float* expected[] = {&refX[i * count], &refY[i * count], &refSpeed[i * count]};
+				const float* actual[] = {x.data(), y.data(), speed.data()};
+				for (int k = 0; k < 3; ++k)
+				{
+					if (std::memcmp(expected[k], actual[k], count * sizeof(float)) == 0)
+						continue;
+					for (size_t j = 0; j < count; ++j)
+					{
+						float error = std::fabs(expected[k][j] - actual[k][j]);
+						if (std::memcmp(&expected[k][j], &actual[k][j], sizeof(float)) != 0)
+							++mismatches;
+						if (error > maxError)
+							maxError = error;
+					}
+				}
+			}
+
+			std::printf("%s: %.0f yaws/s, %.1fx scalar, %lld values differ, max error %g\n",
+			            names[m],
+			            evaluations / elapsed,
+			            scalarTime / elapsed,
+			            mismatches,
+			            maxError);
+			if (modes[m] == Strafe::BatchMode::EXACT && mismatches != 0)
+				failed = true;
+		}
+
+		return failed ? 1 : 0;
+	}
+
+	struct CornerRun
+	{
+		double progress;
+		double speed;
+		long long passedAt; // -1 if the corner wasn't passed
+		double seconds;
+		uint64_t hash;
+	};
+
+	// Bunnyhops toward the target yaw past the corner of a wall that is in the way, with the jumps done the way
+	// TASFeature::Strafe does them
+	CornerRun RunCorner(BoxTraces& traces,
+	                    long long ticks,
+	                    Strafe::StrafeType type,
+	                    const Strafe::LookaheadSettings& lookahead,
+	                    float cornerX)
+	{
+		Strafe::StrafeConfig config;
+		Strafe::LookaheadPlanner planner;
+		Strafe::MovementVars vars = GetHL2Vars();
+
+		Strafe::PlayerData player = Strafe::PlayerData();
+		player.UnduckedOrigin = Vector(0, 0, FLOOR_Z);
+		player.Velocity = Vector(400, 0, 0);
+		player.Basevelocity = Vector(0, 0, 0);
+
+		Strafe::StrafeInput input = Strafe::StrafeInput();
+		input.TargetYaw = 0;
+		input.Scale = 1;
+		input.Strafe = true;
+		input.Version = config.Version;
+
+		CornerRun run = {0, 0, -1, 0, utils::FNV1A_64_OFFSET};
+		double velYaw = 0;
+		auto start = std::chrono::steady_clock::now();
+		for (long long i = 0; i < ticks; ++i)
+		{
+			auto postype = Strafe::GetPositionType(player, Strafe::HullType::NORMAL, config, traces);
+			vars.OnGround = postype == Strafe::PositionType::GROUND;
+			traces.onGround = vars.OnGround;
+
+			bool jumped = vars.OnGround;
+			if (jumped)
+				vars.OnGround = false;
+
+			Strafe::StrafeInput tickInput = input;
+			if (type == Strafe::StrafeType::LOOKAHEAD)
+			{
+				tickInput.TargetYaw =
+				    planner.Plan(player, vars, jumped, input.TargetYaw, config, traces, lookahead);
+			}
+			if (jumped)
+				player.Velocity.z = Strafe::JumpSpeed(vars);
+
+			Strafe::Friction(player, vars.OnGround, vars);
+			Strafe::ProcessedFrame out;
+			Strafe::Strafe(player,
+			               vars,
+			               tickInput,
+			               jumped,
+			               type,
+			               Strafe::StrafeDir::YAW,
+			               velYaw,
+			               out,
+			               Strafe::StrafeButtons(),
+			               false,
+			               config);
+			velYaw = out.Yaw;
+
+			// Max accel strafing accelerates in Strafe, the planned yaw is strafed to with forward held.
+			// Above the ABH speed the jump type turns the player around without any buttons.
+			if (type == Strafe::StrafeType::LOOKAHEAD && out.Forward)
+			{
+				double yaw = out.Yaw * M_PI / 180;
+				Vector2D wishdir(std::cos(yaw), std::sin(yaw));
+				Strafe::VectorFME(player, vars, vars.OnGround, vars.Maxspeed, wishdir);
+			}
+
+			Strafe::Move(player, vars, config, traces);
+			run.hash = utils::Fnv1a64(&player.UnduckedOrigin, sizeof(Vector), run.hash);
+			run.hash = utils::Fnv1a64(&player.Velocity, sizeof(Vector), run.hash);
+			if (run.passedAt < 0 && player.UnduckedOrigin.x > cornerX)
+				run.passedAt = i;
+		}
+
+		run.seconds = Seconds(start);
+		run.progress = player.UnduckedOrigin.x;
+		run.speed = player.Velocity.Length2D();
+		return run;
+	}
+
+	int Corner(long long ticks, const Strafe::LookaheadSettings& lookahead)
+	{
+		// A wall across the way, its corner 40 units to the left of where the player starts
+		BoxTraces traces;
+		traces.boxes.push_back(Box{Vector(800, -1000, 0), Vector(900, 40, 200)});
+		float cornerX = 900 + 16;
+
+		CornerRun greedy = RunCorner(traces, ticks, Strafe::StrafeType::MAXACCEL, lookahead, cornerX);
+		CornerRun beam = RunCorner(traces, ticks, Strafe::StrafeType::LOOKAHEAD, lookahead, cornerX);
+
+		std::printf("%lld ticks past a wall corner, horizon %d, beam width %d\n",
+		            ticks,
+		            lookahead.Horizon,
+		            lookahead.BeamWidth);
+		const CornerRun* runs[] = {&greedy, &beam};
+		const char* names[] = {"max accel", "lookahead"};
+		for (int i = 0; i < 2; ++i)
+		{
+			std::printf("%-9s: %.3f along the target yaw, speed %.3f, ",
+			            names[i],
+			            runs[i]->progress,
+			            runs[i]->speed);
+			if (runs[i]->passedAt >= 0)
+				std::printf("past the corner at tick %lld, ", runs[i]->passedAt);
+			else
+				std::printf("not past the corner, ");
+			std::printf("%.0f ticks/s\n", ticks / runs[i]->seconds);
+		}
+		std::printf("hash %016llx\n", static_cast<unsigned long long>(beam.hash));
+		return 0;
+	}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+	if (argc > 1 && std::strcmp(argv[1], "sweep") == 0)
+	{
+		long long sweepTicks = argc > 2 ? std::atoll(argv[2]) : 2000;
+		size_t count = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 4096;
+		return Sweep(sweepTicks, count);
+	}
+	if (argc > 1 && std::strcmp(argv[1], "corner") == 0)
+	{
+		Strafe::LookaheadSettings lookahead;
+		lookahead.BudgetMs = 0;
+		lookahead.Autojump = true;
+		lookahead.Horizon = 24;
+		long long cornerTicks = argc > 2 ? std::atoll(argv[2]) : 400;
+		if (argc > 3)
+			lookahead.Horizon = std::atoi(argv[3]);
+		if (argc > 4)
+			lookahead.BeamWidth = std::atoi(argv[4]);
+		return Corner(cornerTicks, lookahead);
+	}
+
+	long long ticks = argc > 1 ? std::atoll(argv[1]) : 1000000;
+	int type = argc > 2 ? std::atoi(argv[2]) : 0;
+
+	Strafe::StrafeConfig config;
+	if (argc > 3)
+		config.Version = std::atoi(argv[3]);
+	// Jumping is handled below, the core only decides the yaw
+	config.JumpType = 0;
+
+	Strafe::LookaheadSettings lookahead;
+	lookahead.BudgetMs = 0;
+	// Every landing is a jump
+	lookahead.Autojump = true;
+	if (argc > 4)
+		lookahead.Horizon = std::atoi(argv[4]);
+	if (argc > 5)
+		lookahead.BeamWidth = std::atoi(argv[5]);
+	Strafe::LookaheadPlanner planner;
+
+	Strafe::PlayerData player = Strafe::PlayerData();
+	player.UnduckedOrigin = Vector(0, 0, FLOOR_Z);
+	player.Velocity = Vector(0, 0, 0);
+	player.Basevelocity = Vector(0, 0, 0);
+
+	Strafe::StrafeInput input = Strafe::StrafeInput();
+	input.TargetYaw = 45;
+	input.Scale = 1;
+	input.Strafe = true;
+	input.Version = config.Version;
+
+	FlatFloorTraces traces;
+	Strafe::MovementVars vars = GetHL2Vars();
+	uint64_t hash = utils::FNV1A_64_OFFSET;
+	double velYaw = 0;
+
+	auto start = std::chrono::steady_clock::now();
+	for (long long i = 0; i < ticks; ++i)
+	{
+		auto postype = Strafe::GetPositionType(player, Strafe::HullType::NORMAL, config, traces);
+		vars.OnGround = postype == Strafe::PositionType::GROUND;
+		traces.onGround = vars.OnGround;
+
+		bool jumped = vars.OnGround;
+		if (jumped)
+		{
+			player.Velocity.z = JUMP_SPEED;
+			vars.OnGround = false;
+		}
+
+		Strafe::StrafeInput tickInput = input;
+		if (type == static_cast<int>(Strafe::StrafeType::LOOKAHEAD))
+		{
+			tickInput.TargetYaw =
+			    planner.Plan(player, vars, jumped, input.TargetYaw, config, traces, lookahead);
+		}
+
+		Strafe::Friction(player, vars.OnGround, vars);
+		Strafe::ProcessedFrame out;
+		Strafe::Strafe(player,
+		               vars,
+		               tickInput,
+		               false,
+		               static_cast<Strafe::StrafeType>(type),
+		               Strafe::StrafeDir::YAW,
+		               velYaw,
+		               out,
+		               Strafe::StrafeButtons(),
+		               false,
+		               config);
+		velYaw = out.Yaw;
+
+		// These only pick the yaw, the game accelerates with forward held
+		if (type == static_cast<int>(Strafe::StrafeType::DIRECTION)
+		    || type == static_cast<int>(Strafe::StrafeType::LOOKAHEAD))
+		{
+			double yaw = out.Yaw * M_PI / 180;
+			Vector2D wishdir(std::cos(yaw), std::sin(yaw));
+			Strafe::VectorFME(player, vars, vars.OnGround, vars.Maxspeed, wishdir);
+		}
+
+		Strafe::Move(player, vars, config, traces);
+		hash = utils::Fnv1a64(&player.UnduckedOrigin, sizeof(Vector), hash);
+		hash = utils::Fnv1a64(&player.Velocity, sizeof(Vector), hash);
+	}
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+	std::printf("%lld ticks in %.3f s, %.0f ticks/s\n", ticks, elapsed.count(), ticks / elapsed.count());
+	double targetYaw = input.TargetYaw * M_PI / 180;
+	std::printf("position %.3f %.3f %.3f, speed %.3f, %.3f along the target yaw\n",
+	            player.UnduckedOrigin.x,
+	            player.UnduckedOrigin.y,
+	            player.UnduckedOrigin.z,
+	            player.Velocity.Length2D(),
+	            player.UnduckedOrigin.x * std::cos(targetYaw) + player.UnduckedOrigin.y * std::sin(targetYaw));
+	std::printf("hash %016llx\n", static_cast<unsigned long long>(hash));
+	return 0;
+}
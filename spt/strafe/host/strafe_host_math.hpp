@@ -0,0 +1,91 @@
+#pragma once
+#include <cassert>
+#include <cmath>
+
+// Stand-ins for the SDK vector types so the strafe core builds without the SDK. They follow the float math of
+// mathlib, including its quirks like IsZero(0) never being true, so the results match the game bit for bit.
+
+typedef float vec_t;
+
+class Vector2D
+{
+public:
+	vec_t x, y;
+
+	Vector2D() {}
+	Vector2D(vec_t x, vec_t y) : x(x), y(y) {}
+
+	vec_t& operator[](int i)
+	{
+		return (&x)[i];
+	}
+	vec_t operator[](int i) const
+	{
+		return (&x)[i];
+	}
+
+	bool IsZero(float tolerance = 0.01f) const
+	{
+		return x > -tolerance && x < tolerance && y > -tolerance && y < tolerance;
+	}
+	vec_t Dot(const Vector2D& v) const
+	{
+		return x * v.x + y * v.y;
+	}
+	vec_t Length() const
+	{
+		return std::sqrt(x * x + y * y);
+	}
+};
+
+class Vector
+{
+public:
+	vec_t x, y, z;
+
+	Vector() {}
+	Vector(vec_t x, vec_t y, vec_t z) : x(x), y(y), z(z) {}
+
+	vec_t& operator[](int i)
+	{
+		return (&x)[i];
+	}
+	vec_t operator[](int i) const
+	{
+		return (&x)[i];
+	}
+
+	Vector2D& AsVector2D()
+	{
+		return *reinterpret_cast<Vector2D*>(this);
+	}
+	const Vector2D& AsVector2D() const
+	{
+		return *reinterpret_cast<const Vector2D*>(this);
+	}
+
+	vec_t Length() const
+	{
+		return std::sqrt(x * x + y * y + z * z);
+	}
+	vec_t Length2D() const
+	{
+		return std::sqrt(x * x + y * y);
+	}
+
+	Vector& operator*=(float fl)
+	{
+		x *= fl;
+		y *= fl;
+		z *= fl;
+		return *this;
+	}
+	Vector operator+(const Vector& v) const
+	{
+		return Vector(x + v.x, y + v.y, z + v.z);
+	}
+	Vector operator-(const Vector& v) const
+	{
+		return Vector(x - v.x, y - v.y, z - v.z);
+	}
+};
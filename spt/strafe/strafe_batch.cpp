@@ -0,0 +1,205 @@
+#include "stdafx.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <emmintrin.h>
+
+#include "strafe_batch.hpp"
+
+namespace Strafe
+{
+	namespace
+	{
+		const size_t LANES = 4;
+
+		// The parts of VectorFME that don't depend on the wishdir
+		struct FMEConstants
+		{
+			float velX;
+			float velY;
+			double wishspeedCapped;
+			double accelspeed;
+		};
+
+		inline __m128 Select(__m128 mask, __m128 a, __m128 b)
+		{
+			return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+		}
+
+		inline __m128 Length2D(__m128 x, __m128 y)
+		{
+			return _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)));
+		}
+
+		// Same operations as VectorFME in the same precision: the dot product is float, tmp and the clamp are
+		// double and the velocity change is rounded to float before it's added
+		void ExactBlock(const FMEConstants& c,
+		                const float* ax,
+		                const float* ay,
+		                float* outX,
+		                float* outY,
+		                float* outSpeed)
+		{
+			const __m128 velX = _mm_set1_ps(c.velX);
+			const __m128 velY = _mm_set1_ps(c.velY);
+			const __m128d capped = _mm_set1_pd(c.wishspeedCapped);
+			const __m128d accelspeed = _mm_set1_pd(c.accelspeed);
+			const __m128d zero = _mm_setzero_pd();
+
+			__m128 aX = _mm_loadu_ps(ax);
+			__m128 aY = _mm_loadu_ps(ay);
+			__m128 dot = _mm_add_ps(_mm_mul_ps(velX, aX), _mm_mul_ps(velY, aY));
+
+			__m128d tmpLo = _mm_sub_pd(capped, _mm_cvtps_pd(dot));
+			__m128d tmpHi = _mm_sub_pd(capped, _mm_cvtps_pd(_mm_movehl_ps(dot, dot)));
+			// Keep the low half of each 64 bit mask, which is all ones or all zeros like the rest of it
+			__m128 skip = _mm_shuffle_ps(_mm_castpd_ps(_mm_cmple_pd(tmpLo, zero)),
+			                             _mm_castpd_ps(_mm_cmple_pd(tmpHi, zero)),
+			                             _MM_SHUFFLE(2, 0, 2, 0));
+			// accelspeed <= tmp ? accelspeed : tmp, min_pd only differs from that when they're equal
+			tmpLo = _mm_min_pd(accelspeed, tmpLo);
+			tmpHi = _mm_min_pd(accelspeed, tmpHi);
+
+			__m128 dX = _mm_movelh_ps(_mm_cvtpd_ps(_mm_mul_pd(_mm_cvtps_pd(aX), tmpLo)),
+			                          _mm_cvtpd_ps(_mm_mul_pd(_mm_cvtps_pd(_mm_movehl_ps(aX, aX)), tmpHi)));
+			__m128 dY = _mm_movelh_ps(_mm_cvtpd_ps(_mm_mul_pd(_mm_cvtps_pd(aY), tmpLo)),
+			                          _mm_cvtpd_ps(_mm_mul_pd(_mm_cvtps_pd(_mm_movehl_ps(aY, aY)), tmpHi)));
+
+			// Selected instead of adding a zero change, -0 + 0 would come out as +0
+			__m128 x = Select(skip, velX, _mm_add_ps(velX, dX));
+			__m128 y = Select(skip, velY, _mm_add_ps(velY, dY));
+			_mm_storeu_ps(outX, x);
+			_mm_storeu_ps(outY, y);
+			_mm_storeu_ps(outSpeed, Length2D(x, y));
+		}
+
+		// sin and cos of 4 angles given as 2 double pairs. The angle is reduced to [-pi/4, pi/4] in double so
+		// large yaws stay accurate, then the float polynomials of Cephes sinf/cosf are used.
+		void FastSinCos(__m128d anglesLo, __m128d anglesHi, __m128& sin, __m128& cos)
+		{
+			const __m128d twoOverPi = _mm_set1_pd(2 / M_PI);
+			const __m128d halfPi = _mm_set1_pd(M_PI / 2);
+			const __m128i one = _mm_set1_epi32(1);
+			const __m128i two = _mm_set1_epi32(2);
+
+			// Rounds to the nearest quadrant
+			__m128i qLo = _mm_cvtpd_epi32(_mm_mul_pd(anglesLo, twoOverPi));
+			__m128i qHi = _mm_cvtpd_epi32(_mm_mul_pd(anglesHi, twoOverPi));
+			__m128d rLo = _mm_sub_pd(anglesLo, _mm_mul_pd(_mm_cvtepi32_pd(qLo), halfPi));
+			__m128d rHi = _mm_sub_pd(anglesHi, _mm_mul_pd(_mm_cvtepi32_pd(qHi), halfPi));
+			__m128i q = _mm_unpacklo_epi64(qLo, qHi);
+			__m128 r = _mm_movelh_ps(_mm_cvtpd_ps(rLo), _mm_cvtpd_ps(rHi));
+			__m128 r2 = _mm_mul_ps(r, r);
+
+			__m128 s = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(-1.9515295891e-4f), r2),
+			                      _mm_set1_ps(8.3321608736e-3f));
+			s = _mm_add_ps(_mm_mul_ps(s, r2), _mm_set1_ps(-1.6666654611e-1f));
+			s = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(s, r2), r), r);
+
+			__m128 c = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(2.443315711809948e-5f), r2),
+			                      _mm_set1_ps(-1.388731625493765e-3f));
+			c = _mm_add_ps(_mm_mul_ps(c, r2), _mm_set1_ps(4.166664568298827e-2f));
+			c = _mm_mul_ps(_mm_mul_ps(c, r2), r2);
+			c = _mm_add_ps(_mm_sub_ps(c, _mm_mul_ps(_mm_set1_ps(0.5f), r2)), _mm_set1_ps(1.0f));
+
+			// Odd quadrants swap sin and cos, bit 1 of q and q + 1 flips the signs
+			__m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(q, one), one));
+			__m128 sinSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(q, two), 30));
+			__m128i cosQuadrant = _mm_add_epi32(q, one);
+			__m128 cosSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(cosQuadrant, two), 30));
+			sin = _mm_xor_ps(Select(swap, c, s), sinSign);
+			cos = _mm_xor_ps(Select(swap, s, c), cosSign);
+		}
+
+		void FastBlock(const FMEConstants& c,
+		               double phi,
+		               const double* yaws,
+		               float* outX,
+		               float* outY,
+		               float* outSpeed)
+		{
+			const __m128 velX = _mm_set1_ps(c.velX);
+			const __m128 velY = _mm_set1_ps(c.velY);
+			const __m128 capped = _mm_set1_ps(static_cast<float>(c.wishspeedCapped));
+			const __m128 accelspeed = _mm_set1_ps(static_cast<float>(c.accelspeed));
+			const __m128d phiD = _mm_set1_pd(phi);
+
+			__m128 aX, aY;
+			__m128d anglesLo = _mm_add_pd(_mm_loadu_pd(yaws), phiD);
+			__m128d anglesHi = _mm_add_pd(_mm_loadu_pd(yaws + 2), phiD);
+			FastSinCos(anglesLo, anglesHi, aY, aX);
+
+			__m128 tmp = _mm_sub_ps(capped, _mm_add_ps(_mm_mul_ps(velX, aX), _mm_mul_ps(velY, aY)));
+			__m128 skip = _mm_cmple_ps(tmp, _mm_setzero_ps());
+			tmp = _mm_min_ps(accelspeed, tmp);
+
+			__m128 x = Select(skip, velX, _mm_add_ps(velX, _mm_mul_ps(aX, tmp)));
+			__m128 y = Select(skip, velY, _mm_add_ps(velY, _mm_mul_ps(aY, tmp)));
+			_mm_storeu_ps(outX, x);
+			_mm_storeu_ps(outY, y);
+			_mm_storeu_ps(outSpeed, Length2D(x, y));
+		}
+	} // namespace
+
+	void EvaluateYaws(const PlayerData& player,
+	                  const MovementVars& vars,
+	                  bool onground,
+	                  double wishspeed,
+	                  Button button,
+	                  const YawBatch& batch,
+	                  BatchMode mode)
+	{
+		FMEConstants c;
+		c.velX = player.Velocity.x;
+		c.velY = player.Velocity.y;
+		c.wishspeedCapped = onground ? wishspeed : vars.WishspeedCap;
+		double accel = onground ? vars.Accelerate : vars.Airaccelerate;
+		c.accelspeed = accel * wishspeed * vars.EntFriction * vars.Frametime;
+		double phi = ButtonsPhi(button);
+
+		// The last partial block goes through padded copies
+		double yaws[LANES];
+		float ax[LANES], ay[LANES], outX[LANES], outY[LANES], outSpeed[LANES];
+
+		for (size_t i = 0; i < batch.Count; i += LANES)
+		{
+			size_t n = (std::min)(LANES, batch.Count - i);
+			bool full = n == LANES;
+			const double* in = batch.Yaws + i;
+			if (!full)
+			{
+				for (size_t j = 0; j < LANES; ++j)
+					yaws[j] = j < n ? in[j] : 0;
+				in = yaws;
+			}
+
+			float* x = full ? batch.VelocityX + i : outX;
+			float* y = full ? batch.VelocityY + i : outY;
+			float* speed = full ? batch.Speed + i : outSpeed;
+
+			if (mode == BatchMode::EXACT)
+			{
+				for (size_t j = 0; j < LANES; ++j)
+				{
+					ax[j] = static_cast<float>(std::cos(in[j] + phi));
+					ay[j] = static_cast<float>(std::sin(in[j] + phi));
+				}
+				ExactBlock(c, ax, ay, x, y, speed);
+			}
+			else
+			{
+				FastBlock(c, phi, in, x, y, speed);
+			}
+
+			if (!full)
+			{
+				for (size_t j = 0; j < n; ++j)
+				{
+					batch.VelocityX[i + j] = outX[j];
+					batch.VelocityY[i + j] = outY[j];
+					batch.Speed[i + j] = outSpeed[j];
+				}
+			}
+		}
+	}
+} // namespace Strafe
@@ -0,0 +1,42 @@
+#pragma once
+#include <cstddef>
+
+#include "strafe_core.hpp"
+
+namespace Strafe
+{
+	/*
+	* Evaluates many candidate yaws for one player state at once, for yaw sweeps that go through thousands of
+	* angles per tick. The candidates and the results are separate arrays that are worked on 4 at a time with SSE2.
+	*
+	* EXACT gives the same bits as VectorFME with the wishdir SideStrafeGeneral builds for each yaw. Only cos/sin
+	* stay scalar, the float math is done in float lanes and the double math in double lanes like the scalar code.
+	* FAST does everything in float with a polynomial sin/cos. It is off by a few ulps, which is fine for finding
+	* candidates, but the chosen yaw should go through the scalar path before it is used for input.
+	*/
+	enum class BatchMode
+	{
+		EXACT = 0,
+		FAST
+	};
+
+	struct YawBatch
+	{
+		size_t Count;
+		const double* Yaws; // Radians
+		// Results, Count floats each
+		float* VelocityX;
+		float* VelocityY;
+		float* Speed; // 2D
+	};
+
+	// The 2D velocity after one tick of acceleration for every yaw of the batch with button held.
+	// With Button::FORWARD the yaws are the wishdirs.
+	void EvaluateYaws(const PlayerData& player,
+	                  const MovementVars& vars,
+	                  bool onground,
+	                  double wishspeed,
+	                  Button button,
+	                  const YawBatch& batch,
+	                  BatchMode mode);
+} // namespace Strafe
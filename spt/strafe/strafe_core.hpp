@@ -0,0 +1,335 @@
+#pragma once
+
+#if defined(SPT_STRAFE_HOST)
+#include "strafe_host_math.hpp"
+#elif defined(OE)
+#include "vector.h"
+#include "vector2d.h"
+#else
+#include "mathlib\vector.h"
+#include "mathlib\vector2d.h"
+#endif
+
+// This code is a messed up version of hlstrafe,
+// go take a look at that instead:
+// https://github.com/HLTAS/hlstrafe
+
+// The strafe core doesn't touch the game, everything it needs comes in through StrafeConfig and ITraceProvider.
+// strafestuff.hpp adapts it to the game, host\ builds it without the game for offline simulation.
+namespace Strafe
+{
+	struct TraceResult
+	{
+		bool AllSolid;
+		bool StartSolid;
+		float Fraction;
+		Vector EndPos;
+		Vector PlaneNormal;
+		bool HitEntity;
+	};
+
+	struct StrafeInput
+	{
+		double TargetYaw;
+		float VectorialOffset;
+		float AngleSpeed;
+		float Scale;
+		bool AFH;
+		bool Vectorial;
+		bool JumpOverride;
+		bool Strafe;
+		int Version;
+	};
+
+	struct MovementVars
+	{
+		float Accelerate;
+		float Airaccelerate;
+		float EntFriction;
+		float Frametime;
+		float Friction;
+		float Maxspeed;
+		float Stopspeed;
+		float WishspeedCap;
+
+		float EntGravity;
+		float Maxvelocity;
+		float Gravity;
+		float Stepsize;
+		float Bounce;
+
+		bool OnGround;
+		bool CantJump;
+		bool ReduceWishspeed;
+	};
+
+	struct PlayerData
+	{
+		Vector UnduckedOrigin;
+		Vector Velocity;
+		Vector Basevelocity;
+		bool Ducking;
+		bool DuckPressed;
+	};
+
+	enum class Button : unsigned char
+	{
+		FORWARD = 0,
+		FORWARD_LEFT,
+		LEFT,
+		BACK_LEFT,
+		BACK,
+		BACK_RIGHT,
+		RIGHT,
+		FORWARD_RIGHT
+	};
+
+	struct StrafeButtons
+	{
+		StrafeButtons()
+		    : AirLeft(Button::FORWARD)
+		    , AirRight(Button::FORWARD)
+		    , GroundLeft(Button::FORWARD)
+		    , GroundRight(Button::FORWARD)
+		{
+		}
+
+		Button AirLeft;
+		Button AirRight;
+		Button GroundLeft;
+		Button GroundRight;
+	};
+
+	struct ProcessedFrame
+	{
+		bool Processed; // Should apply strafing in ClientDLL?
+		bool Forward;
+		bool Back;
+		bool Right;
+		bool Left;
+		bool Jump;
+		bool ForceUnduck;
+
+		double Yaw;
+		float ForwardSpeed;
+		float SideSpeed;
+
+		ProcessedFrame()
+		    : Processed(false)
+		    , Forward(false)
+		    , Back(false)
+		    , Right(false)
+		    , Left(false)
+		    , Jump(false)
+		    , Yaw(0)
+		    , ForwardSpeed(0)
+		    , SideSpeed(0)
+		    , ForceUnduck(false)
+		{
+		}
+	};
+
+	struct CurrentState
+	{
+		float LgagstMinSpeed;
+		bool LgagstFullMaxspeed;
+	};
+
+	enum class StrafeType
+	{
+		MAXACCEL = 0,
+		MAXANGLE = 1,
+		CAPPED = 2,
+		DIRECTION = 3,
+		LOOKAHEAD = 4 // The yaw is planned by LookaheadPlanner and passed in as the target yaw
+	};
+
+	enum class StrafeDir
+	{
+		LEFT = 0,
+		RIGHT = 1,
+		YAW = 3,
+		BUTTONS = 4
+	};
+
+	enum class PositionType
+	{
+		GROUND = 0,
+		AIR,
+		WATER
+	};
+
+	enum class HullType : int
+	{
+		NORMAL = 0,
+		DUCKED = 1,
+		POINT = 2
+	};
+
+	// The tas_strafe_* settings the core uses, the defaults match the cvar defaults
+	struct StrafeConfig
+	{
+		int Version = 6;
+		bool UseTracing = true;
+		bool AllowJumpOverride = false;
+		bool AutoJB = false;
+		int JumpType = 1;
+		float AfhLength = 0.0000000000000000001f;
+		float CappedLimit = 299.99f;
+		float LgagstMin = 150;
+		float LgagstMax = 270;
+		float VectorialIncrement = 2.5f;
+		float VectorialSnap = 170;
+	};
+
+	// Collision queries of the core. Traces start at the unducked origin, the hull is placed by the provider.
+	class ITraceProvider
+	{
+	public:
+		virtual ~ITraceProvider() = default;
+
+		// Whether traces hit anything, without them the position type comes from IsGroundEntitySet
+		virtual bool CanTrace() = 0;
+		virtual bool IsGroundEntitySet() = 0;
+		virtual TraceResult TracePlayer(const Vector& start, const Vector& end, HullType hull) = 0;
+		// Second ground check of strafe version 2 and later, the game's TracePlayerBBoxForGround
+		virtual TraceResult TracePlayerForGround(const Vector& start, const Vector& end, HullType hull) = 0;
+	};
+
+	// Nothing is in the way and the ground state never changes, for simulating ahead without collisions
+	class NoTraceProvider : public ITraceProvider
+	{
+	public:
+		explicit NoTraceProvider(bool onGround) : onGround(onGround) {}
+
+		virtual bool CanTrace() override
+		{
+			return false;
+		}
+
+		virtual bool IsGroundEntitySet() override
+		{
+			return onGround;
+		}
+
+		virtual TraceResult TracePlayer(const Vector&, const Vector& end, HullType) override
+		{
+			TraceResult result;
+			result.AllSolid = false;
+			result.StartSolid = false;
+			result.Fraction = 1.0f;
+			result.EndPos = end;
+			result.PlaneNormal = Vector(0, 0, 0);
+			result.HitEntity = false;
+			return result;
+		}
+
+		virtual TraceResult TracePlayerForGround(const Vector& start, const Vector& end, HullType hull) override
+		{
+			return TracePlayer(start, end, hull);
+		}
+
+	private:
+		bool onGround;
+	};
+
+	bool CanUnduck(const PlayerData& player, const StrafeConfig& config, ITraceProvider& traces);
+
+	PositionType GetPositionType(PlayerData& player,
+	                             HullType hull,
+	                             const StrafeConfig& config,
+	                             ITraceProvider& traces);
+
+	PositionType Move(PlayerData& player,
+	                  const MovementVars& vars,
+	                  const StrafeConfig& config,
+	                  ITraceProvider& traces);
+
+	double MaxAccelTheta(const PlayerData& player, const MovementVars& vars, bool onground, double wishspeed);
+
+	double MaxAccelIntoYawTheta(const PlayerData& player,
+	                            const MovementVars& vars,
+	                            bool onground,
+	                            double wishspeed,
+	                            double vel_yaw,
+	                            double yaw);
+
+	double MaxAngleTheta(const PlayerData& player,
+	                     const MovementVars& vars,
+	                     bool onground,
+	                     double wishspeed,
+	                     bool& safeguard_yaw);
+
+	void VectorFME(PlayerData& player,
+	               const MovementVars& vars,
+	               bool onground,
+	               double wishspeed,
+	               const Vector2D& a);
+
+	double ButtonsPhi(Button button);
+
+	Button GetBestButtons(double theta, bool right);
+
+	void SideStrafeGeneral(const PlayerData& player,
+	                       const MovementVars& vars,
+	                       bool onground,
+	                       double wishspeed,
+	                       const StrafeButtons& strafeButtons,
+	                       bool useGivenButtons,
+	                       Button& usedButton,
+	                       double vel_yaw,
+	                       double theta,
+	                       bool right,
+	                       Vector2D& velocity,
+	                       double& yaw);
+
+	double YawStrafeMaxAccel(PlayerData& player,
+	                         const MovementVars& vars,
+	                         bool onground,
+	                         double wishspeed,
+	                         const StrafeButtons& strafeButtons,
+	                         bool useGivenButtons,
+	                         Button& usedButton,
+	                         double vel_yaw,
+	                         double yaw);
+
+	double YawStrafeMaxAngle(PlayerData& player,
+	                         const MovementVars& vars,
+	                         bool onground,
+	                         double wishspeed,
+	                         const StrafeButtons& strafeButtons,
+	                         bool useGivenButtons,
+	                         Button& usedButton,
+	                         double vel_yaw,
+	                         double yaw);
+
+	void StrafeVectorial(PlayerData& player,
+	                     const MovementVars& vars,
+	                     const StrafeInput& strafeInput,
+	                     bool jumped,
+	                     StrafeType type,
+	                     StrafeDir dir,
+	                     double vel_yaw,
+	                     ProcessedFrame& out,
+	                     bool lockCamera,
+	                     const StrafeConfig& config);
+
+	bool Strafe(PlayerData& player,
+	            const MovementVars& vars,
+	            const StrafeInput& strafeInput,
+	            bool jumped,
+	            StrafeType type,
+	            StrafeDir dir,
+	            double vel_yaw,
+	            ProcessedFrame& out,
+	            const StrafeButtons& strafeButtons,
+	            bool useGivenButtons,
+	            const StrafeConfig& config);
+
+	void Friction(PlayerData& player, bool onground, const MovementVars& vars);
+
+	bool LgagstJump(PlayerData& player, const MovementVars& vars, const StrafeConfig& config);
+
+	// Vertical speed of a jump off the ground, the game's CheckJumpButton with GAMEMOVEMENT_JUMP_HEIGHT
+	float JumpSpeed(const MovementVars& vars);
+} // namespace Strafe
@@ -0,0 +1,373 @@
+#include "stdafx.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include "strafe_lookahead.hpp"
+#include "strafe_utils.hpp"
+
+namespace Strafe
+{
+	// How many more sequences than the beam width get moved before the beam is cut, the cheap score that picks
+	// them doesn't know about collisions
+	static const size_t MOVED_PER_KEPT = 2;
+
+	template<typename T>
+	static void KeepBest(std::vector<T>& items, size_t count)
+	{
+		auto better = [](const T& a, const T& b) { return a.score > b.score; };
+		if (items.size() > count)
+		{
+			std::nth_element(items.begin(), items.begin() + count, items.end(), better);
+			items.resize(count);
+		}
+		std::sort(items.begin(), items.end(), better);
+	}
+
+	double LookaheadPlanner::Plan(const PlayerData& player,
+	                              const MovementVars& vars,
+	                              bool jumped,
+	                              double targetYaw,
+	                              const StrafeConfig& config,
+	                              ITraceProvider& traces,
+	                              const LookaheadSettings& settings)
+	{
+		auto start = std::chrono::steady_clock::now();
+
+		this->settings = settings;
+		this->settings.Horizon = (std::max)(settings.Horizon, 1);
+		this->settings.BeamWidth = (std::max)(settings.BeamWidth, 1);
+		this->settings.Samples = (std::max)(settings.Samples, 0);
+		int horizon = this->settings.Horizon;
+
+		this->jumped = jumped;
+		jumpSpeed = JumpSpeed(vars);
+		wishspeed = vars.Maxspeed;
+		if (vars.ReduceWishspeed)
+			wishspeed *= 0.33333333f;
+		target = targetYaw * M_DEG2RAD;
+		dirX = std::cos(target);
+		dirY = std::sin(target);
+		tailTime = vars.Frametime * horizon;
+		stepsize = vars.Stepsize;
+
+		// The previous plans start a tick later now
+		if (targetYaw != previousTarget)
+			previous.clear();
+		for (auto& sequence : previous)
+		{
+			if (!sequence.empty())
+				sequence.erase(sequence.begin());
+		}
+
+		// The greedy sequence grows with the beam, so it is in the budget and scored at the same depth
+		std::vector<double> best;
+		PlayerData greedy = player;
+		bool greedyOnground = vars.OnGround;
+
+		levels.resize(horizon + 1);
+		levels[0].clear();
+		levels[0].push_back(Node{player, vars.OnGround, -1, -1, 0, Score(player, traces)});
+
+		int reached = 0;
+		for (int depth = 0; depth < horizon; ++depth)
+		{
+			std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+			if (depth > 0 && this->settings.BudgetMs > 0 && elapsed.count() > this->settings.BudgetMs)
+				break;
+
+			Expand(levels[depth], depth, vars, config, traces, levels[depth + 1]);
+			if (levels[depth + 1].empty())
+				break;
+			best.push_back(StepGreedy(greedy, greedyOnground, depth, vars, config, traces));
+			reached = depth + 1;
+		}
+
+		// Sorted best first
+		const auto& beam = levels[reached];
+		if (reached > 0 && beam[0].score > Score(greedy, traces))
+			best.clear();
+
+		previous.clear();
+		if (!best.empty())
+			previous.push_back(best);
+
+		for (size_t i = 0; i < beam.size() && reached > 0; ++i)
+		{
+			std::vector<double> sequence(reached);
+			int index = static_cast<int>(i);
+			for (int depth = reached; depth > 0; --depth)
+			{
+				const Node& node = levels[depth][index];
+				sequence[depth - 1] = node.yaw;
+				index = node.parent;
+			}
+			if (best.empty())
+				best = sequence;
+			previous.push_back(std::move(sequence));
+		}
+		previousTarget = targetYaw;
+
+		return NormalizeDeg(best[0] * M_RAD2DEG);
+	}
+
+	void LookaheadPlanner::Reset()
+	{
+		previous.clear();
+	}
+
+	double LookaheadPlanner::Score(const PlayerData& player, ITraceProvider& traces) const
+	{
+		double progress = player.UnduckedOrigin.x * dirX + player.UnduckedOrigin.y * dirY;
+		double along = (player.Velocity.x * dirX + player.Velocity.y * dirY) * tailTime;
+		if (along <= 0 || !traces.CanTrace())
+			return progress + along;
+
+		// Only as far as the velocity gets before a wall, from a step up so the floor and stairs don't count
+		Vector start = player.UnduckedOrigin;
+		start.z += stepsize;
+		Vector end = start;
+		end.x += player.Velocity.x * tailTime;
+		end.y += player.Velocity.y * tailTime;
+		TraceResult tr = traces.TracePlayer(start, end, player.Ducking ? HullType::DUCKED : HullType::NORMAL);
+		if (tr.StartSolid)
+			return progress + along;
+		return progress + along * tr.Fraction;
+	}
+
+	bool LookaheadPlanner::Jumps(const PlayerData& player,
+	                             bool onground,
+	                             size_t depth,
+	                             const MovementVars& vars,
+	                             const StrafeConfig& config) const
+	{
+		if (depth == 0)
+			return jumped;
+		if (!onground || vars.CantJump || !(settings.Autojump || settings.Lgagst))
+			return false;
+		if (settings.Autojump)
+			return true;
+
+		// Checked before friction, like TASFeature::Strafe does
+		PlayerData pl = player;
+		MovementVars groundVars = vars;
+		groundVars.OnGround = true;
+		return LgagstJump(pl, groundVars, config);
+	}
+
+	LookaheadPlanner::TickStart LookaheadPlanner::StartTick(const PlayerData& player,
+	                                                        bool onground,
+	                                                        bool jumps,
+	                                                        const MovementVars& vars,
+	                                                        const StrafeConfig& config) const
+	{
+		TickStart start;
+		start.player = player;
+		start.onground = onground && !jumps;
+		start.move = JumpMove::STRAFE;
+		start.moveYaw = target;
+
+		if (jumps)
+		{
+			// The same choices as StrafeJump, from the velocity before the jump
+			if (config.JumpType == 2)
+			{
+				start.move = JumpMove::FORWARD;
+			}
+			else if (config.JumpType == 3)
+			{
+				start.move = JumpMove::FORWARD;
+				start.moveYaw = Atan2(player.Velocity.y, player.Velocity.x);
+			}
+			else if (config.JumpType == 1)
+			{
+				float cap = vars.Maxspeed * ((player.Ducking || (vars.Maxspeed == 320)) ? 0.1 : 0.5);
+				if (player.Velocity.Length2D() >= cap)
+					start.move = JumpMove::NONE;
+			}
+
+			start.player.Velocity.z = jumpSpeed;
+		}
+
+		Friction(start.player, start.onground, vars);
+		return start;
+	}
+
+	double LookaheadPlanner::StepGreedy(PlayerData& player,
+	                                    bool& onground,
+	                                    size_t depth,
+	                                    const MovementVars& vars,
+	                                    const StrafeConfig& config,
+	                                    ITraceProvider& traces)
+	{
+		bool jumps = Jumps(player, onground, depth, vars, config);
+		TickStart start = StartTick(player, onground, jumps, vars, config);
+		player = start.player;
+
+		double yaw = target;
+		if (start.move == JumpMove::STRAFE)
+		{
+			Button usedButton;
+			yaw = YawStrafeMaxAccel(player,
+			                        vars,
+			                        start.onground,
+			                        wishspeed,
+			                        StrafeButtons(),
+			                        false,
+			                        usedButton,
+			                        target,
+			                        target);
+			// The plan is strafed with forward held, so it keeps wishdirs
+			yaw += ButtonsPhi(usedButton);
+		}
+		else if (start.move == JumpMove::FORWARD)
+		{
+			Vector2D wishdir(std::cos(start.moveYaw), std::sin(start.moveYaw));
+			VectorFME(player, vars, false, wishspeed, wishdir);
+		}
+
+		onground = Move(player, vars, config, traces) == PositionType::GROUND;
+		return yaw;
+	}
+
+	void LookaheadPlanner::Expand(const std::vector<Node>& parents,
+	                              size_t depth,
+	                              const MovementVars& vars,
+	                              const StrafeConfig& config,
+	                              ITraceProvider& traces,
+	                              std::vector<Node>& out)
+	{
+		children.clear();
+		starts.clear();
+
+		for (size_t i = 0; i < parents.size(); ++i)
+		{
+			const Node& parent = parents[i];
+			bool jumps = Jumps(parent.player, parent.onground, depth, vars, config);
+			starts.push_back(StartTick(parent.player, parent.onground, jumps, vars, config));
+			const TickStart& start = starts.back();
+			const PlayerData& pl = start.player;
+
+			// Where the velocity would take it without anything in the way
+			double progress = parent.player.UnduckedOrigin.x * dirX + parent.player.UnduckedOrigin.y * dirY;
+
+			if (start.move != JumpMove::STRAFE)
+			{
+				// The jump type picks the move, the sequence only follows it
+				PlayerData moved = pl;
+				if (start.move == JumpMove::FORWARD)
+				{
+					Vector2D wishdir(std::cos(start.moveYaw), std::sin(start.moveYaw));
+					VectorFME(moved, vars, false, wishspeed, wishdir);
+				}
+
+				int seed = parent.seed;
+				if (depth == 0 && !previous.empty())
+					seed = 0;
+				double along = moved.Velocity.x * dirX + moved.Velocity.y * dirY;
+				children.push_back(Child{static_cast<int>(i),
+				                         seed,
+				                         target,
+				                         moved.Velocity.x,
+				                         moved.Velocity.y,
+				                         progress + along * (vars.Frametime + tailTime)});
+				continue;
+			}
+
+			yaws.clear();
+			yawSeeds.clear();
+
+			double velYaw = target;
+			if (pl.Velocity.x != 0 || pl.Velocity.y != 0)
+				velYaw = Atan2(pl.Velocity.y, pl.Velocity.x);
+			for (int k = 0; k < settings.Samples; ++k)
+				yaws.push_back(velYaw + 2 * M_PI * k / settings.Samples);
+
+			PlayerData greedy = pl;
+			Button usedButton;
+			double yaw = YawStrafeMaxAccel(greedy,
+			                               vars,
+			                               start.onground,
+			                               wishspeed,
+			                               StrafeButtons(),
+			                               false,
+			                               usedButton,
+			                               target,
+			                               target);
+			yaws.push_back(yaw + ButtonsPhi(usedButton));
+			yawSeeds.resize(yaws.size(), -1);
+
+			if (depth == 0)
+			{
+				for (size_t s = 0; s < previous.size(); ++s)
+				{
+					if (previous[s].empty())
+						continue;
+					yaws.push_back(previous[s][0]);
+					yawSeeds.push_back(static_cast<int>(s));
+				}
+			}
+			else if (parent.seed >= 0 && depth < previous[parent.seed].size())
+			{
+				yaws.push_back(previous[parent.seed][depth]);
+				yawSeeds.push_back(parent.seed);
+			}
+
+			velocityX.resize(yaws.size());
+			velocityY.resize(yaws.size());
+			speed.resize(yaws.size());
+			YawBatch batch = {yaws.size(), yaws.data(), velocityX.data(), velocityY.data(), speed.data()};
+			EvaluateYaws(pl, vars, start.onground, wishspeed, Button::FORWARD, batch, BatchMode::FAST);
+
+			// Every wishdir too far ahead of the velocity to accelerate leaves it as it is, one of those is
+			// enough or they fill the beam with copies
+			int coasting = -1;
+			for (size_t k = 0; k < yaws.size(); ++k)
+			{
+				if (velocityX[k] == pl.Velocity.x && velocityY[k] == pl.Velocity.y)
+				{
+					if (coasting >= 0)
+					{
+						// Following the previous plan keeps the seed
+						if (children[coasting].seed < 0)
+						{
+							children[coasting].seed = yawSeeds[k];
+							children[coasting].yaw = yaws[k];
+						}
+						continue;
+					}
+					coasting = static_cast<int>(children.size());
+				}
+
+				double along = velocityX[k] * dirX + velocityY[k] * dirY;
+				children.push_back(Child{static_cast<int>(i),
+				                         yawSeeds[k],
+				                         yaws[k],
+				                         velocityX[k],
+				                         velocityY[k],
+				                         progress + along * (vars.Frametime + tailTime)});
+			}
+		}
+
+		size_t beamWidth = static_cast<size_t>(settings.BeamWidth);
+		KeepBest(children, beamWidth * MOVED_PER_KEPT);
+
+		out.clear();
+		for (const Child& child : children)
+		{
+			Node node;
+			node.player = starts[child.parent].player;
+			node.player.Velocity.x = child.velocityX;
+			node.player.Velocity.y = child.velocityY;
+			node.onground = Move(node.player, vars, config, traces) == PositionType::GROUND;
+			node.parent = child.parent;
+			node.seed = child.seed;
+			node.yaw = child.yaw;
+			node.score = Score(node.player, traces);
+			out.push_back(node);
+		}
+
+		KeepBest(out, beamWidth);
+	}
+} // namespace Strafe
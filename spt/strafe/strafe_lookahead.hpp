@@ -0,0 +1,141 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+#include "strafe_batch.hpp"
+#include "strafe_core.hpp"
+
+namespace Strafe
+{
+	// The tas_strafe_lookahead_* settings
+	struct LookaheadSettings
+	{
+		int Horizon = 8;
+		int BeamWidth = 16;
+		int Samples = 64;
+		double BudgetMs = 2; // 0 for no limit
+		bool Autojump = false; // +jump is held, the player jumps whenever it lands
+		bool Lgagst = false;   // tas_strafe_lgagst, the player jumps when it lands within the lgagst speeds
+	};
+
+	/*
+	* Strafe type LOOKAHEAD. Greedy strafing picks the yaw that is best for the current tick, this looks for the
+	* sequence of yaws that gets the furthest toward the target yaw over the next Horizon ticks and strafes to the
+	* first yaw of it.
+	*
+	* Sequences are grown one tick at a time with Friction, EvaluateYaws and Move. Every sequence is extended with
+	* Samples wishdirs spread around the velocity, the greedy max accel yaw and the yaw the previous tick's plan had
+	* for that tick, and only the best BeamWidth sequences are kept. A sequence is scored by how far it got toward
+	* the target yaw plus how far its velocity would carry it over another Horizon ticks, up to the first wall the
+	* player would hit on the way.
+	*
+	* The search stops early when it runs out of BudgetMs, the best sequence found so far is used then. The greedy
+	* sequence is grown along with the beam and compared at the depth the beam reached, so the result isn't worse
+	* than max accel strafing in the simulation.
+	*
+	* Jump ticks are simulated too, the current one if jumped is set and later ones where a sequence lands with
+	* Autojump or Lgagst. They skip friction, get the jump speed and strafe the way StrafeJump leaves them to:
+	* like an air tick, forward toward the yaw the jump type picks, or not at all above the ABH speed. When the
+	* jump type picks the move the sequences don't branch, and the yaw of the tick is the target yaw, which
+	* StrafeJump expects.
+	*/
+	class LookaheadPlanner
+	{
+	public:
+		// Returns the view yaw in degrees to strafe to with forward held.
+		// The player and vars are from before friction, vars.OnGround is the ground state of this tick, which
+		// is false if the player jumped this tick.
+		double Plan(const PlayerData& player,
+		            const MovementVars& vars,
+		            bool jumped,
+		            double targetYaw,
+		            const StrafeConfig& config,
+		            ITraceProvider& traces,
+		            const LookaheadSettings& settings);
+		void Reset();
+
+	private:
+		// What StrafeJump leaves of the strafing on a jump tick
+		enum class JumpMove
+		{
+			STRAFE,  // strafes like any air tick
+			FORWARD, // forward toward the yaw the jump type picks
+			NONE,    // no acceleration
+		};
+
+		// A node after its jump and friction, ready for the yaw of the tick
+		struct TickStart
+		{
+			PlayerData player;
+			bool onground;
+			JumpMove move;
+			double moveYaw;
+		};
+
+		struct Node
+		{
+			PlayerData player;
+			bool onground;
+			int parent;
+			int seed; // Index of the previous plan this node follows, -1 if none
+			double yaw;
+			double score;
+		};
+
+		struct Child
+		{
+			int parent;
+			int seed;
+			double yaw;
+			float velocityX;
+			float velocityY;
+			double score;
+		};
+
+		double Score(const PlayerData& player, ITraceProvider& traces) const;
+		bool Jumps(const PlayerData& player,
+		           bool onground,
+		           size_t depth,
+		           const MovementVars& vars,
+		           const StrafeConfig& config) const;
+		TickStart StartTick(const PlayerData& player,
+		                    bool onground,
+		                    bool jumps,
+		                    const MovementVars& vars,
+		                    const StrafeConfig& config) const;
+		// Moves the player a tick with max accel strafing, returns the wishdir yaw in radians
+		double StepGreedy(PlayerData& player,
+		                  bool& onground,
+		                  size_t depth,
+		                  const MovementVars& vars,
+		                  const StrafeConfig& config,
+		                  ITraceProvider& traces);
+		void Expand(const std::vector<Node>& parents,
+		            size_t depth,
+		            const MovementVars& vars,
+		            const StrafeConfig& config,
+		            ITraceProvider& traces,
+		            std::vector<Node>& out);
+
+		LookaheadSettings settings;
+		bool jumped = false;
+		float jumpSpeed = 0;
+		double wishspeed = 0;
+		double target = 0; // Radians
+		double dirX = 1;
+		double dirY = 0;
+		double tailTime = 0;
+		float stepsize = 0;
+
+		// Yaw sequences of the last beam, radians, shifted by a tick when the next plan starts
+		std::vector<std::vector<double>> previous;
+		double previousTarget = 0;
+
+		std::vector<std::vector<Node>> levels;
+		std::vector<Child> children;
+		std::vector<TickStart> starts;
+		std::vector<double> yaws;
+		std::vector<int> yawSeeds;
+		std::vector<float> velocityX, velocityY, speed;
+	};
+} // namespace Strafe
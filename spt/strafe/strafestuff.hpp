@@ -1,230 +1,128 @@
 #pragma once
 
-#include "cmodel.h"
+#include <unordered_map>
 
-// This code is a messed up version of hlstrafe,
-// go take a look at that instead:
-// https://github.com/HLTAS/hlstrafe
+#include "cmodel.h"
+#include "strafe_core.hpp"
 
+// In-game side of the strafe core, traces go through the engine and the settings come from the tas_strafe_* cvars
 namespace Strafe
 {
-	struct TraceResult
-	{
-		bool AllSolid;
-		bool StartSolid;
-		float Fraction;
-		Vector EndPos;
-		Vector PlaneNormal;
-		int Entity;
-	};
-
-	struct StrafeInput
-	{
-		double TargetYaw;
-		float VectorialOffset;
-		float AngleSpeed;
-		float Scale;
-		bool AFH;
-		bool Vectorial;
-		bool JumpOverride;
-		bool Strafe;
-		int Version;
-	};
-
-	struct MovementVars
-	{
-		float Accelerate;
-		float Airaccelerate;
-		float EntFriction;
-		float Frametime;
-		float Friction;
-		float Maxspeed;
-		float Stopspeed;
-		float WishspeedCap;
-
-		float EntGravity;
-		float Maxvelocity;
-		float Gravity;
-		float Stepsize;
-		float Bounce;
-
-		bool OnGround;
-		bool CantJump;
-		bool ReduceWishspeed;
-	};
-
-	struct PlayerData
+	class GameTraceProvider : public ITraceProvider
 	{
-		Vector UnduckedOrigin;
-		Vector Velocity;
-		Vector Basevelocity;
-		bool Ducking;
-		bool DuckPressed;
+	public:
+		GameTraceProvider(int version, bool hullIsLine) : version(version), hullIsLine(hullIsLine) {}
+
+		virtual bool CanTrace() override;
+		virtual bool IsGroundEntitySet() override;
+		virtual TraceResult TracePlayer(const Vector& start, const Vector& end, HullType hull) override;
+		virtual TraceResult TracePlayerForGround(const Vector& start,
+		                                         const Vector& end,
+		                                         HullType hull) override;
+
+	private:
+		int version;
+		bool hullIsLine;
 	};
 
-	enum class Button : unsigned char
+	/*
+	* Remembers the traces of GameTraceProvider. In one tick PlayerIO, TAS strafing and autojump all trace the
+	* same hulls from the same origin, and every one of those swaps the move data and goes through the engine.
+	* Everything is forgotten when the tick changes or the player moves.
+	*/
+	class TraceCache
 	{
-		FORWARD = 0,
-		FORWARD_LEFT,
-		LEFT,
-		BACK_LEFT,
-		BACK,
-		BACK_RIGHT,
-		RIGHT,
-		FORWARD_RIGHT
-	};
+	public:
+		enum class Kind : int
+		{
+			RAY = 0,
+			RAY_LINE, // UTIL_TraceRay with tas_strafe_hull_is_line
+			BBOX,
+			GROUND
+		};
 
-	struct StrafeButtons
-	{
-		StrafeButtons()
-		    : AirLeft(Button::FORWARD)
-		    , AirRight(Button::FORWARD)
-		    , GroundLeft(Button::FORWARD)
-		    , GroundRight(Button::FORWARD)
+		struct Stats
+		{
+			int tickHits = 0;
+			int tickMisses = 0;
+			int lastTickHits = 0;
+			int lastTickMisses = 0;
+			long long hits = 0;
+			long long misses = 0;
+		};
+
+		bool Lookup(const Vector& start,
+		            const Vector& end,
+		            HullType hull,
+		            unsigned int mask,
+		            Kind kind,
+		            TraceResult& result);
+		void Store(const Vector& start,
+		           const Vector& end,
+		           HullType hull,
+		           unsigned int mask,
+		           Kind kind,
+		           const TraceResult& result);
+		void Clear();
+		void OnTick();
+		// Only enabled once OnTick is connected, stale traces would be returned otherwise
+		void SetEnabled(bool enabled)
 		{
+			this->enabled = enabled;
+		}
+		// Lookups still hit the cache while not counting, they just don't show up in the stats
+		void SetCounting(bool counting)
+		{
+			this->counting = counting;
 		}
 
-		Button AirLeft;
-		Button AirRight;
-		Button GroundLeft;
-		Button GroundRight;
-	};
-
-	struct ProcessedFrame
-	{
-		bool Processed; // Should apply strafing in ClientDLL?
-		bool Forward;
-		bool Back;
-		bool Right;
-		bool Left;
-		bool Jump;
-		bool ForceUnduck;
-
-		double Yaw;
-		float ForwardSpeed;
-		float SideSpeed;
-
-		ProcessedFrame()
-		    : Processed(false)
-		    , Forward(false)
-		    , Back(false)
-		    , Right(false)
-		    , Left(false)
-		    , Jump(false)
-		    , Yaw(0)
-		    , ForwardSpeed(0)
-		    , SideSpeed(0)
-		    , ForceUnduck(false)
+		const Stats& GetStats() const
 		{
+			return stats;
 		}
-	};
 
-	struct CurrentState
-	{
-		float LgagstMinSpeed;
-		bool LgagstFullMaxspeed;
-	};
+	private:
+		// Only 4 byte fields, so it can be hashed and compared as bytes
+		struct Key
+		{
+			Vector start;
+			Vector end;
+			int hull;
+			unsigned int mask;
+			int kind;
 
-	enum class StrafeType
-	{
-		MAXACCEL = 0,
-		MAXANGLE = 1,
-		CAPPED = 2,
-		DIRECTION = 3
-	};
+			bool operator==(const Key& other) const;
+		};
 
-	enum class StrafeDir
-	{
-		LEFT = 0,
-		RIGHT = 1,
-		YAW = 3,
-		BUTTONS = 4
-	};
+		struct KeyHash
+		{
+			size_t operator()(const Key& key) const;
+		};
 
-	enum class PositionType
-	{
-		GROUND = 0,
-		AIR,
-		WATER
-	};
+		static Key MakeKey(const Vector& start, const Vector& end, HullType hull, unsigned int mask, Kind kind);
 
-	enum class HullType : int
-	{
-		NORMAL = 0,
-		DUCKED = 1,
-		POINT = 2
+		std::unordered_map<Key, TraceResult, KeyHash> traces;
+		Vector playerOrigin = Vector(0, 0, 0);
+		bool tickChanged = true;
+		bool enabled = false;
+		bool counting = true;
+		Stats stats;
 	};
 
-	void TracePlayer(trace_t& trace, const Vector& start, const Vector& end, HullType hull);
+	extern TraceCache g_TraceCache;
+
+	StrafeConfig GetStrafeConfig();
+	GameTraceProvider GetGameTraceProvider(const StrafeConfig& config);
+
 	void Trace(trace_t& trace, const Vector& start, const Vector& end);
 
+	// The core functions with the current cvar settings and engine traces
 	bool CanUnduck(const PlayerData& player);
 
 	PositionType GetPositionType(PlayerData& player, HullType hull);
 
 	PositionType Move(PlayerData& player, const MovementVars& vars);
 
-	// Convert both arguments to doubles.
-	double Atan2(double a, double b);
-
-	double MaxAccelTheta(const PlayerData& player, const MovementVars& vars, bool onground, double wishspeed);
-
-	double MaxAccelIntoYawTheta(const PlayerData& player,
-	                            const MovementVars& vars,
-	                            bool onground,
-	                            double wishspeed,
-	                            double vel_yaw,
-	                            double yaw);
-
-	double MaxAngleTheta(const PlayerData& player,
-	                     const MovementVars& vars,
-	                     bool onground,
-	                     double wishspeed,
-	                     bool& safeguard_yaw);
-
-	void VectorFME(PlayerData& player,
-	               const MovementVars& vars,
-	               bool onground,
-	               double wishspeed,
-	               const Vector2D& a);
-
-	double ButtonsPhi(Button button);
-
-	Button GetBestButtons(double theta, bool right);
-
-	void SideStrafeGeneral(const PlayerData& player,
-	                       const MovementVars& vars,
-	                       bool onground,
-	                       double wishspeed,
-	                       const StrafeButtons& strafeButtons,
-	                       bool useGivenButtons,
-	                       Button& usedButton,
-	                       double vel_yaw,
-	                       double theta,
-	                       bool right,
-	                       Vector2D& velocity,
-	                       double& yaw);
-
-	double YawStrafeMaxAccel(PlayerData& player,
-	                         const MovementVars& vars,
-	                         bool onground,
-	                         double wishspeed,
-	                         const StrafeButtons& strafeButtons,
-	                         bool useGivenButtons,
-	                         Button& usedButton,
-	                         double vel_yaw,
-	                         double yaw);
-
-	double YawStrafeMaxAngle(PlayerData& player,
-	                         const MovementVars& vars,
-	                         bool onground,
-	                         double wishspeed,
-	                         const StrafeButtons& strafeButtons,
-	                         bool useGivenButtons,
-	                         Button& usedButton,
-	                         double vel_yaw,
-	                         double yaw);
-
 	void StrafeVectorial(PlayerData& player,
 	                     const MovementVars& vars,
 	                     const StrafeInput& strafeInput,
@@ -246,7 +144,5 @@ namespace Strafe
 	            const StrafeButtons& strafeButtons,
 	            bool useGivenButtons);
 
-	void Friction(PlayerData& player, bool onground, const MovementVars& vars);
-
 	bool LgagstJump(PlayerData& player, const MovementVars& vars);
 } // namespace Strafe
@@ -0,0 +1,23 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+struct afterframes_stream_entry_t
+{
+	int framesLeft;
+	const std::string* command; // owned by the stream
+};
+
+// Entries that are generated while the queue advances and added to it a window at a time, so that long scripts
+// never sit in memory or in the queue in full. They run on the same frames and in the same order as if they had all
+// been added at once.
+class AfterframesStream
+{
+public:
+	virtual ~AfterframesStream() {}
+	// Entries have to come out sorted by framesLeft, entries due on the same frame run in the order they come out.
+	// Returns false once there are none left.
+	virtual bool Next(afterframes_stream_entry_t& entry) = 0;
+	// Number of entries Next will return, they take up that many sequence numbers of the queue
+	virtual size_t GetCount() const = 0;
+};
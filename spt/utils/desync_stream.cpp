@@ -0,0 +1,123 @@
+#include "stdafx.hpp"
+#include "desync_stream.hpp"
+
+#include <algorithm>
+
+#include "hash_utils.hpp"
+
+namespace desync
+{
+	uint64_t HashPlayer(const PlayerState& state)
+	{
+		return utils::Fnv1a64(&state, sizeof(state));
+	}
+
+	uint64_t HashEntity(uint64_t hash, int index, const float origin[3])
+	{
+		hash = utils::Fnv1a64(&index, sizeof(index), hash);
+		return utils::Fnv1a64(origin, 3 * sizeof(float), hash);
+	}
+
+	bool StreamWriter::Open(const std::string& fileName, uint32_t flags)
+	{
+		Close();
+
+		os.open(fileName, std::ios::binary | std::ios::trunc);
+		if (!os.is_open())
+			return false;
+
+		StreamHeader header;
+		header.magic = STREAM_MAGIC;
+		header.version = STREAM_VERSION;
+		header.flags = flags;
+		os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+		pending.clear();
+		pending.reserve(FLUSH_INTERVAL);
+		tick = 0;
+		chainHash = utils::FNV1A_64_OFFSET;
+		return true;
+	}
+
+	void StreamWriter::AddTick(int32_t seed, uint64_t playerHash, uint64_t entityHash)
+	{
+		StreamRecord record;
+		record.tick = tick++;
+		record.seed = seed;
+		record.playerHash = playerHash;
+		record.entityHash = entityHash;
+		chainHash = utils::Fnv1a64(&record, offsetof(StreamRecord, chainHash), chainHash);
+		record.chainHash = chainHash;
+
+		pending.push_back(record);
+		if (pending.size() >= FLUSH_INTERVAL)
+			Flush();
+	}
+
+	void StreamWriter::Close()
+	{
+		if (!os.is_open())
+			return;
+
+		Flush();
+		os.close();
+	}
+
+	void StreamWriter::Flush()
+	{
+		if (pending.empty())
+			return;
+
+		os.write(reinterpret_cast<const char*>(pending.data()), pending.size() * sizeof(StreamRecord));
+		os.flush();
+		pending.clear();
+	}
+
+	bool StreamReader::Open(const std::string& fileName)
+	{
+		is.open(fileName, std::ios::binary | std::ios::ate);
+		if (!is.is_open())
+			return false;
+
+		std::streamoff size = is.tellg();
+		is.seekg(0);
+		if (size < (std::streamoff)sizeof(StreamHeader)
+		    || !is.read(reinterpret_cast<char*>(&header), sizeof(StreamHeader)) || header.magic != STREAM_MAGIC
+		    || header.version != STREAM_VERSION)
+			return false;
+
+		// A partially written last record is ignored
+		count = static_cast<size_t>((size - sizeof(StreamHeader)) / sizeof(StreamRecord));
+		reads = 0;
+		return true;
+	}
+
+	bool StreamReader::Read(size_t index, StreamRecord& record)
+	{
+		++reads;
+		is.seekg(sizeof(StreamHeader) + index * sizeof(StreamRecord));
+		return static_cast<bool>(is.read(reinterpret_cast<char*>(&record), sizeof(StreamRecord)));
+	}
+
+	bool FindFirstDifference(StreamReader& a, StreamReader& b, size_t& index)
+	{
+		// The chain hashes differ from the first differing record on
+		StreamRecord recordA, recordB;
+		size_t low = 0;
+		size_t high = (std::min)(a.count, b.count);
+		while (low < high)
+		{
+			size_t middle = low + (high - low) / 2;
+			if (!a.Read(middle, recordA) || !b.Read(middle, recordB))
+				return false;
+
+			if (recordA.chainHash != recordB.chainHash)
+				high = middle;
+			else
+				low = middle + 1;
+		}
+
+		index = low;
+		return true;
+	}
+} // namespace desync
@@ -0,0 +1,103 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/*
+* Desync streams, one record per tick while recording. Records have a fixed size, so two streams can be lined up
+* by record index and compared without reading them whole. The chain hash covers every record up to and including
+* its own, so once two streams differ they never match again, which is what lets the comparison binary search.
+*
+* Layout, little endian:
+*	char magic[4] "SPTD", uint32 version, uint32 flags
+*	then per tick: int32 tick, int32 seed, uint64 playerHash, uint64 entityHash, uint64 chainHash
+*
+* tick counts the ticks since the recording started, seed is the prediction random seed, playerHash hashes the
+* player origin, velocity and view angles and entityHash the origins of all server entities (0 when not recorded).
+*/
+namespace desync
+{
+	const char* const STREAM_EXT = ".sptd";
+	const uint32_t STREAM_MAGIC = 0x44545053; // "SPTD"
+	const uint32_t STREAM_VERSION = 1;
+	const uint32_t FLAG_ENTITIES = 1;
+	const int FLUSH_INTERVAL = 256; // records kept in memory before they are written
+
+#pragma pack(push, 1)
+	struct StreamHeader
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t flags;
+	};
+
+	struct StreamRecord
+	{
+		int32_t tick;
+		int32_t seed;
+		uint64_t playerHash;
+		uint64_t entityHash;
+		uint64_t chainHash;
+	};
+#pragma pack(pop)
+
+	struct PlayerState
+	{
+		float origin[3];
+		float velocity[3];
+		float angles[3];
+	};
+
+	uint64_t HashPlayer(const PlayerState& state);
+	// Chains one entity into the hash of all entities, the index counts so an entity moving to another slot differs
+	uint64_t HashEntity(uint64_t hash, int index, const float origin[3]);
+
+	// Writes a stream, the records are buffered and written every FLUSH_INTERVAL ticks
+	class StreamWriter
+	{
+	public:
+		bool Open(const std::string& fileName, uint32_t flags);
+		void AddTick(int32_t seed, uint64_t playerHash, uint64_t entityHash);
+		void Close();
+		bool IsOpen() const
+		{
+			return os.is_open();
+		}
+		int32_t GetTicks() const
+		{
+			return tick;
+		}
+
+	private:
+		void Flush();
+
+		std::ofstream os;
+		std::vector<StreamRecord> pending;
+		int32_t tick = 0;
+		uint64_t chainHash = 0;
+	};
+
+	// Opens a stream for reading record by record
+	class StreamReader
+	{
+	public:
+		bool Open(const std::string& fileName);
+		bool Read(size_t index, StreamRecord& record);
+
+		StreamHeader header;
+		size_t count = 0;
+		size_t reads = 0; // records read so far
+
+	private:
+		std::ifstream is;
+	};
+
+	/*
+	* Binary searches the chain hashes for the first record where the streams differ, reading O(log n) records of
+	* each. Sets index to the smaller record count if one stream is a prefix of the other. Returns false if a record
+	* couldn't be read.
+	*/
+	bool FindFirstDifference(StreamReader& a, StreamReader& b, size_t& index);
+} // namespace desync
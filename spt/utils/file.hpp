@@ -2,4 +2,4 @@
 #include <string>
 
 bool FileExists(const std::string& fileName);
-std::string GetGameDir();
\ No newline at end of file
+std::string GetGameDir();
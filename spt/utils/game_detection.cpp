@@ -3,7 +3,8 @@
 #include "SPTLib\sptlib.hpp"
 #include "SPTLib\MemUtils.hpp"
 #include "interfaces.hpp"
-#include "thirdparty\kmp-cpp.hpp"
+#include "pe_image.hpp"
+#include "simd_search.hpp"
 #include <atomic>
 #include <thread>
 #include <future>
@@ -221,15 +222,26 @@ namespace utils
 			    {
 				    moduleEnd = moduleStart + moduleSize;
 				    const char* BUILD_STRING = "Exe build:";
-				    const uint8_t* beginNeedle = reinterpret_cast<const uint8_t*>(BUILD_STRING);
-				    const uint8_t* endNeedle = beginNeedle + strlen(BUILD_STRING);
-
-				    int match = kmp::match_first(beginNeedle, endNeedle, moduleStart, moduleEnd);
+				    const uint8_t* needleBytes = reinterpret_cast<const uint8_t*>(BUILD_STRING);
+				    SimdPattern needle(needleBytes, strlen(BUILD_STRING));
+				    const uint8_t* match = nullptr;
+
+				    // the string is in read-only data, only look at the rest if it's not there
+				    PEImage image;
+				    image.Parse(moduleStart, moduleSize);
+				    for (auto sectionClass : {SectionClass::RData, SectionClass::Any})
+				    {
+					    for (auto& range : image.GetRanges(sectionClass))
+					    {
+						    const uint8_t* rangeStart = moduleStart + range.first;
+						    if (!match)
+							    match = needle.Find(rangeStart, moduleStart + range.second);
+					    }
+				    }
 
-				    if (match >= 0)
+				    if (match)
 				    {
-					    const char* wholeString =
-					        reinterpret_cast<const char*>(moduleStart) + match;
+					    const char* wholeString = reinterpret_cast<const char*>(match);
 					    DevMsg("Found date string: %s\n", wholeString);
 					    const char* date_str = wholeString + 20;
 					    build_num = DateToBuildNumber(date_str);
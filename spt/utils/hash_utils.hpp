@@ -0,0 +1,22 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace utils
+{
+	const uint64_t FNV1A_64_OFFSET = 14695981039346656037ULL;
+	const uint64_t FNV1A_64_PRIME = 1099511628211ULL;
+
+	// 64-bit FNV-1a, pass the previous result as the hash to chain several buffers into one hash
+	inline uint64_t Fnv1a64(const void* data, size_t size, uint64_t hash = FNV1A_64_OFFSET)
+	{
+		auto bytes = static_cast<const uint8_t*>(data);
+		for (size_t i = 0; i < size; ++i)
+		{
+			hash ^= bytes[i];
+			hash *= FNV1A_64_PRIME;
+		}
+
+		return hash;
+	}
+} // namespace utils
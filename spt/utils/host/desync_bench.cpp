@@ -0,0 +1,117 @@
+// Times what spt_desync_record costs per tick, the way DesyncFeature::OnTick records: the player state hash and
+// the record written by StreamWriter, and with spt_desync_record_ents the origin hash of every entity on top. The
+// entity origins come from an array here, in the game they are read through the edicts. Then times
+// spt_desync_compare on two of the recordings.
+//
+// Usage: desync_bench [ticks] [entities]   (100000 ticks and 1024 entities by default)
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <random>
+#include <vector>
+
+#include "desync_stream.hpp"
+#include "hash_utils.hpp"
+
+namespace fs = std::filesystem;
+using namespace desync;
+
+namespace
+{
+	struct Entity
+	{
+		float origin[3];
+	};
+
+	// Returns the nanoseconds per tick
+	double Record(const fs::path& path, int ticks, std::vector<Entity>& entities, bool recordEntities, int from)
+	{
+		std::mt19937 rng(1234);
+		std::uniform_real_distribution<float> move(-1.0f, 1.0f);
+		PlayerState state = {};
+		uint32_t flags = recordEntities ? FLAG_ENTITIES : 0;
+
+		StreamWriter writer;
+		if (!writer.Open(path.string(), flags))
+			return 0;
+
+		double seconds = 0;
+		for (int tick = 0; tick < ticks; ++tick)
+		{
+			// Moving things around isn't part of the cost
+			state.origin[0] += move(rng);
+			state.angles[1] = static_cast<float>(tick % 360);
+			if (tick == from)
+				state.velocity[2] = 1.0f;
+			for (auto& entity : entities)
+				entity.origin[2] += move(rng);
+
+			auto start = std::chrono::steady_clock::now();
+			uint64_t entityHash = 0;
+			if (recordEntities)
+			{
+				entityHash = utils::FNV1A_64_OFFSET;
+				for (int i = 0; i < static_cast<int>(entities.size()); ++i)
+					entityHash = HashEntity(entityHash, i, entities[i].origin);
+			}
+			writer.AddTick(tick % 256, HashPlayer(state), entityHash);
+			std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+			seconds += elapsed.count();
+		}
+
+		auto start = std::chrono::steady_clock::now();
+		writer.Close();
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+		seconds += elapsed.count();
+		return seconds * 1e9 / ticks;
+	}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+	int ticks = argc > 1 ? std::atoi(argv[1]) : 100000;
+	int entityCount = argc > 2 ? std::atoi(argv[2]) : 1024;
+	if (ticks <= 0 || entityCount < 0)
+	{
+		std::printf("Usage: desync_bench [ticks] [entities]\n");
+		return 1;
+	}
+
+	fs::path dir = fs::temp_directory_path() / "spt_desync_bench";
+	fs::create_directories(dir);
+	fs::path playerPath = dir / (std::string("player") + STREAM_EXT);
+	fs::path otherPath = dir / (std::string("other") + STREAM_EXT);
+	fs::path entitiesPath = dir / (std::string("entities") + STREAM_EXT);
+
+	std::vector<Entity> entities(entityCount);
+	int from = ticks * 2 / 3;
+	double player = Record(playerPath, ticks, entities, false, -1);
+	Record(otherPath, ticks, entities, false, from);
+	double withEntities = Record(entitiesPath, ticks, entities, true, -1);
+
+	std::printf("%d ticks, %u bytes per tick\n", ticks, static_cast<unsigned>(sizeof(StreamRecord)));
+	std::printf("player:             %8.1f ns per tick\n", player);
+	std::printf("with %5d entities: %8.1f ns per tick\n", entityCount, withEntities);
+
+	StreamReader a, b;
+	if (!a.Open(playerPath.string()) || !b.Open(otherPath.string()))
+	{
+		std::printf("Unable to read the recordings\n");
+		return 2;
+	}
+
+	size_t first = 0;
+	auto start = std::chrono::steady_clock::now();
+	bool read = FindFirstDifference(a, b, first);
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	std::printf("compare: first difference at %u in %.1f us, %u records read of each\n",
+	            static_cast<unsigned>(first),
+	            elapsed.count() * 1e6,
+	            static_cast<unsigned>(a.reads));
+
+	std::error_code ec;
+	fs::remove_all(dir, ec);
+	return read && first == static_cast<size_t>(from) ? 0 : 2;
+}
@@ -0,0 +1,209 @@
+// Checks the desync stream format: the header and record layout, the chain hash of every record across the flushes
+// of the writer, and that a partially written last record is ignored. Then checks that the comparison finds the
+// first differing record of two streams while reading O(log n) records of each.
+//
+// Usage: desync_stream_test, returns 1 if a check failed
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "desync_stream.hpp"
+#include "hash_utils.hpp"
+
+namespace fs = std::filesystem;
+using namespace desync;
+
+namespace
+{
+	int failures = 0;
+
+#define CHECK(condition) \
+	do \
+	{ \
+		if (!(condition)) \
+		{ \
+			std::printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+			++failures; \
+		} \
+	} while (0)
+
+	int32_t Seed(int tick)
+	{
+		return tick * 31 % 256;
+	}
+
+	uint64_t PlayerHash(int tick)
+	{
+		PlayerState state = {};
+		state.origin[0] = tick * 0.25f;
+		state.velocity[1] = 320.0f;
+		state.angles[1] = tick % 360;
+		return HashPlayer(state);
+	}
+
+	// Writes a stream that differs from the plain one from record from on, in the seed or in the entities
+	void Write(const fs::path& path, int ticks, uint32_t flags, int from = -1, bool entities = false)
+	{
+		StreamWriter writer;
+		CHECK(writer.Open(path.string(), flags));
+		for (int tick = 0; tick < ticks; ++tick)
+		{
+			bool differs = from >= 0 && tick >= from;
+			float origin[3] = {1.0f, 2.0f, differs && entities ? 3.5f : 3.0f};
+			uint64_t entityHash = flags & FLAG_ENTITIES ? HashEntity(utils::FNV1A_64_OFFSET, 1, origin) : 0;
+			writer.AddTick(Seed(tick) + (differs && !entities ? 1 : 0), PlayerHash(tick), entityHash);
+		}
+		CHECK(writer.GetTicks() == ticks);
+		writer.Close();
+	}
+
+	void TestFormat(const fs::path& dir)
+	{
+		CHECK(sizeof(StreamHeader) == 12);
+		CHECK(sizeof(StreamRecord) == 32);
+
+		// Around the flush interval, the records kept in memory have to be written on close
+		for (int ticks : {0, 1, FLUSH_INTERVAL - 1, FLUSH_INTERVAL, FLUSH_INTERVAL + 1, 1000})
+		{
+			fs::path path = dir / ("format_" + std::to_string(ticks) + STREAM_EXT);
+			Write(path, ticks, FLAG_ENTITIES);
+			CHECK(fs::file_size(path) == sizeof(StreamHeader) + ticks * sizeof(StreamRecord));
+
+			StreamReader reader;
+			CHECK(reader.Open(path.string()));
+			CHECK(reader.header.magic == STREAM_MAGIC);
+			CHECK(reader.header.version == STREAM_VERSION);
+			CHECK(reader.header.flags == FLAG_ENTITIES);
+			CHECK(reader.count == static_cast<size_t>(ticks));
+
+			uint64_t chain = utils::FNV1A_64_OFFSET;
+			bool recordsMatch = true;
+			for (int tick = 0; tick < ticks; ++tick)
+			{
+				StreamRecord record;
+				CHECK(reader.Read(tick, record));
+				chain = utils::Fnv1a64(&record, 24, chain);
+				recordsMatch = recordsMatch && record.tick == tick && record.seed == Seed(tick)
+				               && record.playerHash == PlayerHash(tick) && record.entityHash != 0
+				               && record.chainHash == chain;
+			}
+			CHECK(recordsMatch);
+		}
+
+		// The magic is the bytes "SPTD"
+		fs::path path = dir / (std::string("format_1") + STREAM_EXT);
+		char magic[4];
+		std::ifstream(path, std::ios::binary).read(magic, sizeof(magic));
+		CHECK(std::string(magic, 4) == "SPTD");
+	}
+
+	void TestTruncated(const fs::path& dir)
+	{
+		fs::path path = dir / (std::string("truncated") + STREAM_EXT);
+		Write(path, 10, 0);
+		fs::resize_file(path, sizeof(StreamHeader) + 9 * sizeof(StreamRecord) + 5);
+
+		StreamReader reader;
+		CHECK(reader.Open(path.string()));
+		CHECK(reader.count == 9);
+
+		fs::resize_file(path, sizeof(StreamHeader) - 1);
+		StreamReader cut;
+		CHECK(!cut.Open(path.string()));
+
+		std::ofstream(path, std::ios::binary) << "SPTX and more bytes than a header";
+		StreamReader other;
+		CHECK(!other.Open(path.string()));
+		CHECK(!other.Open((dir / "missing").string()));
+	}
+
+	// A binary search over n records, each step reads one record of both streams
+	size_t MaxReads(size_t count)
+	{
+		size_t steps = 0;
+		while (count > 0)
+		{
+			count /= 2;
+			++steps;
+		}
+		return steps;
+	}
+
+	void CheckDifference(const fs::path& a, const fs::path& b, size_t expected)
+	{
+		StreamReader readerA, readerB;
+		CHECK(readerA.Open(a.string()));
+		CHECK(readerB.Open(b.string()));
+
+		size_t first = 0;
+		CHECK(FindFirstDifference(readerA, readerB, first));
+		if (first != expected)
+		{
+			std::printf("%s and %s: expected the first difference at %u, got %u\n",
+			            a.filename().string().c_str(),
+			            b.filename().string().c_str(),
+			            static_cast<unsigned>(expected),
+			            static_cast<unsigned>(first));
+			++failures;
+		}
+
+		size_t maxReads = MaxReads((std::min)(readerA.count, readerB.count));
+		CHECK(readerA.reads <= maxReads);
+		CHECK(readerB.reads <= maxReads);
+	}
+
+	void TestFindFirstDifference(const fs::path& dir)
+	{
+		const int TICKS = 5000;
+		fs::path base = dir / (std::string("base") + STREAM_EXT);
+		Write(base, TICKS, 0);
+		CheckDifference(base, base, TICKS);
+
+		for (int from : {0, 1, 255, 256, 2500, 4095, TICKS - 1})
+		{
+			fs::path seed = dir / ("seed_" + std::to_string(from) + STREAM_EXT);
+			Write(seed, TICKS, 0, from);
+			CheckDifference(base, seed, from);
+			CheckDifference(seed, base, from);
+		}
+
+		// Only the entities differ
+		fs::path entities = dir / (std::string("entities") + STREAM_EXT);
+		fs::path movedEntities = dir / (std::string("moved_entities") + STREAM_EXT);
+		Write(entities, TICKS, FLAG_ENTITIES);
+		Write(movedEntities, TICKS, FLAG_ENTITIES, 1234, true);
+		CheckDifference(entities, movedEntities, 1234);
+
+		// One recording went on for longer
+		fs::path shorter = dir / (std::string("shorter") + STREAM_EXT);
+		Write(shorter, 3000, 0);
+		CheckDifference(base, shorter, 3000);
+
+		fs::path empty = dir / (std::string("empty") + STREAM_EXT);
+		Write(empty, 0, 0);
+		CheckDifference(base, empty, 0);
+	}
+} // namespace
+
+int main()
+{
+	fs::path dir = fs::temp_directory_path() / "spt_desync_stream_test";
+	fs::create_directories(dir);
+
+	TestFormat(dir);
+	TestTruncated(dir);
+	TestFindFirstDifference(dir);
+
+	std::error_code ec;
+	fs::remove_all(dir, ec);
+
+	if (failures)
+	{
+		std::printf("%d checks failed\n", failures);
+		return 1;
+	}
+	std::printf("all checks passed\n");
+	return 0;
+}
@@ -0,0 +1,169 @@
+"""
+Collects every PATTERNS table of the SPT sources and patterns_archive.hpp into a file that validate_patterns
+compiles, along with the module each table is scanned in.
+
+The module comes from the HOOK_FUNCTION, FIND_PATTERN, FIND_PATTERN_IN and FIND_PATTERN_ALL calls in the same file,
+or from AddPatternHook and AddMatchAllPattern with the module as a string. The archive has no calls, its tables
+take the module from the banner comment above them. Preprocessor conditions are ignored, so tables of every game
+are included. Tables that nothing scans for are left out.
+
+Usage: extract_patterns.py <repository root> <output file>
+"""
+
+import os
+import re
+import sys
+
+MACRO_USE = re.compile(r"\b(HOOK_FUNCTION|FIND_PATTERN|FIND_PATTERN_IN|FIND_PATTERN_ALL)\(\s*(\w+)\s*,\s*(\w+)\s*"
+                       r"(?:,\s*(\w+)\s*)?\)")
+DIRECT_USE = re.compile(r"\b(AddPatternHook|AddMatchAllPattern)\(\s*patterns::(\w+)\s*,\s*\"(\w+)\"")
+BANNER = re.compile(r"/\*+\s*(\w+)\s*\*+/")
+PATTERNS_START = re.compile(r"\bPATTERNS\(\s*(\w+)")
+NAMESPACE_START = re.compile(r"\bnamespace\s+patterns\s*\{")
+ARCHIVE = "patterns_archive.hpp"
+
+
+def skip_literal(text, i):
+    """Returns the index after the string or character literal that starts at i."""
+    quote = text[i]
+    i += 1
+    while text[i] != quote:
+        i += 2 if text[i] == "\\" else 1
+    return i + 1
+
+
+def find_closing(text, i, opening, closing):
+    """Returns the index of the bracket that closes the one at i, skipping comments and literals."""
+    depth = 0
+    while i < len(text):
+        c = text[i]
+        if text.startswith("//", i):
+            i = text.index("\n", i)
+            continue
+        if text.startswith("/*", i):
+            i = text.index("*/", i) + 2
+            continue
+        if c in "\"'":
+            i = skip_literal(text, i)
+            continue
+        if c == opening:
+            depth += 1
+        elif c == closing:
+            depth -= 1
+            if depth == 0:
+                return i
+        i += 1
+    raise ValueError("unbalanced " + opening)
+
+
+def extract_tables(text):
+    """Yields (name, statement, offset) for every PATTERNS statement inside a namespace patterns block."""
+    for block in NAMESPACE_START.finditer(text):
+        begin = block.end() - 1
+        end = find_closing(text, begin, "{", "}")
+        for match in PATTERNS_START.finditer(text, begin, end):
+            close = find_closing(text, match.start() + len("PATTERNS"), "(", ")")
+            yield match.group(1), text[match.start():close + 1], match.start()
+
+
+def find_uses(text):
+    """Returns {table name: [(module, section, match all)]} of the tables the file scans for."""
+    uses = {}
+    for match in MACRO_USE.finditer(text):
+        macro, module, name, section = match.groups()
+        if macro == "FIND_PATTERN_IN" and not section:
+            continue
+        uses.setdefault(name, []).append((module, section or "Any", macro == "FIND_PATTERN_ALL"))
+    for match in DIRECT_USE.finditer(text):
+        function, name, module = match.groups()
+        uses.setdefault(name, []).append((module, "Any", function == "AddMatchAllPattern"))
+    return uses
+
+
+def archive_modules(text):
+    """Returns (offset, module) of the banners of the archive."""
+    return [(match.start(), match.group(1).lower()) for match in BANNER.finditer(text)]
+
+
+def collect(root):
+    sources = []
+    for directory, subdirectories, files in os.walk(os.path.join(root, "spt")):
+        subdirectories[:] = sorted(d for d in subdirectories if d != "host")
+        for file in sorted(files):
+            if file.endswith((".cpp", ".hpp")):
+                sources.append(os.path.join(directory, file))
+    sources.append(os.path.join(root, ARCHIVE))
+
+    tables = []
+    for path in sources:
+        with open(path, encoding="utf-8", errors="replace") as f:
+            text = f.read()
+        relative = os.path.relpath(path, root).replace(os.sep, "/")
+        is_archive = relative == ARCHIVE
+        uses = find_uses(text)
+        banners = archive_modules(text) if is_archive else []
+
+        statements = []
+        rows = []
+        seen = set()
+        for name, statement, offset in extract_tables(text):
+            # Both sides of an #ifdef can define the same table
+            if name in seen:
+                continue
+            seen.add(name)
+
+            if is_archive:
+                modules = [module for start, module in banners if start < offset][-1:]
+                table_uses = [(module, "Any", False) for module in modules]
+            else:
+                table_uses = uses.get(name, [])
+            if not table_uses:
+                continue
+
+            statements.append(statement)
+            for module, section, match_all in sorted(set(table_uses)):
+                rows.append((name, module, section, match_all))
+
+        if rows:
+            tables.append((relative, is_archive, statements, rows))
+    return tables
+
+
+def write(tables, output):
+    lines = [
+        "// Generated by extract_patterns.py from the PATTERNS tables of the SPT sources, don't edit",
+        "",
+    ]
+    for index, (relative, is_archive, statements, rows) in enumerate(tables):
+        lines.append("namespace tables_%d // %s" % (index, relative))
+        lines.append("{")
+        lines.extend("\t" + statement.replace("\n", "\n\t") for statement in statements)
+        lines.append("}")
+        lines.append("")
+
+    lines.append("static const PatternTable PATTERN_TABLES[] = {")
+    for index, (relative, is_archive, statements, rows) in enumerate(tables):
+        for name, module, section, match_all in rows:
+            lines.append("\t{\"%s\", \"%s\", \"%s\", %s, tables_%d::%s.data(), tables_%d::%s.size(), "
+                         "utils::SectionClass::%s, %s},"
+                         % (relative, module, name, "true" if is_archive else "false", index, name, index, name,
+                            section, "true" if match_all else "false"))
+    lines.append("};")
+    lines.append("")
+
+    with open(output, "w", encoding="utf-8") as f:
+        f.write("\n".join(lines))
+
+
+def main():
+    if len(sys.argv) != 3:
+        print("Usage: extract_patterns.py <repository root> <output file>")
+        return 1
+
+    tables = collect(sys.argv[1])
+    write(tables, sys.argv[2])
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,94 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <utility>
+#include <vector>
+
+// Stand-in for SPTLib\patterns.hpp so PATTERNS tables can be compiled without SPTLib. The patterns are parsed at
+// startup instead of at compile time, with the same "8B 0D ?? ??" syntax.
+
+namespace patterns
+{
+	class PatternWrapper
+	{
+	public:
+		PatternWrapper(const char* name, const char* pattern) : patternName(name)
+		{
+			while (*pattern)
+			{
+				if (*pattern == ' ')
+				{
+					++pattern;
+				}
+				else if (*pattern == '?')
+				{
+					while (*pattern == '?')
+						++pattern;
+					data.push_back(0);
+					mask.push_back(0);
+				}
+				else
+				{
+					char hex[3] = {pattern[0], pattern[1], 0};
+					pattern += pattern[1] ? 2 : 1;
+					data.push_back(static_cast<uint8_t>(std::strtoul(hex, nullptr, 16)));
+					mask.push_back(0xFF);
+				}
+			}
+		}
+
+		// The name of the build the pattern is for
+		const char* name() const
+		{
+			return patternName;
+		}
+		size_t length() const
+		{
+			return data.size();
+		}
+		const uint8_t* bytes() const
+		{
+			return data.data();
+		}
+		bool match(const uint8_t* memory) const
+		{
+			for (size_t i = 0; i < data.size(); ++i)
+			{
+				if ((memory[i] ^ data[i]) & mask[i])
+					return false;
+			}
+			return true;
+		}
+
+	private:
+		const char* patternName;
+		std::vector<uint8_t> data;
+		std::vector<uint8_t> mask;
+	};
+
+	struct MatchedPattern
+	{
+		int ptnIndex;
+		uintptr_t ptr;
+	};
+
+	template<size_t N, size_t... I>
+	std::array<PatternWrapper, sizeof...(I)> MakePatternArray(const char* const (&list)[N],
+	                                                          std::index_sequence<I...>)
+	{
+		return {PatternWrapper(list[I * 2], list[I * 2 + 1])...};
+	}
+
+	// Name and pattern pairs
+	template<typename... Strings>
+	std::array<PatternWrapper, sizeof...(Strings) / 2> MakePatterns(Strings... strings)
+	{
+		static_assert(sizeof...(Strings) % 2 == 0, "every pattern needs a name");
+		const char* const list[] = {strings...};
+		return MakePatternArray(list, std::make_index_sequence<sizeof...(Strings) / 2>());
+	}
+} // namespace patterns
+
+#define PATTERNS(name, ...) const auto name = ::patterns::MakePatterns(__VA_ARGS__);
@@ -0,0 +1,363 @@
+// Checks PEImage against PE images built by hand: section ranges of raw and mapped images, how sections are
+// classified, RVA conversion and that broken headers are rejected instead of read out of bounds.
+//
+// Usage: pe_image_test, returns 1 if a check failed
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "pe_image.hpp"
+
+using utils::PEImage;
+using utils::SectionClass;
+
+namespace
+{
+	int failures = 0;
+
+#define CHECK(condition) \
+	do \
+	{ \
+		if (!(condition)) \
+		{ \
+			std::printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+			++failures; \
+		} \
+	} while (0)
+
+	typedef std::vector<std::pair<size_t, size_t>> Ranges;
+
+	const uint32_t TEXT = PEImage::SCN_CNT_CODE | PEImage::SCN_MEM_EXECUTE | 0x40000000;
+	const uint32_t RDATA = PEImage::SCN_CNT_INITIALIZED_DATA | 0x40000000;
+	const uint32_t DATA = PEImage::SCN_CNT_INITIALIZED_DATA | 0x40000000 | PEImage::SCN_MEM_WRITE;
+
+	const size_t NT_OFFSET = 0x80;
+	const uint32_t FILE_ALIGNMENT = 0x200;
+	const uint32_t SECTION_ALIGNMENT = 0x1000;
+
+	struct SectionSpec
+	{
+		const char* name;
+		uint32_t virtualSize;
+		uint32_t rawSize;
+		uint32_t characteristics;
+	};
+
+	// Lays an image out like a linker would: headers in the first file alignment block, sections after them in
+	// order, each starting on the next file and section alignment
+	struct ImageBuilder
+	{
+		bool is64Bit = false;
+		uint32_t timestamp = 0x5F3759DF;
+		std::vector<SectionSpec> sections;
+		std::vector<std::pair<uint32_t, uint32_t>> directories;
+
+		// Offsets of the headers, set by Build
+		size_t fileHeader = 0;
+		size_t optHeader = 0;
+		size_t sectionTable = 0;
+		std::vector<uint32_t> virtualAddresses;
+		std::vector<uint32_t> rawOffsets;
+
+		static uint32_t Align(uint32_t value, uint32_t alignment)
+		{
+			return (value + alignment - 1) / alignment * alignment;
+		}
+
+		template<typename T>
+		static void Write(std::vector<uint8_t>& data, size_t offset, T value)
+		{
+			std::memcpy(data.data() + offset, &value, sizeof(T));
+		}
+
+		std::vector<uint8_t> Build()
+		{
+			uint16_t optSize = is64Bit ? 240 : 224;
+			fileHeader = NT_OFFSET + 4;
+			optHeader = fileHeader + 20;
+			sectionTable = optHeader + optSize;
+
+			uint32_t raw = FILE_ALIGNMENT;
+			uint32_t rva = SECTION_ALIGNMENT;
+			virtualAddresses.clear();
+			rawOffsets.clear();
+			for (auto& section : sections)
+			{
+				virtualAddresses.push_back(rva);
+				rawOffsets.push_back(raw);
+				raw += Align(section.rawSize, FILE_ALIGNMENT);
+				rva += Align(section.virtualSize, SECTION_ALIGNMENT);
+			}
+
+			std::vector<uint8_t> data(raw);
+			Write<uint16_t>(data, 0, 0x5A4D);
+			Write<uint32_t>(data, 0x3C, static_cast<uint32_t>(NT_OFFSET));
+			Write<uint32_t>(data, NT_OFFSET, 0x00004550);
+
+			Write<uint16_t>(data, fileHeader, is64Bit ? 0x8664 : 0x14C);
+			Write<uint16_t>(data, fileHeader + 2, static_cast<uint16_t>(sections.size()));
+			Write<uint32_t>(data, fileHeader + 4, timestamp);
+			Write<uint16_t>(data, fileHeader + 16, optSize);
+
+			Write<uint16_t>(data, optHeader, is64Bit ? 0x20B : 0x10B);
+			if (is64Bit)
+				Write<uint64_t>(data, optHeader + 24, 0x180000000ULL);
+			else
+				Write<uint32_t>(data, optHeader + 28, 0x10000000);
+			Write<uint32_t>(data, optHeader + 56, rva);
+			Write<uint32_t>(data, optHeader + 60, FILE_ALIGNMENT);
+
+			size_t directoryCount = optHeader + (is64Bit ? 108 : 92);
+			Write<uint32_t>(data, directoryCount, 16);
+			for (size_t i = 0; i < directories.size(); ++i)
+			{
+				Write<uint32_t>(data, directoryCount + 4 + i * 8, directories[i].first);
+				Write<uint32_t>(data, directoryCount + 8 + i * 8, directories[i].second);
+			}
+
+			for (size_t i = 0; i < sections.size(); ++i)
+			{
+				size_t header = sectionTable + i * 40;
+				std::memcpy(data.data() + header, sections[i].name, std::strlen(sections[i].name));
+				Write<uint32_t>(data, header + 8, sections[i].virtualSize);
+				Write<uint32_t>(data, header + 12, virtualAddresses[i]);
+				Write<uint32_t>(data, header + 16, sections[i].rawSize);
+				Write<uint32_t>(data, header + 20, rawOffsets[i]);
+				Write<uint32_t>(data, header + 36, sections[i].characteristics);
+			}
+
+			return data;
+		}
+	};
+
+	ImageBuilder TypicalDll()
+	{
+		ImageBuilder builder;
+		builder.sections = {
+		    {".text", 0x2345, 0x2400, TEXT},
+		    {".rdata", 0x800, 0x800, RDATA},
+		    {".data", 0x3000, 0x200, DATA}, // mostly .bss
+		    {".reloc", 0x100, 0x200, RDATA | 0x02000000},
+		};
+		builder.directories.resize(6);
+		builder.directories[PEImage::DIRECTORY_BASERELOC] = {0x8000, 0x100};
+		return builder;
+	}
+
+	// Copies a raw image to where the loader would put its sections
+	std::vector<uint8_t> MapImage(const ImageBuilder& builder,
+	                              const std::vector<uint8_t>& raw,
+	                              uint32_t sizeOfImage)
+	{
+		std::vector<uint8_t> mapped(sizeOfImage);
+		std::memcpy(mapped.data(), raw.data(), FILE_ALIGNMENT);
+		for (size_t i = 0; i < builder.sections.size(); ++i)
+		{
+			std::memcpy(mapped.data() + builder.virtualAddresses[i],
+			            raw.data() + builder.rawOffsets[i],
+			            builder.sections[i].rawSize);
+		}
+		return mapped;
+	}
+
+	void TestRawRanges()
+	{
+		ImageBuilder builder = TypicalDll();
+		std::vector<uint8_t> data = builder.Build();
+
+		PEImage image;
+		CHECK(image.Parse(data.data(), data.size(), false));
+		CHECK(image.IsValid());
+		CHECK(!image.Is64Bit());
+		CHECK(image.GetTimestamp() == builder.timestamp);
+		CHECK(image.GetSizeOfImage() == 0x9000);
+		CHECK(image.GetSizeOfHeaders() == FILE_ALIGNMENT);
+		CHECK(image.GetImageBaseOffset() == builder.optHeader + 28);
+		CHECK(image.GetImageBaseSize() == 4);
+
+		auto& sections = image.GetSections();
+		CHECK(sections.size() == 4);
+		if (sections.size() == 4)
+		{
+			CHECK(sections[0].name == ".text");
+			CHECK(sections[1].name == ".rdata");
+			CHECK(sections[2].name == ".data");
+			CHECK(sections[3].name == ".reloc");
+			CHECK(sections[0].virtualAddress == 0x1000 && sections[0].virtualSize == 0x2345);
+			CHECK(sections[0].rawOffset == 0x200 && sections[0].rawSize == 0x2400);
+		}
+
+		CHECK(image.GetRanges(SectionClass::Code) == (Ranges{{0x200, 0x2600}}));
+		CHECK(image.GetRanges(SectionClass::RData) == (Ranges{{0x2600, 0x2E00}, {0x3000, 0x3200}}));
+		CHECK(image.GetRanges(SectionClass::Data) == (Ranges{{0x2E00, 0x3000}}));
+		CHECK(image.GetRanges(SectionClass::Any) == (Ranges{{0, data.size()}}));
+
+		size_t offset = 0;
+		CHECK(image.RvaToOffset(0x1010, offset) && offset == 0x210);
+		CHECK(image.RvaToOffset(0x4004, offset) && offset == 0x2604);
+		CHECK(image.RvaToOffset(0x40, offset) && offset == 0x40);
+		// Past the raw data of .data, only in memory
+		CHECK(!image.RvaToOffset(0x6300, offset));
+		CHECK(!image.RvaToOffset(0x9000, offset));
+
+		uint32_t rva, size;
+		CHECK(image.GetDataDirectory(PEImage::DIRECTORY_BASERELOC, rva, size));
+		CHECK(rva == 0x8000 && size == 0x100);
+		CHECK(!image.GetDataDirectory(0, rva, size));
+		CHECK(!image.GetDataDirectory(16, rva, size));
+		CHECK(!image.GetDataDirectory(-1, rva, size));
+	}
+
+	void TestMappedRanges()
+	{
+		ImageBuilder builder = TypicalDll();
+		std::vector<uint8_t> raw = builder.Build();
+		std::vector<uint8_t> data = MapImage(builder, raw, 0x9000);
+
+		PEImage image;
+		CHECK(image.Parse(data.data(), data.size(), true));
+
+		// Mapped sections cover their virtual size, .bss included
+		CHECK(image.GetRanges(SectionClass::Code) == (Ranges{{0x1000, 0x3345}}));
+		CHECK(image.GetRanges(SectionClass::RData) == (Ranges{{0x4000, 0x4800}, {0x8000, 0x8100}}));
+		CHECK(image.GetRanges(SectionClass::Data) == (Ranges{{0x5000, 0x8000}}));
+
+		size_t offset = 0;
+		CHECK(image.RvaToOffset(0x6300, offset) && offset == 0x6300);
+		CHECK(!image.RvaToOffset(0x9000, offset));
+
+		// A mapping cut short clamps the ranges to the data that is there
+		PEImage truncated;
+		CHECK(truncated.Parse(data.data(), 0x2000, true));
+		CHECK(truncated.GetRanges(SectionClass::Code) == (Ranges{{0x1000, 0x2000}}));
+		CHECK(truncated.GetRanges(SectionClass::Data).empty());
+	}
+
+	void Test64Bit()
+	{
+		ImageBuilder builder = TypicalDll();
+		builder.is64Bit = true;
+		std::vector<uint8_t> data = builder.Build();
+
+		PEImage image;
+		CHECK(image.Parse(data.data(), data.size(), false));
+		CHECK(image.Is64Bit());
+		CHECK(image.GetImageBaseOffset() == builder.optHeader + 24);
+		CHECK(image.GetImageBaseSize() == 8);
+		CHECK(image.GetSections().size() == 4);
+		CHECK(image.GetRanges(SectionClass::Code) == (Ranges{{0x200, 0x2600}}));
+
+		uint32_t rva, size;
+		CHECK(image.GetDataDirectory(PEImage::DIRECTORY_BASERELOC, rva, size) && rva == 0x8000);
+	}
+
+	void TestClassification()
+	{
+		CHECK(PEImage::ClassifySection(TEXT) == SectionClass::Code);
+		// Either flag makes it code, some packers only set one of them
+		CHECK(PEImage::ClassifySection(PEImage::SCN_MEM_EXECUTE) == SectionClass::Code);
+		CHECK(PEImage::ClassifySection(PEImage::SCN_CNT_CODE | PEImage::SCN_MEM_WRITE) == SectionClass::Code);
+		CHECK(PEImage::ClassifySection(RDATA) == SectionClass::RData);
+		CHECK(PEImage::ClassifySection(DATA) == SectionClass::Data);
+		CHECK(PEImage::ClassifySection(0) == SectionClass::RData);
+
+		// An 8 character name has no terminator in the header
+		ImageBuilder builder;
+		builder.sections = {
+		    {".textbss", 0x1000, 0, TEXT | PEImage::SCN_MEM_WRITE},
+		    {".text", 0x100, 0x200, TEXT},
+		};
+		std::vector<uint8_t> data = builder.Build();
+
+		PEImage image;
+		CHECK(image.Parse(data.data(), data.size(), false));
+		CHECK(image.GetSections().size() == 2);
+		if (image.GetSections().size() == 2)
+		{
+			CHECK(image.GetSections()[0].name == ".textbss");
+			CHECK(image.GetSections()[0].sectionClass == SectionClass::Code);
+		}
+		// No raw data, so it's left out of the file ranges
+		CHECK(image.GetRanges(SectionClass::Code) == (Ranges{{0x200, 0x400}}));
+	}
+
+	void TestMalformed()
+	{
+		ImageBuilder builder = TypicalDll();
+		const std::vector<uint8_t> good = builder.Build();
+
+		auto rejects = [](const std::vector<uint8_t>& data, size_t size)
+		{
+			PEImage image;
+			bool parsed = image.Parse(data.data(), size, false);
+			// Scans fall back to the whole image when the headers can't be used
+			bool fallback = image.GetRanges(SectionClass::Code) == (Ranges{{0, size}});
+			return !parsed && !image.IsValid() && fallback;
+		};
+
+		CHECK(rejects(good, 0));
+		CHECK(rejects(good, 0x3C));
+		CHECK(rejects(good, NT_OFFSET + 2));
+		CHECK(rejects(good, builder.optHeader + 1));
+		// Cut off in the data directories and in the section table
+		CHECK(rejects(good, builder.optHeader + 100));
+		CHECK(rejects(good, builder.sectionTable + 3 * 40 + 20));
+
+		std::vector<uint8_t> data = good;
+		data[0] = 'N';
+		CHECK(rejects(data, data.size()));
+
+		data = good;
+		ImageBuilder::Write<uint32_t>(data, 0x3C, 0xFFFFFFF0);
+		CHECK(rejects(data, data.size()));
+
+		data = good;
+		ImageBuilder::Write<uint32_t>(data, 0x3C, static_cast<uint32_t>(data.size() - 2));
+		CHECK(rejects(data, data.size()));
+
+		data = good;
+		ImageBuilder::Write<uint32_t>(data, NT_OFFSET, 0x00004551);
+		CHECK(rejects(data, data.size()));
+
+		data = good;
+		ImageBuilder::Write<uint16_t>(data, builder.optHeader, 0x107);
+		CHECK(rejects(data, data.size()));
+
+		// More sections than there is room for
+		data = good;
+		ImageBuilder::Write<uint16_t>(data, builder.fileHeader + 2, 0xFFFF);
+		CHECK(rejects(data, data.size()));
+
+		// An optional header size that puts the section table past the end
+		data = good;
+		ImageBuilder::Write<uint16_t>(data, builder.fileHeader + 16, 0xFFF0);
+		CHECK(rejects(data, data.size()));
+
+		// A reused parser drops the sections of the last image
+		PEImage image;
+		CHECK(image.Parse(good.data(), good.size(), false));
+		CHECK(!image.Parse(data.data(), data.size(), false));
+		CHECK(image.GetSections().empty());
+	}
+} // namespace
+
+int main()
+{
+	TestRawRanges();
+	TestMappedRanges();
+	Test64Bit();
+	TestClassification();
+	TestMalformed();
+
+	if (failures)
+	{
+		std::printf("%d checks failed\n", failures);
+		return 1;
+	}
+	std::printf("all checks passed\n");
+	return 0;
+}
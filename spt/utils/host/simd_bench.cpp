@@ -0,0 +1,223 @@
+// Times SimdPattern against the matchers it replaced on synthetic module images: the byte at a time wildcard loop
+// of MemUtils::find_pattern and kmp::match_first, which only handles patterns without wildcards.
+//
+// The images are random bytes with roughly the byte frequencies of x86 code. The patterns are cut from the last
+// part of the image, with wildcards over the operands that change between builds, so most of the image has to be
+// walked before they are found. Every matcher has to find the same first match, the program fails if one doesn't.
+//
+// Usage: simd_bench [image size in MB]...   (20, 30 and 40 MB by default)
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "kmp-cpp.hpp"
+#include "simd_search.hpp"
+
+namespace
+{
+	const size_t MB = 1024 * 1024;
+	const int CODE_PATTERNS = 24;
+	const int STRING_PATTERNS = 8;
+	const int REPEATS = 3;
+
+	struct BenchPattern
+	{
+		std::vector<uint8_t> bytes;
+		std::vector<bool> fixed;
+		bool hasWildcards;
+	};
+
+	std::vector<uint8_t> MakeImage(size_t size, std::mt19937& rng)
+	{
+		// The bytes that make up most of x86 code and data, the rest are spread evenly
+		static const uint8_t COMMON[] = {
+		    0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0x8B, 0x8B, 0xCC, 0x89, 0x24, 0x45,
+		    0x04, 0xE8, 0x08, 0x0F, 0x83, 0x01, 0x10, 0x85, 0x4C, 0x44, 0x50, 0x74,
+		};
+		std::uniform_int_distribution<int> coin(0, 99);
+		std::uniform_int_distribution<size_t> common(0, sizeof(COMMON) - 1);
+		std::uniform_int_distribution<int> any(0, 255);
+
+		std::vector<uint8_t> image(size);
+		for (auto& b : image)
+			b = coin(rng) < 60 ? COMMON[common(rng)] : static_cast<uint8_t>(any(rng));
+		return image;
+	}
+
+	// Code patterns wildcard 4 byte operands like the PATTERNS tables do, string patterns are plain text
+	std::vector<BenchPattern> MakePatterns(std::vector<uint8_t>& image, std::mt19937& rng)
+	{
+		std::vector<BenchPattern> patterns;
+		std::uniform_int_distribution<size_t> offset(image.size() * 9 / 10, image.size() - 64);
+		std::uniform_int_distribution<size_t> codeLength(12, 40);
+		std::uniform_int_distribution<int> coin(0, 99);
+
+		for (int i = 0; i < CODE_PATTERNS; ++i)
+		{
+			size_t start = offset(rng);
+			BenchPattern pattern;
+			pattern.bytes.assign(image.begin() + start, image.begin() + start + codeLength(rng));
+			pattern.fixed.assign(pattern.bytes.size(), true);
+			for (size_t j = 1; j + 4 < pattern.bytes.size(); ++j)
+			{
+				if (coin(rng) < 15)
+				{
+					for (size_t k = 0; k < 4; ++k)
+						pattern.fixed[j + k] = false;
+					j += 4;
+				}
+			}
+			pattern.hasWildcards = true;
+			patterns.push_back(std::move(pattern));
+		}
+
+		static const char* STRINGS[STRING_PATTERNS] = {"Exe build:",
+		                                               "CEngineVGui::Paint",
+		                                               "sv_cheats",
+		                                               "host_framerate",
+		                                               "Datamap",
+		                                               "CHLClient::LevelInitPreEntity",
+		                                               "portal_place",
+		                                               "Unknown command"};
+		for (const char* string : STRINGS)
+		{
+			BenchPattern pattern;
+			while (*string)
+				pattern.bytes.push_back(static_cast<uint8_t>(*string++));
+			pattern.fixed.assign(pattern.bytes.size(), true);
+			pattern.hasWildcards = false;
+
+			size_t start = offset(rng);
+			std::copy(pattern.bytes.begin(), pattern.bytes.end(), image.begin() + start);
+			patterns.push_back(std::move(pattern));
+		}
+
+		return patterns;
+	}
+
+	const uint8_t* FindBytewise(const BenchPattern& pattern, const uint8_t* begin, const uint8_t* end)
+	{
+		size_t length = pattern.bytes.size();
+		for (const uint8_t* pos = begin; pos + length <= end; ++pos)
+		{
+			size_t i = 0;
+			while (i < length && (!pattern.fixed[i] || pos[i] == pattern.bytes[i]))
+				++i;
+			if (i == length)
+				return pos;
+		}
+		return nullptr;
+	}
+
+	template<typename Find>
+	double Time(Find find)
+	{
+		double best = 0;
+		for (int i = 0; i < REPEATS; ++i)
+		{
+			auto start = std::chrono::steady_clock::now();
+			find();
+			std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+			if (i == 0 || elapsed.count() < best)
+				best = elapsed.count();
+		}
+		return best;
+	}
+
+	bool Bench(size_t megabytes)
+	{
+		std::mt19937 rng(static_cast<unsigned>(megabytes));
+		std::vector<uint8_t> image = MakeImage(megabytes * MB, rng);
+		std::vector<BenchPattern> patterns = MakePatterns(image, rng);
+		const uint8_t* begin = image.data();
+		const uint8_t* end = begin + image.size();
+
+		std::vector<utils::SimdPattern> simdPatterns;
+		for (auto& pattern : patterns)
+			simdPatterns.emplace_back(pattern.bytes.data(), pattern.fixed);
+
+		std::vector<const uint8_t*> expected(patterns.size()), simd(patterns.size()), kmp(patterns.size());
+		double bytewiseTime = Time(
+		    [&]()
+		    {
+			    for (size_t i = 0; i < patterns.size(); ++i)
+				    expected[i] = FindBytewise(patterns[i], begin, end);
+		    });
+		double simdTime = Time(
+		    [&]()
+		    {
+			    for (size_t i = 0; i < patterns.size(); ++i)
+				    simd[i] = simdPatterns[i].Find(begin, end);
+		    });
+		double simdStringTime = Time(
+		    [&]()
+		    {
+			    for (size_t i = CODE_PATTERNS; i < patterns.size(); ++i)
+				    simd[i] = simdPatterns[i].Find(begin, end);
+		    });
+		double kmpTime = Time(
+		    [&]()
+		    {
+			    for (size_t i = CODE_PATTERNS; i < patterns.size(); ++i)
+			    {
+				    auto& bytes = patterns[i].bytes;
+				    long offset = kmp::match_first(bytes.begin(), bytes.end(), begin, end);
+				    kmp[i] = offset < 0 ? nullptr : begin + offset;
+			    }
+		    });
+
+		bool ok = true;
+		for (size_t i = 0; i < patterns.size(); ++i)
+		{
+			bool kmpWrong = !patterns[i].hasWildcards && kmp[i] != expected[i];
+			if (!expected[i] || simd[i] != expected[i] || kmpWrong)
+			{
+				std::printf("pattern %u: expected offset %lld, simd %lld, kmp %lld\n",
+				            static_cast<unsigned>(i),
+				            expected[i] ? static_cast<long long>(expected[i] - begin) : -1LL,
+				            simd[i] ? static_cast<long long>(simd[i] - begin) : -1LL,
+				            kmp[i] ? static_cast<long long>(kmp[i] - begin) : -1LL);
+				ok = false;
+			}
+		}
+
+		// Every pattern walks about the same part of the image, the throughput is per pattern
+		double scanned = static_cast<double>(megabytes) * patterns.size();
+		double stringsScanned = static_cast<double>(megabytes) * STRING_PATTERNS;
+		std::printf("%u MB image, %d wildcard and %d string patterns\n",
+		            static_cast<unsigned>(megabytes),
+		            CODE_PATTERNS,
+		            STRING_PATTERNS);
+		std::printf("  all patterns:    bytewise %7.0f MB/s, simd %7.0f MB/s, %.1fx\n",
+		            scanned / bytewiseTime,
+		            scanned / simdTime,
+		            bytewiseTime / simdTime);
+		std::printf("  string patterns: kmp      %7.0f MB/s, simd %7.0f MB/s, %.1fx\n",
+		            stringsScanned / kmpTime,
+		            stringsScanned / simdStringTime,
+		            kmpTime / simdStringTime);
+		return ok;
+	}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+	std::vector<size_t> sizes;
+	for (int i = 1; i < argc; ++i)
+		sizes.push_back(std::strtoul(argv[i], nullptr, 10));
+	if (sizes.empty())
+		sizes = {20, 30, 40};
+
+	bool ok = true;
+	for (size_t megabytes : sizes)
+		ok = Bench(megabytes) && ok;
+
+	if (!ok)
+		std::printf("the matchers disagree\n");
+	return ok ? 0 : 1;
+}
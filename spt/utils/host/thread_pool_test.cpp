@@ -0,0 +1,126 @@
+// Checks that TaskGroup runs every task, including tasks that queue and wait on more tasks, and that an exception
+// thrown by a task is rethrown by Wait() instead of ending the worker thread.
+//
+// Usage: thread_pool_test, returns 1 if a check failed
+
+#include <atomic>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+
+#include "thread_pool.hpp"
+
+using utils::TaskGroup;
+using utils::ThreadPool;
+
+namespace
+{
+	int failures = 0;
+
+#define CHECK(condition) \
+	do \
+	{ \
+		if (!(condition)) \
+		{ \
+			std::printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+			++failures; \
+		} \
+	} while (0)
+
+	void TestRunsEveryTask(ThreadPool& pool)
+	{
+		std::atomic<int> count{0};
+		TaskGroup tasks(pool);
+		for (int i = 0; i < 1000; ++i)
+			tasks.Run([&count]() { ++count; });
+		tasks.Wait();
+		CHECK(count == 1000);
+	}
+
+	void TestNestedGroups(ThreadPool& pool)
+	{
+		std::atomic<int> count{0};
+		TaskGroup outer(pool);
+		for (int i = 0; i < 16; ++i)
+		{
+			outer.Run(
+			    [&pool, &count]()
+			    {
+				    TaskGroup inner(pool);
+				    for (int j = 0; j < 16; ++j)
+					    inner.Run([&count]() { ++count; });
+				    inner.Wait();
+			    });
+		}
+		outer.Wait();
+		CHECK(count == 256);
+	}
+
+	void TestException(ThreadPool& pool)
+	{
+		std::atomic<int> count{0};
+		TaskGroup tasks(pool);
+		for (int i = 0; i < 100; ++i)
+		{
+			tasks.Run(
+			    [&count, i]()
+			    {
+				    ++count;
+				    if (i % 10 == 3)
+					    throw std::runtime_error("task " + std::to_string(i));
+			    });
+		}
+
+		bool thrown = false;
+		try
+		{
+			tasks.Wait();
+		}
+		catch (const std::runtime_error&)
+		{
+			thrown = true;
+		}
+		CHECK(thrown);
+		// The other tasks still ran, and the exception is only reported once
+		CHECK(count == 100);
+
+		thrown = false;
+		try
+		{
+			tasks.Wait();
+		}
+		catch (...)
+		{
+			thrown = true;
+		}
+		CHECK(!thrown);
+
+		// The pool keeps working afterwards
+		TestRunsEveryTask(pool);
+	}
+
+	void TestExceptionInDestructor(ThreadPool& pool)
+	{
+		// Not waited on, the destructor waits for the task and drops the exception
+		TaskGroup tasks(pool);
+		tasks.Run([]() { throw std::runtime_error("dropped"); });
+	}
+} // namespace
+
+int main()
+{
+	ThreadPool pool(4);
+	TestRunsEveryTask(pool);
+	TestNestedGroups(pool);
+	TestException(pool);
+	TestExceptionInDestructor(pool);
+	pool.Shutdown();
+
+	if (failures)
+	{
+		std::printf("%d checks failed\n", failures);
+		return 1;
+	}
+	std::printf("all checks passed\n");
+	return 0;
+}
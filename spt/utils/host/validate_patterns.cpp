@@ -0,0 +1,91 @@
+// Checks every PATTERNS table of the SPT sources and patterns_archive.hpp against dumped game binaries, without
+// launching the games. extract_patterns.py collects the tables into pattern_tables.inc when the tool is built.
+//
+// Usage: validate_patterns <dump directory> [pattern filter]
+//
+// Every subdirectory of the dump directory is a build and holds the <module>.dll files of that build, as they are on
+// disk. The pattern x build matrix flags tables with no hits or with several hits for a single address, the same way
+// spt_validate_patterns does in game. Only tables whose module:name contains the filter are checked if one is given.
+//
+// Returns 0 if nothing was flagged, 1 on bad arguments and 2 if a table was flagged.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "pattern_validation.hpp"
+#include "thread_pool.hpp"
+
+namespace
+{
+	struct PatternTable
+	{
+		const char* file;
+		const char* moduleName;
+		const char* patternName;
+		bool archived;
+		const patterns::PatternWrapper* patternArr;
+		size_t patternCount;
+		utils::SectionClass section;
+		bool matchAll;
+	};
+
+#include "pattern_tables.inc"
+} // namespace
+
+int main(int argc, char* argv[])
+{
+	if (argc < 2)
+	{
+		std::printf("Usage: validate_patterns <dump directory> [pattern filter]\n");
+		return 1;
+	}
+	const char* filter = argc > 2 ? argv[2] : "";
+
+	std::vector<utils::ValidatedPattern> patternRows;
+	for (auto& table : PATTERN_TABLES)
+	{
+		// The archive has old copies of tables that are still in use, they get their own rows
+		std::string name = table.patternName;
+		if (table.archived)
+			name += " (archive)";
+		if (!strstr((std::string(table.moduleName) + ":" + name).c_str(), filter))
+			continue;
+
+		patternRows.push_back(utils::ValidatedPattern{table.moduleName,
+		                                              name,
+		                                              table.patternArr,
+		                                              table.patternCount,
+		                                              table.section,
+		                                              table.matchAll});
+	}
+	std::sort(patternRows.begin(),
+	          patternRows.end(),
+	          [](const utils::ValidatedPattern& a, const utils::ValidatedPattern& b)
+	          {
+		          if (a.moduleName != b.moduleName)
+			          return a.moduleName < b.moduleName;
+		          return a.patternName < b.patternName;
+	          });
+
+	auto start = std::chrono::steady_clock::now();
+	utils::PatternMatrix matrix;
+	if (!matrix.Build(argv[1], patternRows))
+	{
+		std::printf("%s is not a directory\n", argv[1]);
+		return 1;
+	}
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+	for (auto& line : matrix.Format())
+		std::printf("%s\n", line.c_str());
+	std::printf("Scanned in %.2f s using %u threads\n",
+	            elapsed.count(),
+	            static_cast<unsigned>(utils::GetThreadPool().GetThreadCount()));
+	utils::GetThreadPool().Shutdown();
+
+	return matrix.GetSuspiciousCount() > 0 ? 2 : 0;
+}
@@ -0,0 +1,134 @@
+#include "stdafx.hpp"
+#include "mapped_file.hpp"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+#ifdef _WIN32
+bool MappedFile::Open(const std::string& fileName)
+{
+	Close();
+
+	HANDLE file = CreateFileA(fileName.c_str(),
+	                          GENERIC_READ,
+	                          FILE_SHARE_READ | FILE_SHARE_WRITE,
+	                          NULL,
+	                          OPEN_EXISTING,
+	                          FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+	                          NULL);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize) || fileSize.HighPart != 0)
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	fileHandle = file;
+	size = fileSize.LowPart;
+	open = true;
+
+	// Empty files can't be mapped
+	if (size == 0)
+		return true;
+
+	mappingHandle = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (mappingHandle)
+		view = static_cast<const char*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+
+	if (!view)
+	{
+		Close();
+		return false;
+	}
+
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (view)
+		UnmapViewOfFile(view);
+	if (mappingHandle)
+		CloseHandle(mappingHandle);
+	if (fileHandle)
+		CloseHandle(fileHandle);
+
+	fileHandle = nullptr;
+	mappingHandle = nullptr;
+	view = nullptr;
+	size = 0;
+	open = false;
+}
+#else
+// Lets the host tools and benchmarks read scripts the same way the plugin does
+bool MappedFile::Open(const std::string& fileName)
+{
+	Close();
+
+	int fd = ::open(fileName.c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	struct stat info;
+	if (fstat(fd, &info) != 0)
+	{
+		::close(fd);
+		return false;
+	}
+
+	size = static_cast<size_t>(info.st_size);
+	open = true;
+
+	// Empty files can't be mapped
+	if (size > 0)
+	{
+		void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (mapping != MAP_FAILED)
+		{
+			madvise(mapping, size, MADV_SEQUENTIAL);
+			view = static_cast<const char*>(mapping);
+		}
+	}
+	::close(fd);
+
+	if (size > 0 && !view)
+	{
+		Close();
+		return false;
+	}
+
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (view)
+		munmap(const_cast<char*>(view), size);
+
+	view = nullptr;
+	size = 0;
+	open = false;
+}
+#endif
+
+bool MappedFile::IsOpen() const
+{
+	return open;
+}
+
+std::string_view MappedFile::GetContents() const
+{
+	return std::string_view(view, size);
+}
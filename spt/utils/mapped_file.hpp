@@ -0,0 +1,27 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// Read-only memory mapping of a whole file, the contents are valid until the file is closed
+class MappedFile
+{
+public:
+	MappedFile() = default;
+	~MappedFile();
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	bool Open(const std::string& fileName);
+	void Close();
+	bool IsOpen() const;
+	std::string_view GetContents() const;
+
+private:
+	// Only used on Windows, the file can be closed right after mapping it elsewhere
+	void* fileHandle = nullptr;
+	void* mappingHandle = nullptr;
+	const char* view = nullptr;
+	size_t size = 0;
+	bool open = false;
+};
@@ -0,0 +1,344 @@
+#include "stdafx.hpp"
+#include "pattern_scanner.hpp"
+
+#include <algorithm>
+#include <queue>
+
+namespace utils
+{
+	void DecodePattern(const patterns::PatternWrapper& pattern,
+	                   std::vector<uint8_t>& bytes,
+	                   std::vector<bool>& fixed)
+	{
+		size_t length = pattern.length();
+		const uint8_t* patternBytes = pattern.bytes();
+		bytes.assign(patternBytes, patternBytes + length);
+		fixed.assign(length, false);
+
+		/*
+		* The wildcard mask is recovered through match() so that it always agrees with SPTLib's matcher: a byte
+		* is fixed if changing it makes the pattern stop matching its own bytes.
+		*/
+		std::vector<uint8_t> probe(bytes);
+		for (size_t i = 0; i < length; ++i)
+		{
+			probe[i] = ~bytes[i];
+			fixed[i] = !pattern.match(probe.data());
+			probe[i] = bytes[i];
+		}
+	}
+
+	size_t PatternScanner::AddGroup(const patterns::PatternWrapper* patterns, size_t count, bool matchAll)
+	{
+		size_t group = groups.size();
+		groups.push_back(Group{matchAll});
+
+		std::vector<uint8_t> bytes;
+		std::vector<bool> fixed;
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			const patterns::PatternWrapper& pattern = patterns[i];
+			DecodePattern(pattern, bytes, fixed);
+
+			// the anchor is the longest run of fixed bytes
+			size_t bestOffset = 0, bestLength = 0;
+			for (size_t j = 0; j < fixed.size();)
+			{
+				if (!fixed[j])
+				{
+					++j;
+					continue;
+				}
+
+				size_t runStart = j;
+				while (j < fixed.size() && fixed[j])
+					++j;
+
+				if (j - runStart > bestLength)
+				{
+					bestOffset = runStart;
+					bestLength = j - runStart;
+				}
+			}
+
+			Entry entry;
+			entry.pattern = &pattern;
+			entry.group = group;
+			entry.index = static_cast<int>(i);
+			entry.length = pattern.length();
+			entry.anchorOffset = bestOffset;
+			entry.anchorLength = (std::min)(bestLength, MAX_ANCHOR_LENGTH);
+			entry.simdPattern = SimdPattern(bytes.data(), fixed);
+			entries.push_back(std::move(entry));
+
+			if (entries.back().anchorLength == 0)
+				anchorless.push_back(entries.size() - 1);
+			else
+				AddAnchor(entries.size() - 1, bytes.data() + bestOffset);
+		}
+
+		built = false;
+		return group;
+	}
+
+	void PatternScanner::AddAnchor(size_t entryIndex, const uint8_t* anchor)
+	{
+		const Entry& entry = entries[entryIndex];
+
+		if (states.empty())
+		{
+			states.emplace_back();
+			transitions.resize(256, -1);
+		}
+
+		int32_t state = 0;
+		for (size_t i = 0; i < entry.anchorLength; ++i)
+		{
+			int32_t& next = transitions[state * 256 + anchor[i]];
+			if (next == -1)
+			{
+				next = static_cast<int32_t>(states.size());
+				states.emplace_back();
+				transitions.resize(states.size() * 256, -1);
+			}
+			state = transitions[state * 256 + anchor[i]];
+		}
+
+		states[state].outputs.push_back(entryIndex);
+		maxAnchorReach = (std::max)(maxAnchorReach, entry.anchorOffset + entry.anchorLength);
+	}
+
+	void PatternScanner::Build()
+	{
+		if (built)
+			return;
+
+		if (states.empty())
+		{
+			states.emplace_back();
+			transitions.resize(256, -1);
+		}
+
+		// Turn the trie into a DFA, every transition is resolved so the scan loop never follows fail links
+		std::queue<int32_t> queue;
+		for (int c = 0; c < 256; ++c)
+		{
+			int32_t& next = transitions[c];
+			if (next == -1)
+			{
+				next = 0;
+			}
+			else
+			{
+				states[next].fail = 0;
+				queue.push(next);
+			}
+		}
+
+		while (!queue.empty())
+		{
+			int32_t state = queue.front();
+			queue.pop();
+
+			int32_t fail = states[state].fail;
+			states[state].outputLink = states[fail].outputs.empty() ? states[fail].outputLink : fail;
+
+			for (int c = 0; c < 256; ++c)
+			{
+				int32_t& next = transitions[state * 256 + c];
+				if (next == -1)
+				{
+					next = transitions[fail * 256 + c];
+				}
+				else
+				{
+					states[next].fail = transitions[fail * 256 + c];
+					queue.push(next);
+				}
+			}
+		}
+
+		useSimd = entries.size() <= MAX_SIMD_PATTERNS;
+		built = true;
+	}
+
+	std::vector<PatternScanResult> PatternScanner::Scan(const uint8_t* start, size_t size) const
+	{
+		std::vector<PatternScanResult> results;
+		ScanRange(start, size, 0, size, results);
+		FinishResults(results);
+		return results;
+	}
+
+	void PatternScanner::ScanRange(const uint8_t* start,
+	                               size_t size,
+	                               size_t from,
+	                               size_t to,
+	                               std::vector<PatternScanResult>& results) const
+	{
+		results.resize(groups.size());
+		to = (std::min)(to, size);
+		if (!built || from >= to)
+			return;
+
+		if (useSimd)
+		{
+			ScanRangeSimd(start, size, from, to, results);
+			return;
+		}
+
+		for (size_t entryIndex : anchorless)
+		{
+			const Entry& entry = entries[entryIndex];
+			if (entry.length > size)
+				continue;
+
+			size_t last = (std::min)(to, size - entry.length + 1);
+			for (size_t pos = from; pos < last; ++pos)
+			{
+				if (!entry.pattern->match(start + pos))
+					continue;
+
+				bool matchAll = groups[entry.group].matchAll;
+				Report(entry, reinterpret_cast<uintptr_t>(start + pos), results[entry.group], matchAll);
+				if (!matchAll)
+					break;
+			}
+		}
+
+		// anchors of patterns starting in [from, to) can extend up to maxAnchorReach bytes past the start
+		size_t end = (std::min)(size, to + maxAnchorReach);
+		const int32_t* table = transitions.data();
+		int32_t state = 0;
+
+		for (size_t pos = from; pos < end; ++pos)
+		{
+			state = table[state * 256 + start[pos]];
+
+			int32_t out = states[state].outputs.empty() ? states[state].outputLink : state;
+			for (; out != -1; out = states[out].outputLink)
+			{
+				for (size_t entryIndex : states[out].outputs)
+					OnCandidate(entries[entryIndex], start, size, from, to, pos, results);
+			}
+		}
+	}
+
+	void PatternScanner::ScanRangeSimd(const uint8_t* start,
+	                                   size_t size,
+	                                   size_t from,
+	                                   size_t to,
+	                                   std::vector<PatternScanResult>& results) const
+	{
+		std::vector<const uint8_t*> matches;
+
+		// entries are in alternative order, so the first alternative found in a group wins
+		for (const Entry& entry : entries)
+		{
+			bool matchAll = groups[entry.group].matchAll;
+			PatternScanResult& result = results[entry.group];
+			if (!matchAll && result.index != -1)
+				continue;
+			if (entry.length > size)
+				continue;
+
+			const uint8_t* begin = start + from;
+			const uint8_t* end = start + (std::min)(size, to + entry.length - 1);
+
+			if (matchAll)
+			{
+				matches.clear();
+				entry.simdPattern.FindAll(begin, end, matches);
+				for (const uint8_t* match : matches)
+					Report(entry, reinterpret_cast<uintptr_t>(match), result, true);
+			}
+			else if (const uint8_t* match = entry.simdPattern.Find(begin, end))
+			{
+				Report(entry, reinterpret_cast<uintptr_t>(match), result, false);
+			}
+		}
+	}
+
+	void PatternScanner::OnCandidate(const Entry& entry,
+	                                 const uint8_t* start,
+	                                 size_t size,
+	                                 size_t from,
+	                                 size_t to,
+	                                 size_t anchorEnd,
+	                                 std::vector<PatternScanResult>& results) const
+	{
+		size_t anchorStart = anchorEnd + 1 - entry.anchorLength;
+		if (anchorStart < entry.anchorOffset)
+			return;
+
+		size_t pos = anchorStart - entry.anchorOffset;
+		if (pos < from || pos >= to || entry.length > size - pos)
+			return;
+
+		bool matchAll = groups[entry.group].matchAll;
+		PatternScanResult& result = results[entry.group];
+
+		// a better alternative for this group has already been found
+		if (!matchAll && result.index != -1 && result.index < entry.index)
+			return;
+
+		if (entry.pattern->match(start + pos))
+			Report(entry, reinterpret_cast<uintptr_t>(start + pos), result, matchAll);
+	}
+
+	void PatternScanner::Report(const Entry& entry, uintptr_t address, PatternScanResult& result, bool matchAll)
+	{
+		if (matchAll)
+		{
+			patterns::MatchedPattern match;
+			match.ptnIndex = entry.index;
+			match.ptr = address;
+			result.matches.push_back(match);
+		}
+		else if (result.index == -1 || entry.index < result.index
+		         || (entry.index == result.index && address < result.address))
+		{
+			result.index = entry.index;
+			result.address = address;
+		}
+	}
+
+	void PatternScanner::MergeResults(std::vector<PatternScanResult>& into,
+	                                  std::vector<PatternScanResult>& from) const
+	{
+		into.resize(groups.size());
+		for (size_t i = 0; i < from.size() && i < into.size(); ++i)
+		{
+			PatternScanResult& dst = into[i];
+			PatternScanResult& src = from[i];
+
+			if (groups[i].matchAll)
+			{
+				dst.matches.insert(dst.matches.end(), src.matches.begin(), src.matches.end());
+			}
+			else if (src.index != -1
+			         && (dst.index == -1 || src.index < dst.index
+			             || (src.index == dst.index && src.address < dst.address)))
+			{
+				dst.index = src.index;
+				dst.address = src.address;
+			}
+		}
+	}
+
+	void PatternScanner::FinishResults(std::vector<PatternScanResult>& results) const
+	{
+		for (auto& result : results)
+		{
+			std::sort(result.matches.begin(),
+			          result.matches.end(),
+			          [](const patterns::MatchedPattern& a, const patterns::MatchedPattern& b)
+			          {
+				          if (a.ptnIndex != b.ptnIndex)
+					          return a.ptnIndex < b.ptnIndex;
+				          return a.ptr < b.ptr;
+			          });
+		}
+	}
+} // namespace utils
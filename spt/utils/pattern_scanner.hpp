@@ -0,0 +1,115 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#ifdef SPT_UTILS_HOST
+#include "host_patterns.hpp"
+#else
+#include "SPTLib\patterns.hpp"
+#endif
+#include "simd_search.hpp"
+
+namespace utils
+{
+	struct PatternScanResult
+	{
+		// for regular groups: the lowest matching alternative and its first match
+		int index = -1;
+		uintptr_t address = 0;
+		// for match-all groups: every match of every alternative, sorted by (alternative, address)
+		std::vector<patterns::MatchedPattern> matches;
+	};
+
+	/*
+	* Finds every registered pattern group in a memory range with a single pass over the memory.
+	*
+	* Each pattern contributes its longest run of non-wildcard bytes (capped at MAX_ANCHOR_LENGTH) as an anchor
+	* to an Aho-Corasick automaton. The automaton walks the range once and every anchor hit is verified with the
+	* full (wildcard-aware) pattern. Results are the same as scanning each alternative separately in order: the
+	* first alternative that matches anywhere wins, and its lowest address is reported.
+	*
+	* With only a few patterns, searching for each of them with SimdPattern is faster than walking the automaton.
+	*
+	* The range can be split into chunks and scanned in parallel via ScanRange(), the partial results are
+	* combined with MergeResults().
+	*/
+	class PatternScanner
+	{
+	public:
+		static const size_t MAX_ANCHOR_LENGTH = 8;
+		static const size_t MAX_SIMD_PATTERNS = 8;
+
+		// Returns the group id, results are indexed by it
+		size_t AddGroup(const patterns::PatternWrapper* patterns, size_t count, bool matchAll);
+		// Must be called after all groups have been added and before scanning
+		void Build();
+
+		std::vector<PatternScanResult> Scan(const uint8_t* start, size_t size) const;
+		// Only reports matches that start in [start + from, start + to)
+		void ScanRange(const uint8_t* start,
+		               size_t size,
+		               size_t from,
+		               size_t to,
+		               std::vector<PatternScanResult>& results) const;
+		void MergeResults(std::vector<PatternScanResult>& into, std::vector<PatternScanResult>& from) const;
+		// Sorts match-all results, call once after all chunks have been merged
+		void FinishResults(std::vector<PatternScanResult>& results) const;
+
+		size_t GetGroupCount() const
+		{
+			return groups.size();
+		}
+
+	private:
+		struct Entry
+		{
+			const patterns::PatternWrapper* pattern;
+			size_t group;
+			int index;
+			size_t length;
+			size_t anchorOffset;
+			size_t anchorLength;
+			SimdPattern simdPattern;
+		};
+
+		struct Group
+		{
+			bool matchAll;
+		};
+
+		struct State
+		{
+			std::vector<size_t> outputs; // entries whose anchor ends in this state
+			int32_t fail = 0;
+			int32_t outputLink = -1; // closest state on the fail chain with outputs
+		};
+
+		void AddAnchor(size_t entryIndex, const uint8_t* anchor);
+		void ScanRangeSimd(const uint8_t* start,
+		                   size_t size,
+		                   size_t from,
+		                   size_t to,
+		                   std::vector<PatternScanResult>& results) const;
+		void OnCandidate(const Entry& entry,
+		                 const uint8_t* start,
+		                 size_t size,
+		                 size_t from,
+		                 size_t to,
+		                 size_t anchorEnd,
+		                 std::vector<PatternScanResult>& results) const;
+		static void Report(const Entry& entry, uintptr_t address, PatternScanResult& result, bool matchAll);
+
+		std::vector<Group> groups;
+		std::vector<Entry> entries;
+		std::vector<size_t> anchorless;
+		std::vector<State> states;
+		std::vector<int32_t> transitions; // states.size() * 256
+		size_t maxAnchorReach = 0;
+		bool built = false;
+		bool useSimd = false;
+	};
+
+	// Splits a pattern into its bytes and a mask of which bytes are not wildcards
+	void DecodePattern(const patterns::PatternWrapper& pattern,
+	                   std::vector<uint8_t>& bytes,
+	                   std::vector<bool>& fixed);
+} // namespace utils
@@ -0,0 +1,222 @@
+#include "stdafx.hpp"
+#include "pattern_validation.hpp"
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <set>
+
+namespace fs = std::filesystem;
+
+namespace utils
+{
+	static bool ReadFile(const fs::path& path, std::vector<uint8_t>& data)
+	{
+		std::ifstream is(path, std::ios::binary);
+		if (!is)
+			return false;
+
+		data.assign(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+		return true;
+	}
+
+	void CountPatternHits(const uint8_t* data,
+	                      size_t size,
+	                      const std::vector<const ValidatedPattern*>& modulePatterns,
+	                      std::vector<int>& hits)
+	{
+		PEImage image;
+		image.Parse(data, size, false);
+
+		std::vector<std::set<uintptr_t>> addresses(modulePatterns.size());
+
+		auto scan = [&](const std::vector<size_t>& indices, SectionClass sectionClass)
+		{
+			if (indices.empty())
+				return;
+
+			PatternScanner scanner;
+			for (size_t i : indices)
+				scanner.AddGroup(modulePatterns[i]->patternArr, modulePatterns[i]->patternCount, true);
+			scanner.Build();
+
+			std::vector<PatternScanResult> results;
+			for (auto& range : image.GetRanges(sectionClass))
+			{
+				std::vector<PatternScanResult> rangeResults;
+				scanner.ScanRange(data, size, range.first, range.second, rangeResults);
+				scanner.MergeResults(results, rangeResults);
+			}
+			results.resize(indices.size());
+
+			for (size_t group = 0; group < indices.size(); ++group)
+			{
+				for (auto& match : results[group].matches)
+					addresses[indices[group]].insert(match.ptr);
+			}
+		};
+
+		std::map<SectionClass, std::vector<size_t>> bySection;
+		for (size_t i = 0; i < modulePatterns.size(); ++i)
+			bySection[modulePatterns[i]->section].push_back(i);
+		for (auto& pair : bySection)
+			scan(pair.second, pair.first);
+
+		// same fallback as the plugin, misclassified sections still count
+		std::vector<size_t> missing;
+		for (size_t i = 0; i < modulePatterns.size(); ++i)
+		{
+			if (addresses[i].empty() && modulePatterns[i]->section != SectionClass::Any)
+				missing.push_back(i);
+		}
+		scan(missing, SectionClass::Any);
+
+		hits.resize(modulePatterns.size());
+		for (size_t i = 0; i < modulePatterns.size(); ++i)
+			hits[i] = static_cast<int>(addresses[i].size());
+	}
+
+	bool PatternMatrix::Build(const fs::path& root, const std::vector<ValidatedPattern>& patterns)
+	{
+		this->patterns = &patterns;
+		builds.clear();
+		hits.clear();
+
+		std::error_code ec;
+		if (!fs::is_directory(root, ec))
+			return false;
+
+		for (auto& entry : fs::directory_iterator(root, ec))
+		{
+			if (entry.is_directory(ec))
+				builds.push_back(entry.path().filename().string());
+		}
+		std::sort(builds.begin(), builds.end());
+
+		std::map<std::string, std::vector<size_t>> byModule;
+		for (size_t i = 0; i < patterns.size(); ++i)
+			byModule[patterns[i].moduleName].push_back(i);
+
+		hits.assign(patterns.size(), std::vector<int>(builds.size(), MODULE_MISSING));
+
+		struct ModuleJob
+		{
+			size_t build;
+			const std::vector<size_t>* indices;
+			fs::path path;
+		};
+		std::vector<ModuleJob> jobs;
+		for (size_t build = 0; build < builds.size(); ++build)
+		{
+			for (auto& pair : byModule)
+			{
+				fs::path path = root / builds[build] / (pair.first + ".dll");
+				if (fs::is_regular_file(path, ec))
+					jobs.push_back(ModuleJob{build, &pair.second, path});
+			}
+		}
+
+		// Every job only writes the cells of its own module and build
+		TaskGroup tasks(GetThreadPool());
+		for (auto& job : jobs)
+		{
+			tasks.Run(
+			    [this, &patterns, jobPtr = &job]()
+			    {
+				    std::vector<uint8_t> data;
+				    if (!ReadFile(jobPtr->path, data))
+					    return;
+
+				    std::vector<const ValidatedPattern*> modulePatterns;
+				    for (size_t i : *jobPtr->indices)
+					    modulePatterns.push_back(&patterns[i]);
+
+				    std::vector<int> moduleHits;
+				    CountPatternHits(data.data(), data.size(), modulePatterns, moduleHits);
+				    for (size_t i = 0; i < moduleHits.size(); ++i)
+					    hits[(*jobPtr->indices)[i]][jobPtr->build] = moduleHits[i];
+			    });
+		}
+		tasks.Wait();
+
+		return true;
+	}
+
+	bool PatternMatrix::IsSuspicious(size_t pattern, size_t build) const
+	{
+		int count = hits[pattern][build];
+		if (count == MODULE_MISSING)
+			return false;
+		return count == 0 || (!(*patterns)[pattern].matchAll && count > 1);
+	}
+
+	size_t PatternMatrix::GetSuspiciousCount() const
+	{
+		size_t suspicious = 0;
+		for (size_t pattern = 0; pattern < hits.size(); ++pattern)
+		{
+			for (size_t build = 0; build < builds.size(); ++build)
+			{
+				if (IsSuspicious(pattern, build))
+				{
+					++suspicious;
+					break;
+				}
+			}
+		}
+		return suspicious;
+	}
+
+	std::vector<std::string> PatternMatrix::Format() const
+	{
+		std::vector<std::string> lines;
+		char buffer[64];
+
+		std::string header;
+		std::snprintf(buffer, sizeof(buffer), "%-50s", "pattern");
+		header += buffer;
+		for (auto& build : builds)
+		{
+			std::snprintf(buffer, sizeof(buffer), " %10.10s", build.c_str());
+			header += buffer;
+		}
+		lines.push_back(header);
+
+		for (size_t pattern = 0; pattern < hits.size(); ++pattern)
+		{
+			auto& validated = (*patterns)[pattern];
+			std::string rowName = validated.moduleName + ":" + validated.patternName;
+
+			std::snprintf(buffer, sizeof(buffer), "%-50.50s", rowName.c_str());
+			std::string line = buffer;
+			for (size_t build = 0; build < builds.size(); ++build)
+			{
+				int count = hits[pattern][build];
+				if (count == MODULE_MISSING)
+				{
+					std::snprintf(buffer, sizeof(buffer), " %10s", "-");
+				}
+				else
+				{
+					bool bad = IsSuspicious(pattern, build);
+					std::snprintf(buffer, sizeof(buffer), " %9d%s", count, bad ? "!" : " ");
+				}
+				line += buffer;
+			}
+			lines.push_back(line);
+		}
+
+		std::snprintf(buffer,
+		              sizeof(buffer),
+		              "%u patterns against %u builds, ",
+		              static_cast<unsigned>(hits.size()),
+		              static_cast<unsigned>(builds.size()));
+		std::string summary = buffer + std::to_string(GetSuspiciousCount());
+		summary += " with no or ambiguous hits in some build (marked with !, - is a missing module)";
+		lines.push_back(summary);
+		return lines;
+	}
+} // namespace utils
@@ -0,0 +1,63 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "pattern_scanner.hpp"
+#include "pe_image.hpp"
+
+namespace utils
+{
+	struct ValidatedPattern
+	{
+		std::string moduleName;
+		std::string patternName;
+		const patterns::PatternWrapper* patternArr;
+		size_t patternCount;
+		SectionClass section;
+		bool matchAll;
+	};
+
+	/*
+	* Hit counts of pattern tables in dumped binaries of several game builds. The dump directory has a
+	* subdirectory per build with the <module>.dll files of that build, raw as they are on disk. Every module file
+	* is scanned on the thread pool with the same scanner and section fallback as the plugin uses.
+	*/
+	class PatternMatrix
+	{
+	public:
+		static const int MODULE_MISSING = -1;
+
+		// Returns false if root isn't a directory
+		bool Build(const std::filesystem::path& root, const std::vector<ValidatedPattern>& patterns);
+
+		const std::vector<std::string>& GetBuilds() const
+		{
+			return builds;
+		}
+		// Unique addresses of the pattern in the build, MODULE_MISSING if the build doesn't have its module
+		int GetHits(size_t pattern, size_t build) const
+		{
+			return hits[pattern][build];
+		}
+		// No hits, or more than one for a pattern that is used as a single address
+		bool IsSuspicious(size_t pattern, size_t build) const;
+		// Patterns that are suspicious in at least one build
+		size_t GetSuspiciousCount() const;
+
+		// The matrix as lines of text, suspicious counts are marked with ! and missing modules with -
+		std::vector<std::string> Format() const;
+
+	private:
+		const std::vector<ValidatedPattern>* patterns = nullptr;
+		std::vector<std::string> builds;
+		std::vector<std::vector<int>> hits; // [pattern][build]
+	};
+
+	// Counts the unique addresses each pattern matches in a raw (not mapped) module file
+	void CountPatternHits(const uint8_t* data,
+	                      size_t size,
+	                      const std::vector<const ValidatedPattern*>& modulePatterns,
+	                      std::vector<int>& hits);
+} // namespace utils
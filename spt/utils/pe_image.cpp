@@ -0,0 +1,188 @@
+#include "stdafx.hpp"
+#include "pe_image.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace utils
+{
+	template<typename T>
+	static bool Read(const uint8_t* data, size_t size, size_t offset, T& out)
+	{
+		if (offset > size || sizeof(T) > size - offset)
+			return false;
+		memcpy(&out, data + offset, sizeof(T));
+		return true;
+	}
+
+	const char* GetSectionClassName(SectionClass section)
+	{
+		switch (section)
+		{
+		case SectionClass::Code:
+			return "code";
+		case SectionClass::RData:
+			return "rdata";
+		case SectionClass::Data:
+			return "data";
+		default:
+			return "any";
+		}
+	}
+
+	SectionClass PEImage::ClassifySection(uint32_t characteristics)
+	{
+		if (characteristics & (SCN_CNT_CODE | SCN_MEM_EXECUTE))
+			return SectionClass::Code;
+		if (characteristics & SCN_MEM_WRITE)
+			return SectionClass::Data;
+		return SectionClass::RData;
+	}
+
+	bool PEImage::Parse(const uint8_t* data, size_t size, bool mapped)
+	{
+		sections.clear();
+		dataDirectories.clear();
+		valid = false;
+		this->mapped = mapped;
+		dataSize = size;
+
+		uint16_t dosMagic;
+		uint32_t ntOffset;
+		if (!Read(data, size, 0, dosMagic) || dosMagic != 0x5A4D || !Read(data, size, 0x3C, ntOffset))
+			return false;
+
+		uint32_t ntSignature;
+		if (!Read(data, size, ntOffset, ntSignature) || ntSignature != 0x00004550)
+			return false;
+
+		// IMAGE_FILE_HEADER
+		size_t fileHeader = ntOffset + 4;
+		uint16_t numberOfSections, sizeOfOptionalHeader;
+		if (!Read(data, size, fileHeader + 2, numberOfSections) || !Read(data, size, fileHeader + 4, timestamp)
+		    || !Read(data, size, fileHeader + 16, sizeOfOptionalHeader))
+			return false;
+
+		// IMAGE_OPTIONAL_HEADER32/64
+		size_t optHeader = fileHeader + 20;
+		uint16_t optMagic;
+		if (!Read(data, size, optHeader, optMagic))
+			return false;
+
+		if (optMagic == 0x10B)
+			is64Bit = false;
+		else if (optMagic == 0x20B)
+			is64Bit = true;
+		else
+			return false;
+
+		imageBaseOffset = optHeader + (is64Bit ? 24 : 28);
+		size_t numberOfRvaAndSizesOffset = optHeader + (is64Bit ? 108 : 92);
+		uint32_t numberOfRvaAndSizes;
+		if (!Read(data, size, optHeader + 56, sizeOfImage) || !Read(data, size, optHeader + 60, sizeOfHeaders)
+		    || !Read(data, size, numberOfRvaAndSizesOffset, numberOfRvaAndSizes))
+			return false;
+
+		for (uint32_t i = 0; i < numberOfRvaAndSizes && i < 16; ++i)
+		{
+			uint32_t rva, dirSize;
+			size_t entry = numberOfRvaAndSizesOffset + 4 + i * 8;
+			if (!Read(data, size, entry, rva) || !Read(data, size, entry + 4, dirSize))
+				return false;
+			dataDirectories.emplace_back(rva, dirSize);
+		}
+
+		// IMAGE_SECTION_HEADER
+		size_t sectionTable = optHeader + sizeOfOptionalHeader;
+		for (uint16_t i = 0; i < numberOfSections; ++i)
+		{
+			size_t header = sectionTable + i * 40;
+			char name[9] = {};
+			if (header + 40 > size)
+				return false;
+			memcpy(name, data + header, 8);
+
+			PESection section;
+			section.name = name;
+			Read(data, size, header + 8, section.virtualSize);
+			Read(data, size, header + 12, section.virtualAddress);
+			Read(data, size, header + 16, section.rawSize);
+			Read(data, size, header + 20, section.rawOffset);
+			Read(data, size, header + 36, section.characteristics);
+			section.sectionClass = ClassifySection(section.characteristics);
+			sections.push_back(section);
+		}
+
+		valid = true;
+		return true;
+	}
+
+	std::vector<std::pair<size_t, size_t>> PEImage::GetRanges(SectionClass sectionClass) const
+	{
+		std::vector<std::pair<size_t, size_t>> ranges;
+
+		if (!valid || sectionClass == SectionClass::Any)
+		{
+			ranges.emplace_back(0, dataSize);
+			return ranges;
+		}
+
+		for (auto& section : sections)
+		{
+			if (section.sectionClass != sectionClass)
+				continue;
+
+			size_t begin, length;
+			if (mapped)
+			{
+				begin = section.virtualAddress;
+				length = section.virtualSize ? section.virtualSize : section.rawSize;
+			}
+			else
+			{
+				begin = section.rawOffset;
+				length = section.rawSize;
+			}
+
+			if (begin >= dataSize || length == 0)
+				continue;
+			ranges.emplace_back(begin, begin + (std::min)(length, dataSize - begin));
+		}
+
+		std::sort(ranges.begin(), ranges.end());
+		return ranges;
+	}
+
+	bool PEImage::RvaToOffset(uint32_t rva, size_t& offset) const
+	{
+		if (!valid)
+			return false;
+
+		if (mapped || rva < sizeOfHeaders)
+		{
+			offset = rva;
+			return rva < dataSize;
+		}
+
+		for (auto& section : sections)
+		{
+			if (rva >= section.virtualAddress && rva - section.virtualAddress < section.rawSize)
+			{
+				offset = section.rawOffset + (rva - section.virtualAddress);
+				return offset < dataSize;
+			}
+		}
+
+		return false;
+	}
+
+	bool PEImage::GetDataDirectory(int index, uint32_t& rva, uint32_t& size) const
+	{
+		if (index < 0 || static_cast<size_t>(index) >= dataDirectories.size())
+			return false;
+
+		rva = dataDirectories[index].first;
+		size = dataDirectories[index].second;
+		return rva != 0 && size != 0;
+	}
+} // namespace utils
@@ -0,0 +1,104 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace utils
+{
+	enum class SectionClass
+	{
+		Any,   // the whole image
+		Code,  // executable sections
+		RData, // read-only initialized data, string literals and vftables live here
+		Data,  // writable data
+	};
+
+	// Lowercase name of the class, as used in reports and console output
+	const char* GetSectionClassName(SectionClass section);
+
+	struct PESection
+	{
+		std::string name;
+		uint32_t virtualAddress;
+		uint32_t virtualSize;
+		uint32_t rawOffset;
+		uint32_t rawSize;
+		uint32_t characteristics;
+		SectionClass sectionClass;
+	};
+
+	/*
+	* Minimal PE header parser for 32 and 64 bit images. It reads the headers byte by byte, so it doesn't need
+	* the Windows headers and works on any host. Images can either be mapped (as returned by GetModuleInfo) or
+	* raw files, in which case offsets are file offsets.
+	*/
+	class PEImage
+	{
+	public:
+		static const uint32_t SCN_CNT_CODE = 0x00000020;
+		static const uint32_t SCN_CNT_INITIALIZED_DATA = 0x00000040;
+		static const uint32_t SCN_MEM_EXECUTE = 0x20000000;
+		static const uint32_t SCN_MEM_WRITE = 0x80000000;
+		static const int DIRECTORY_BASERELOC = 5;
+
+		bool Parse(const uint8_t* data, size_t size, bool mapped = true);
+
+		bool IsValid() const
+		{
+			return valid;
+		}
+
+		const std::vector<PESection>& GetSections() const
+		{
+			return sections;
+		}
+
+		// [begin, end) offsets into the parsed data of every section of the given class, sorted by offset
+		std::vector<std::pair<size_t, size_t>> GetRanges(SectionClass sectionClass) const;
+		// Converts an RVA to an offset into the parsed data, returns false if it's not backed by data
+		bool RvaToOffset(uint32_t rva, size_t& offset) const;
+		bool GetDataDirectory(int index, uint32_t& rva, uint32_t& size) const;
+
+		bool Is64Bit() const
+		{
+			return is64Bit;
+		}
+		uint32_t GetTimestamp() const
+		{
+			return timestamp;
+		}
+		uint32_t GetSizeOfImage() const
+		{
+			return sizeOfImage;
+		}
+		uint32_t GetSizeOfHeaders() const
+		{
+			return sizeOfHeaders;
+		}
+		// Offset of the ImageBase field, which the loader overwrites when relocating the image
+		size_t GetImageBaseOffset() const
+		{
+			return imageBaseOffset;
+		}
+		size_t GetImageBaseSize() const
+		{
+			return is64Bit ? 8 : 4;
+		}
+
+		static SectionClass ClassifySection(uint32_t characteristics);
+
+	private:
+		std::vector<PESection> sections;
+		std::vector<std::pair<uint32_t, uint32_t>> dataDirectories;
+		size_t dataSize = 0;
+		size_t imageBaseOffset = 0;
+		uint32_t timestamp = 0;
+		uint32_t sizeOfImage = 0;
+		uint32_t sizeOfHeaders = 0;
+		bool mapped = true;
+		bool is64Bit = false;
+		bool valid = false;
+	};
+} // namespace utils
@@ -0,0 +1,132 @@
+#include "stdafx.hpp"
+#include "prepared_command.hpp"
+#include "convar.hpp"
+#include "interfaces.hpp"
+#include "..\sptlib-wrapper.hpp"
+
+#include <unordered_map>
+
+static std::unordered_map<std::string, std::shared_ptr<const PreparedCommand>> preparedCommands;
+static int preparedGeneration = 0;
+static const size_t MAX_PREPARED_COMMANDS = 4096;
+
+// The command buffer refuses these or does more than set the value
+static const int TEXT_ONLY_CVAR_FLAGS =
+    FCVAR_CHEAT | FCVAR_REPLICATED | FCVAR_SPONLY | FCVAR_NOT_CONNECTED | FCVAR_NEVER_AS_STRING;
+
+PreparedCommand::PreparedCommand(const std::string& text) : text(text), generation(preparedGeneration)
+{
+#ifdef OE
+	textTail = text;
+#else
+	if (!interfaces::g_pCVar)
+	{
+		textTail = text;
+		return;
+	}
+
+	size_t start = 0;
+
+	while (start < text.size())
+	{
+		size_t end = text.find_first_of(";\n", start);
+		if (end == std::string::npos)
+			end = text.size();
+
+		std::string segment = text.substr(start, end - start);
+		size_t first = segment.find_first_not_of(" \t");
+		if (first == std::string::npos)
+		{
+			start = end + 1;
+			continue;
+		}
+
+		// Quoted arguments can contain semicolons and comments end the line, leave those to the engine
+		if (segment.find('"') != std::string::npos || segment.find("//") != std::string::npos)
+			break;
+
+		auto args = std::make_unique<CCommand>();
+		if (!args->Tokenize(segment.c_str() + first) || args->ArgC() == 0)
+			break;
+
+		ConCommandBase* base = interfaces::g_pCVar->FindCommandBase(args->Arg(0));
+		if (!base)
+			break;
+
+		if (base->IsCommand())
+		{
+			const char* name = base->GetName();
+			if (name[0] != '+' && name[0] != '-')
+				break;
+
+			steps.push_back(Step{nullptr, std::string(), static_cast<ConCommand*>(base), std::move(args)});
+		}
+		else
+		{
+			if (args->ArgC() < 2 || base->IsFlagSet(TEXT_ONLY_CVAR_FLAGS))
+				break;
+
+			// Same value the engine would use
+			const char* value = args->ArgC() == 2 ? args->Arg(1) : args->ArgS();
+			steps.push_back(Step{static_cast<ConVar*>(base), value, nullptr, nullptr});
+		}
+
+		start = end + 1;
+	}
+
+	if (start < text.size())
+		textTail = text.substr(start);
+#endif
+}
+
+PreparedCommand::~PreparedCommand() = default;
+
+void PreparedCommand::Execute(bool& textQueued) const
+{
+	if (textQueued)
+	{
+		EngineConCmd(text.c_str());
+		return;
+	}
+
+#ifndef OE
+	for (auto& step : steps)
+	{
+		if (step.convar)
+			step.convar->SetValue(step.value.c_str());
+		else
+			step.command->Dispatch(*step.args);
+	}
+#endif
+
+	if (!textTail.empty())
+	{
+		EngineConCmd(textTail.c_str());
+		textQueued = true;
+	}
+}
+
+bool PreparedCommand::IsValid() const
+{
+	return generation == preparedGeneration;
+}
+
+std::shared_ptr<const PreparedCommand> PrepareCommand(const std::string& text)
+{
+	auto it = preparedCommands.find(text);
+	if (it != preparedCommands.end() && it->second->IsValid())
+		return it->second;
+
+	if (preparedCommands.size() >= MAX_PREPARED_COMMANDS)
+		preparedCommands.clear();
+
+	auto prepared = std::make_shared<const PreparedCommand>(text);
+	preparedCommands[text] = prepared;
+	return prepared;
+}
+
+void ClearPreparedCommands()
+{
+	preparedCommands.clear();
+	++preparedGeneration;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+class ConVar;
+class ConCommand;
+class CCommand;
+
+/*
+* A command line that's resolved once when it gets queued. ConVar changes and +/- commands run directly on the
+* target tick instead of being tokenized and looked up by the command buffer again. Aliases, unknown commands and
+* anything that needs the command buffer (quotes, cheat cvars, other commands) fall back to text.
+*/
+class PreparedCommand
+{
+public:
+	PreparedCommand(const std::string& text);
+	~PreparedCommand();
+	PreparedCommand(const PreparedCommand&) = delete;
+	PreparedCommand& operator=(const PreparedCommand&) = delete;
+
+	// Text queued earlier runs after the direct steps, so once something has been queued as text everything after
+	// it is queued as text too
+	void Execute(bool& textQueued) const;
+	// False once the commands it points to might have been unloaded
+	bool IsValid() const;
+	const std::string& GetText() const
+	{
+		return text;
+	}
+
+private:
+	struct Step
+	{
+		ConVar* convar;
+		std::string value;
+		ConCommand* command;
+		std::unique_ptr<CCommand> args;
+	};
+
+	std::vector<Step> steps;
+	std::string text;
+	std::string textTail; // whatever couldn't be resolved, starting from the first unresolved command
+	int generation;
+};
+
+// Identical command lines share the same prepared command
+std::shared_ptr<const PreparedCommand> PrepareCommand(const std::string& text);
+// Invalidates every prepared command, has to be called before the commands they point to get unloaded
+void ClearPreparedCommands();
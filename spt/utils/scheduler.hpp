@@ -0,0 +1,96 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace utils
+{
+	/*
+	* Min-heap of entries that are due on an absolute frame or tick. Adding an entry is O(log n) and advancing
+	* only touches the entries that fire, instead of counting down every queued entry.
+	*
+	* Entries that fire on the same advance come out in the order they were added, regardless of their due time,
+	* which is what the old countdown queues did.
+	*/
+	template<typename T>
+	class Scheduler
+	{
+	public:
+		struct Item
+		{
+			long long due;
+			uint64_t seq;
+			T value;
+		};
+
+		// Due once time has moved forward by delay, anything <= 0 is due on the next advance
+		void Add(long long delay, T value)
+		{
+			heap.push_back(Item{now + delay, nextSeq++, std::move(value)});
+			std::push_heap(heap.begin(), heap.end(), Later);
+		}
+
+		// Reserves a block of sequence numbers, so that entries added later with AddReserved come out in the
+		// same order as if they had all been added now
+		uint64_t ReserveSeq(uint64_t count)
+		{
+			uint64_t first = nextSeq;
+			nextSeq += count;
+			return first;
+		}
+
+		void AddReserved(long long delay, uint64_t seq, T value)
+		{
+			heap.push_back(Item{now + delay, seq, std::move(value)});
+			std::push_heap(heap.begin(), heap.end(), Later);
+		}
+
+		// Moves time forward and appends the entries that are due to out
+		void Advance(long long delta, std::vector<Item>& out)
+		{
+			now += delta;
+			size_t first = out.size();
+
+			while (!heap.empty() && heap.front().due <= now)
+			{
+				std::pop_heap(heap.begin(), heap.end(), Later);
+				out.push_back(std::move(heap.back()));
+				heap.pop_back();
+			}
+
+			if (out.size() - first > 1)
+			{
+				std::sort(out.begin() + first,
+				          out.end(),
+				          [](const Item& a, const Item& b) { return a.seq < b.seq; });
+			}
+		}
+
+		void Clear()
+		{
+			heap.clear();
+		}
+
+		size_t Size() const
+		{
+			return heap.size();
+		}
+
+		long long GetNow() const
+		{
+			return now;
+		}
+
+	private:
+		static bool Later(const Item& a, const Item& b)
+		{
+			if (a.due != b.due)
+				return a.due > b.due;
+			return a.seq > b.seq;
+		}
+
+		std::vector<Item> heap;
+		long long now = 0;
+		uint64_t nextSeq = 0;
+	};
+} // namespace utils
@@ -0,0 +1,258 @@
+#include "stdafx.hpp"
+#include "signature_cache.hpp"
+#include "pe_image.hpp"
+#include "thirdparty\md5.hpp"
+#include "dbg.h"
+
+namespace utils
+{
+	SignatureCache g_SignatureCache;
+
+	static const int CACHE_VERSION = 1;
+
+	std::string SignatureCache::HashModule(const uint8_t* start, size_t size)
+	{
+		PEImage image;
+		if (!image.Parse(start, size))
+			return std::string();
+
+		// The loader writes the actual base into the headers, don't let that change the hash
+		size_t headersSize = (std::min)(static_cast<size_t>(image.GetSizeOfHeaders()), size);
+		std::vector<uint8_t> headers(start, start + headersSize);
+		if (image.GetImageBaseOffset() + image.GetImageBaseSize() <= headers.size())
+			memset(headers.data() + image.GetImageBaseOffset(), 0, image.GetImageBaseSize());
+
+		auto codeRanges = image.GetRanges(SectionClass::Code);
+		std::vector<uint8_t> code;
+		for (auto& range : codeRanges)
+			code.insert(code.end(), start + range.first, start + range.second);
+
+		// Make relocated addresses in the code base-relative
+		uint32_t relocRva, relocSize;
+		if (image.GetDataDirectory(PEImage::DIRECTORY_BASERELOC, relocRva, relocSize))
+		{
+			size_t relocPos = relocRva;
+			size_t relocEnd = (std::min)(static_cast<size_t>(relocRva) + relocSize, size);
+			uint32_t base = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(start));
+
+			while (relocPos + 8 <= relocEnd)
+			{
+				uint32_t blockRva, blockSize;
+				memcpy(&blockRva, start + relocPos, sizeof(blockRva));
+				memcpy(&blockSize, start + relocPos + 4, sizeof(blockSize));
+				if (blockSize < 8 || relocPos + blockSize > relocEnd)
+					break;
+
+				for (size_t entry = relocPos + 8; entry + 2 <= relocPos + blockSize; entry += 2)
+				{
+					uint16_t reloc;
+					memcpy(&reloc, start + entry, sizeof(reloc));
+					if ((reloc >> 12) != IMAGE_REL_BASED_HIGHLOW)
+						continue;
+
+					// find the fixup in the concatenated code ranges
+					size_t rva = blockRva + (reloc & 0xFFF);
+					size_t codeOffset = 0;
+					for (auto& range : codeRanges)
+					{
+						if (rva >= range.first && rva + sizeof(uint32_t) <= range.second)
+						{
+							uint8_t* fixup = code.data() + codeOffset + (rva - range.first);
+							uint32_t value;
+							memcpy(&value, fixup, sizeof(value));
+							value -= base;
+							memcpy(fixup, &value, sizeof(value));
+							break;
+						}
+						codeOffset += range.second - range.first;
+					}
+				}
+
+				relocPos += blockSize;
+			}
+		}
+
+		MD5 hash;
+		hash.update(headers.data(), static_cast<MD5::size_type>(headers.size()));
+		hash.update(code.data(), static_cast<MD5::size_type>(code.size()));
+		hash.finalize();
+
+		return std::to_string(size) + "-" + hash.hexdigest();
+	}
+
+	std::string SignatureCache::HashHeaders(const uint8_t* start, size_t size)
+	{
+		PEImage image;
+		if (!image.Parse(start, size))
+			return std::string();
+
+		size_t headersSize = (std::min)(static_cast<size_t>(image.GetSizeOfHeaders()), size);
+		MD5 hash;
+		hash.update(start, static_cast<MD5::size_type>(headersSize));
+		hash.finalize();
+
+		return std::to_string(size) + "-" + hash.hexdigest();
+	}
+
+	void SignatureCache::Load(const std::string& path)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (loaded && path == filePath)
+			return;
+
+		modules.clear();
+		filePath = path;
+		loaded = true;
+		dirty = false;
+
+		std::ifstream is(filePath);
+		if (!is.is_open())
+			return;
+
+		try
+		{
+			nlohmann::json root = nlohmann::json::parse(is);
+			if (root.value("version", 0) != CACHE_VERSION)
+				return;
+
+			for (auto& module : root["modules"].items())
+			{
+				ModuleEntry& entry = modules[module.key()];
+				entry.key = module.value()["key"].get<std::string>();
+
+				for (auto& hook : module.value()["hooks"].items())
+				{
+					HookEntry& hookEntry = entry.hooks[hook.key()];
+					hookEntry.fingerprint = hook.value()["fingerprint"].get<std::string>();
+
+					for (auto& match : hook.value()["matches"])
+					{
+						hookEntry.matches.push_back(
+						    CachedMatch{match[0].get<uint32_t>(), match[1].get<int>()});
+					}
+				}
+			}
+		}
+		catch (const std::exception& ex)
+		{
+			DevWarning("Ignoring invalid signature cache %s: %s\n", filePath.c_str(), ex.what());
+			modules.clear();
+		}
+	}
+
+	void SignatureCache::Save()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (!loaded || !dirty || filePath.empty())
+			return;
+
+		nlohmann::json root;
+		root["version"] = CACHE_VERSION;
+		nlohmann::json& jsonModules = root["modules"];
+
+		for (auto& module : modules)
+		{
+			nlohmann::json& jsonModule = jsonModules[module.first];
+			jsonModule["key"] = module.second.key;
+			nlohmann::json& jsonHooks = jsonModule["hooks"];
+			jsonHooks = nlohmann::json::object();
+
+			for (auto& hook : module.second.hooks)
+			{
+				nlohmann::json matches = nlohmann::json::array();
+				for (auto& match : hook.second.matches)
+					matches.push_back({match.rva, match.index});
+
+				nlohmann::json& jsonHook = jsonHooks[hook.first];
+				jsonHook["fingerprint"] = hook.second.fingerprint;
+				jsonHook["matches"] = matches;
+			}
+		}
+
+		std::ofstream os(filePath);
+		if (!os.is_open())
+		{
+			DevWarning("Unable to write signature cache %s\n", filePath.c_str());
+			return;
+		}
+
+		os << root.dump(1, '\t');
+		dirty = false;
+	}
+
+	void SignatureCache::Clear()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		modules.clear();
+		dirty = true;
+	}
+
+	bool SignatureCache::BeginModule(const std::string& moduleName, const uint8_t* start, size_t size)
+	{
+		uintptr_t base = reinterpret_cast<uintptr_t>(start);
+		std::string headerHash = HashHeaders(start, size);
+		std::string key;
+		bool unchanged = false;
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			auto loaded = loadedModules.find(moduleName);
+			if (!headerHash.empty() && loaded != loadedModules.end() && loaded->second.base == base
+			    && loaded->second.headerHash == headerHash)
+			{
+				key = loaded->second.key;
+				unchanged = true;
+			}
+		}
+
+		if (!unchanged)
+			key = HashModule(start, size);
+
+		std::lock_guard<std::mutex> lock(mutex);
+		loadedModules[moduleName] = LoadedModule{base, headerHash, key};
+		ModuleEntry& entry = modules[moduleName];
+
+		if (entry.key != key)
+		{
+			entry.key = key;
+			entry.hooks.clear();
+			dirty = true;
+		}
+
+		return unchanged;
+	}
+
+	bool SignatureCache::Lookup(const std::string& moduleName,
+	                            const std::string& hookName,
+	                            const std::string& fingerprint,
+	                            std::vector<CachedMatch>& out) const
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		auto module = modules.find(moduleName);
+		if (module == modules.end() || module->second.key.empty())
+			return false;
+
+		auto hook = module->second.hooks.find(hookName);
+		if (hook == module->second.hooks.end() || hook->second.fingerprint != fingerprint)
+			return false;
+
+		out = hook->second.matches;
+		return true;
+	}
+
+	void SignatureCache::Store(const std::string& moduleName,
+	                           const std::string& hookName,
+	                           const std::string& fingerprint,
+	                           const std::vector<CachedMatch>& matches)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		ModuleEntry& module = modules[moduleName];
+		if (module.key.empty())
+			return;
+
+		HookEntry& hook = module.hooks[hookName];
+		hook.fingerprint = fingerprint;
+		hook.matches = matches;
+		dirty = true;
+	}
+} // namespace utils
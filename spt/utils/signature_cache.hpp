@@ -0,0 +1,81 @@
+#pragma once
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace utils
+{
+	struct CachedMatch
+	{
+		uint32_t rva;
+		int index;
+	};
+
+	/*
+	* Remembers where each pattern was found in a module so that unchanged game binaries don't have to be scanned
+	* again. Modules are identified by their name, size and an MD5 of their headers and code section. Code bytes
+	* covered by base relocations are hashed relative to the module base so the hash is stable across load
+	* addresses. Cached hits still have to be confirmed against the pattern by the caller, unless BeginModule()
+	* says the module is unchanged. Modules can be handled from several threads at once.
+	*/
+	class SignatureCache
+	{
+	public:
+		// Loads the cache from the given file, does nothing if it's already loaded
+		void Load(const std::string& path);
+		// Writes the cache back if anything changed since it was loaded
+		void Save();
+		void Clear();
+
+		/*
+		* Hashes the module and forgets its cached hooks if the module has changed. Returns true if the module
+		* is mapped at the same base with the same headers as the last time it was seen in this process (e.g.
+		* after tas_restart_game). The code isn't hashed again then and its cached hooks don't need to be
+		* confirmed.
+		*/
+		bool BeginModule(const std::string& moduleName, const uint8_t* start, size_t size);
+		bool Lookup(const std::string& moduleName,
+		            const std::string& hookName,
+		            const std::string& fingerprint,
+		            std::vector<CachedMatch>& out) const;
+		void Store(const std::string& moduleName,
+		           const std::string& hookName,
+		           const std::string& fingerprint,
+		           const std::vector<CachedMatch>& matches);
+
+		static std::string HashModule(const uint8_t* start, size_t size);
+		static std::string HashHeaders(const uint8_t* start, size_t size);
+
+	private:
+		struct HookEntry
+		{
+			std::string fingerprint;
+			std::vector<CachedMatch> matches;
+		};
+
+		struct ModuleEntry
+		{
+			std::string key;
+			std::unordered_map<std::string, HookEntry> hooks;
+		};
+
+		// Modules seen by this process, these are never written to the file
+		struct LoadedModule
+		{
+			uintptr_t base;
+			std::string headerHash;
+			std::string key;
+		};
+
+		mutable std::mutex mutex;
+		std::unordered_map<std::string, ModuleEntry> modules;
+		std::unordered_map<std::string, LoadedModule> loadedModules;
+		std::string filePath;
+		bool loaded = false;
+		bool dirty = false;
+	};
+
+	extern SignatureCache g_SignatureCache;
+} // namespace utils
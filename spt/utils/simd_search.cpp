@@ -0,0 +1,181 @@
+#include "stdafx.hpp"
+#include "simd_search.hpp"
+
+#include <climits>
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace utils
+{
+	// Most common bytes in x86 code and data first, anything not listed is considered rare
+	static const uint8_t COMMON_BYTES[] = {
+	    0x00, 0xFF, 0x8B, 0xCC, 0x89, 0x24, 0x45, 0x04, 0xE8, 0x08, 0x0F, 0x83, 0x01, 0x10, 0x85, 0x4C, 0x44,
+	    0x50, 0x74, 0x75, 0xC0, 0x56, 0x57, 0x55, 0xEC, 0x5D, 0xC3, 0x8D, 0x0C, 0x14, 0x18, 0x20, 0x40, 0x80,
+	    0x33, 0x3B, 0x46, 0x4D, 0x5E, 0x5F, 0x6A, 0x68, 0xC7, 0x84, 0xF8, 0x7C, 0x02, 0x03, 0xE9, 0xEB,
+	};
+
+	static int GetByteCommonness(uint8_t b)
+	{
+		const int count = sizeof(COMMON_BYTES);
+		for (int i = 0; i < count; ++i)
+		{
+			if (COMMON_BYTES[i] == b)
+				return count - i;
+		}
+		return 0;
+	}
+
+	static inline unsigned int LowestBit(unsigned int mask)
+	{
+#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanForward(&index, mask);
+		return index;
+#else
+		return __builtin_ctz(mask);
+#endif
+	}
+
+	SimdPattern::SimdPattern(const uint8_t* bytes, const std::vector<bool>& fixed)
+	    : bytes(bytes, bytes + fixed.size()), mask(fixed.size())
+	{
+		for (size_t i = 0; i < fixed.size(); ++i)
+			mask[i] = fixed[i] ? 0xFF : 0x00;
+		ChooseAnchors();
+	}
+
+	SimdPattern::SimdPattern(const uint8_t* bytes, size_t length)
+	    : bytes(bytes, bytes + length), mask(length, 0xFF)
+	{
+		ChooseAnchors();
+	}
+
+	void SimdPattern::ChooseAnchors()
+	{
+		anchorCount = 0;
+		int best[2] = {INT_MAX, INT_MAX};
+
+		for (size_t i = 0; i < bytes.size(); ++i)
+		{
+			if (!mask[i])
+				continue;
+
+			int commonness = GetByteCommonness(bytes[i]);
+			if (commonness < best[0])
+			{
+				best[1] = best[0];
+				anchors[1] = anchors[0];
+				best[0] = commonness;
+				anchors[0] = i;
+			}
+			else if (commonness < best[1])
+			{
+				best[1] = commonness;
+				anchors[1] = i;
+			}
+
+			anchorCount = (std::min)(anchorCount + 1, static_cast<size_t>(2));
+		}
+
+		if (anchorCount == 1)
+			anchors[1] = anchors[0];
+	}
+
+	bool SimdPattern::Match(const uint8_t* memory) const
+	{
+		const size_t length = bytes.size();
+		size_t i = 0;
+
+		for (; i + 16 <= length; i += 16)
+		{
+			__m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(memory + i));
+			__m128i pattern = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes.data() + i));
+			__m128i patternMask = _mm_loadu_si128(reinterpret_cast<const __m128i*>(mask.data() + i));
+			__m128i diff = _mm_and_si128(_mm_xor_si128(data, pattern), patternMask);
+			if (_mm_movemask_epi8(_mm_cmpeq_epi8(diff, _mm_setzero_si128())) != 0xFFFF)
+				return false;
+		}
+
+		for (; i < length; ++i)
+		{
+			if ((memory[i] ^ bytes[i]) & mask[i])
+				return false;
+		}
+
+		return true;
+	}
+
+	template<typename Callback>
+	void SimdPattern::Search(const uint8_t* begin, const uint8_t* end, Callback callback) const
+	{
+		const size_t length = bytes.size();
+		if (begin >= end || static_cast<size_t>(end - begin) < length)
+			return;
+
+		// the last position a match can start at
+		const uint8_t* last = end - length;
+		const uint8_t* pos = begin;
+
+		if (anchorCount == 0)
+		{
+			for (; pos <= last; ++pos)
+			{
+				if (callback(pos))
+					return;
+			}
+			return;
+		}
+
+		const __m128i first = _mm_set1_epi8(static_cast<char>(bytes[anchors[0]]));
+		const __m128i second = _mm_set1_epi8(static_cast<char>(bytes[anchors[1]]));
+
+		// both anchors lie within the pattern, so the loads never read past end
+		for (; last - pos >= 15; pos += 16)
+		{
+			__m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pos + anchors[0]));
+			__m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pos + anchors[1]));
+			unsigned int candidates = _mm_movemask_epi8(_mm_cmpeq_epi8(a, first))
+			                          & _mm_movemask_epi8(_mm_cmpeq_epi8(b, second));
+
+			while (candidates)
+			{
+				const uint8_t* candidate = pos + LowestBit(candidates);
+				if (Match(candidate) && callback(candidate))
+					return;
+				candidates &= candidates - 1;
+			}
+		}
+
+		for (; pos <= last; ++pos)
+		{
+			if (Match(pos) && callback(pos))
+				return;
+		}
+	}
+
+	const uint8_t* SimdPattern::Find(const uint8_t* begin, const uint8_t* end) const
+	{
+		const uint8_t* result = nullptr;
+		Search(begin,
+		       end,
+		       [&result](const uint8_t* match)
+		       {
+			       result = match;
+			       return true;
+		       });
+		return result;
+	}
+
+	void SimdPattern::FindAll(const uint8_t* begin, const uint8_t* end, std::vector<const uint8_t*>& out) const
+	{
+		Search(begin,
+		       end,
+		       [&out](const uint8_t* match)
+		       {
+			       out.push_back(match);
+			       return false;
+		       });
+	}
+} // namespace utils
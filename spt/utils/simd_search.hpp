@@ -0,0 +1,43 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace utils
+{
+	/*
+	* A byte pattern with a wildcard mask that is searched for 16 candidate positions at a time with SSE2.
+	*
+	* The two fixed bytes that are least likely to show up in x86 code and data are used as anchors: a block of
+	* candidates is only looked at if both anchors match, and only those candidates are checked against the whole
+	* pattern. This doesn't depend on the SDK or SPTLib.
+	*/
+	class SimdPattern
+	{
+	public:
+		SimdPattern() = default;
+		// fixed[i] is false for wildcard bytes
+		SimdPattern(const uint8_t* bytes, const std::vector<bool>& fixed);
+		SimdPattern(const uint8_t* bytes, size_t length);
+
+		// Returns the first match that starts in [begin, end - length], or nullptr
+		const uint8_t* Find(const uint8_t* begin, const uint8_t* end) const;
+		void FindAll(const uint8_t* begin, const uint8_t* end, std::vector<const uint8_t*>& out) const;
+		bool Match(const uint8_t* memory) const;
+
+		size_t Length() const
+		{
+			return bytes.size();
+		}
+
+	private:
+		void ChooseAnchors();
+		template<typename Callback>
+		void Search(const uint8_t* begin, const uint8_t* end, Callback callback) const;
+
+		std::vector<uint8_t> bytes;
+		std::vector<uint8_t> mask; // 0xFF for fixed bytes
+		size_t anchors[2] = {0, 0};
+		size_t anchorCount = 0;
+	};
+} // namespace utils
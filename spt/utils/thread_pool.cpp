@@ -0,0 +1,228 @@
+#include "stdafx.hpp"
+#include "thread_pool.hpp"
+
+#include <algorithm>
+
+namespace utils
+{
+	static const size_t NO_WORKER = static_cast<size_t>(-1);
+
+	static thread_local ThreadPool* currentPool = nullptr;
+	static thread_local size_t currentWorker = NO_WORKER;
+
+	ThreadPool::ThreadPool(size_t threadCount) : threadCount(threadCount)
+	{
+		if (this->threadCount == 0)
+		{
+			// the thread that waits on the work helps out, so leave a core for it
+			size_t cores = std::thread::hardware_concurrency();
+			this->threadCount = cores > 1 ? cores - 1 : 1;
+		}
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		Shutdown();
+	}
+
+	void ThreadPool::Start()
+	{
+		std::lock_guard<std::mutex> lock(startMutex);
+		if (running)
+			return;
+
+		queues.clear();
+		for (size_t i = 0; i < threadCount; ++i)
+			queues.emplace_back(std::make_unique<WorkerQueue>());
+
+		stopping = false;
+		running = true;
+		for (size_t i = 0; i < threadCount; ++i)
+			workers.emplace_back(&ThreadPool::WorkerLoop, this, i);
+	}
+
+	void ThreadPool::Shutdown()
+	{
+		std::lock_guard<std::mutex> lock(startMutex);
+		if (!running)
+			return;
+
+		{
+			std::lock_guard<std::mutex> sleepLock(sleepMutex);
+			stopping = true;
+		}
+		sleepCondition.notify_all();
+
+		for (auto& worker : workers)
+			worker.join();
+
+		workers.clear();
+		queues.clear();
+		running = false;
+	}
+
+	void ThreadPool::Submit(Task task)
+	{
+		if (!running)
+			Start();
+
+		size_t index;
+		if (currentPool == this && currentWorker != NO_WORKER)
+			index = currentWorker;
+		else
+			index = nextQueue++ % threadCount;
+
+		// Counted before it can be popped, otherwise a thief could take it and decrement the count first
+		{
+			std::lock_guard<std::mutex> sleepLock(sleepMutex);
+			++pendingTasks;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(queues[index]->mutex);
+			queues[index]->tasks.push_back(std::move(task));
+		}
+		sleepCondition.notify_one();
+	}
+
+	bool ThreadPool::PopTask(size_t index, Task& task)
+	{
+		if (!running)
+			return false;
+
+		// newest task from our own queue first, it's most likely to still be in the cache
+		if (index != NO_WORKER)
+		{
+			WorkerQueue& queue = *queues[index];
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			if (!queue.tasks.empty())
+			{
+				task = std::move(queue.tasks.back());
+				queue.tasks.pop_back();
+				--pendingTasks;
+				return true;
+			}
+		}
+
+		// otherwise steal the oldest task of someone else
+		size_t start = index == NO_WORKER ? 0 : index + 1;
+		for (size_t i = 0; i < threadCount; ++i)
+		{
+			WorkerQueue& queue = *queues[(start + i) % threadCount];
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			if (!queue.tasks.empty())
+			{
+				task = std::move(queue.tasks.front());
+				queue.tasks.pop_front();
+				--pendingTasks;
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	bool ThreadPool::RunPendingTask()
+	{
+		Task task;
+		size_t index = currentPool == this ? currentWorker : NO_WORKER;
+		if (!PopTask(index, task))
+			return false;
+
+		task();
+		return true;
+	}
+
+	void ThreadPool::WorkerLoop(size_t index)
+	{
+		currentPool = this;
+		currentWorker = index;
+
+		while (true)
+		{
+			Task task;
+			if (PopTask(index, task))
+			{
+				task();
+				continue;
+			}
+
+			std::unique_lock<std::mutex> lock(sleepMutex);
+			sleepCondition.wait(lock, [this]() { return stopping || pendingTasks > 0; });
+			if (stopping && pendingTasks == 0)
+				break;
+		}
+
+		currentPool = nullptr;
+		currentWorker = NO_WORKER;
+	}
+
+	void TaskGroup::Run(ThreadPool::Task task)
+	{
+		auto state = this->state;
+		{
+			std::lock_guard<std::mutex> lock(state->mutex);
+			++state->remaining;
+		}
+		pool.Submit(
+		    [task = std::move(task), state]()
+		    {
+			    std::exception_ptr exception;
+			    try
+			    {
+				    task();
+			    }
+			    catch (...)
+			    {
+				    exception = std::current_exception();
+			    }
+
+			    std::lock_guard<std::mutex> lock(state->mutex);
+			    if (exception && !state->exception)
+				    state->exception = exception;
+			    --state->remaining;
+			    ++state->finished;
+			    state->changed.notify_all();
+		    });
+	}
+
+	void TaskGroup::Wait()
+	{
+		WaitForTasks();
+
+		std::exception_ptr exception;
+		{
+			std::lock_guard<std::mutex> lock(state->mutex);
+			std::swap(exception, state->exception);
+		}
+		if (exception)
+			std::rethrow_exception(exception);
+	}
+
+	void TaskGroup::WaitForTasks()
+	{
+		while (true)
+		{
+			size_t finished;
+			{
+				std::lock_guard<std::mutex> lock(state->mutex);
+				if (state->remaining == 0)
+					return;
+				finished = state->finished;
+			}
+
+			if (pool.RunPendingTask())
+				continue;
+
+			// Nothing to help with, sleep until one of our tasks is done, it may have queued more
+			std::unique_lock<std::mutex> lock(state->mutex);
+			state->changed.wait(lock, [&]() { return state->finished != finished; });
+		}
+	}
+
+	ThreadPool& GetThreadPool()
+	{
+		static ThreadPool pool;
+		return pool;
+	}
+} // namespace utils
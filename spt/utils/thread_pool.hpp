@@ -0,0 +1,98 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace utils
+{
+	/*
+	* Fixed-size work-stealing thread pool. Every worker has its own queue, tasks submitted from a worker go to
+	* its own queue and idle workers steal from the others. Threads that wait on a TaskGroup run queued tasks
+	* in the meantime, so tasks can submit and wait on other tasks without deadlocking the pool.
+	*
+	* The workers are started on first use and have to be stopped with Shutdown() before the plugin is unloaded.
+	*/
+	class ThreadPool
+	{
+	public:
+		using Task = std::function<void()>;
+
+		explicit ThreadPool(size_t threadCount = 0);
+		~ThreadPool();
+
+		void Submit(Task task);
+		// Runs one queued task on the calling thread, returns false if there was nothing to do
+		bool RunPendingTask();
+		void Shutdown();
+
+		size_t GetThreadCount() const
+		{
+			return threadCount;
+		}
+
+	private:
+		struct WorkerQueue
+		{
+			std::mutex mutex;
+			std::deque<Task> tasks;
+		};
+
+		void Start();
+		void WorkerLoop(size_t index);
+		bool PopTask(size_t index, Task& task);
+
+		std::vector<std::unique_ptr<WorkerQueue>> queues;
+		std::vector<std::thread> workers;
+		std::mutex sleepMutex;
+		std::condition_variable sleepCondition;
+		std::atomic<size_t> pendingTasks{0};
+		std::atomic<size_t> nextQueue{0};
+		std::mutex startMutex;
+		size_t threadCount;
+		std::atomic<bool> running{false};
+		bool stopping = false;
+	};
+
+	/*
+	* A set of tasks that can be waited on together. An exception thrown by a task doesn't reach the worker, the
+	* first one is kept and rethrown by Wait() once every task of the group is done.
+	*/
+	class TaskGroup
+	{
+	public:
+		explicit TaskGroup(ThreadPool& pool) : pool(pool) {}
+		~TaskGroup()
+		{
+			WaitForTasks();
+		}
+
+		void Run(ThreadPool::Task task);
+		// Helps running queued tasks until every task of this group is done, sleeps while there are none
+		void Wait();
+
+	private:
+		// Shared with the queued tasks
+		struct State
+		{
+			std::mutex mutex;
+			std::condition_variable changed;
+			size_t remaining = 0;
+			size_t finished = 0;
+			std::exception_ptr exception;
+		};
+
+		void WaitForTasks();
+
+		ThreadPool& pool;
+		std::shared_ptr<State> state = std::make_shared<State>();
+	};
+
+	// The pool shared by SPT, sized to the number of cores
+	ThreadPool& GetThreadPool();
+} // namespace utils